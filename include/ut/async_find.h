@@ -0,0 +1,322 @@
+#pragma once
+
+#include <array>
+#include <cassert>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <new>
+#include <utility>
+
+#include "ut/lock_free_list.h"
+
+namespace ut {
+
+/**
+ * Per thread cache of coroutine frames, a steady stream of lookups then
+ * doesn't go to the allocator. All frames of one coroutine have the same
+ * size, the most recently released frames are kept by size.
+ *
+ * A frame released by another thread goes to that thread's cache. Tasks
+ * must be destroyed before the thread that destroys them exits.
+ */
+struct Frame_cache {
+  static constexpr size_t CAPACITY = 64;
+
+  Frame_cache() = default;
+  Frame_cache(const Frame_cache&) = delete;
+  Frame_cache& operator=(const Frame_cache&) = delete;
+
+  ~Frame_cache() noexcept {
+    for (size_t i = 0; i < m_count; ++i) {
+      ::operator delete(m_frames[i].m_frame);
+    }
+  }
+
+  /** @return nullptr if the allocator is out of memory. */
+  [[nodiscard]] static void* allocate(size_t size) noexcept {
+    auto& cache = local();
+
+    for (size_t i = cache.m_count; i-- > 0;) {
+      if (cache.m_frames[i].m_size == size) [[likely]] {
+        auto frame = cache.m_frames[i].m_frame;
+
+        cache.m_frames[i] = cache.m_frames[--cache.m_count];
+        return frame;
+      }
+    }
+
+    return ::operator new(size, std::nothrow);
+  }
+
+  static void release(void* frame, size_t size) noexcept {
+    auto& cache = local();
+
+    if (cache.m_count < CAPACITY) [[likely]] {
+      cache.m_frames[cache.m_count++] = {frame, size};
+    } else {
+      ::operator delete(frame);
+    }
+  }
+
+private:
+  struct Frame {
+    void* m_frame;
+    size_t m_size;
+  };
+
+  [[nodiscard]] static Frame_cache& local() noexcept {
+    thread_local Frame_cache cache;
+    return cache;
+  }
+
+  std::array<Frame, CAPACITY> m_frames{};
+  size_t m_count{};
+};
+
+/**
+ * A lookup started by List::async_find(). The call runs it up to its
+ * first prefetch, each resume() runs it up to the next one.
+ *
+ *   auto task = list.async_find([](const Item* item) { return item->m_key == key; });
+ *
+ *   while (!task.done()) {
+ *     ...  other work while the node is loaded
+ *     task.resume();
+ *   }
+ *
+ *   auto item = task.result();
+ *
+ * A task whose frame couldn't be allocated is done and found nothing.
+ */
+template <typename T>
+struct Find_task {
+  struct promise_type {
+    [[nodiscard]] Find_task get_return_object() noexcept {
+      return Find_task(std::coroutine_handle<promise_type>::from_promise(*this));
+    }
+
+    [[nodiscard]] static Find_task get_return_object_on_allocation_failure() noexcept {
+      return {};
+    }
+
+    [[nodiscard]] std::suspend_never initial_suspend() const noexcept {
+      return {};
+    }
+
+    /* Suspended at the end, the task owns the frame until it's destroyed */
+    [[nodiscard]] std::suspend_always final_suspend() const noexcept {
+      return {};
+    }
+
+    void return_value(T* item) noexcept {
+      m_item = item;
+    }
+
+    [[noreturn]] void unhandled_exception() const noexcept {
+      std::terminate();
+    }
+
+    [[nodiscard]] static void* operator new(size_t size) noexcept {
+      return Frame_cache::allocate(size);
+    }
+
+    static void operator delete(void* frame, size_t size) noexcept {
+      Frame_cache::release(frame, size);
+    }
+
+    T* m_item{};
+  };
+
+  Find_task() = default;
+
+  Find_task(Find_task&& rhs) noexcept : m_handle(std::exchange(rhs.m_handle, {})) {}
+
+  Find_task& operator=(Find_task&& rhs) noexcept {
+    if (this != &rhs) {
+      destroy();
+      m_handle = std::exchange(rhs.m_handle, {});
+    }
+    return *this;
+  }
+
+  ~Find_task() noexcept {
+    destroy();
+  }
+
+  [[nodiscard]] bool done() const noexcept {
+    return !m_handle || m_handle.done();
+  }
+
+  /** Run the lookup up to its next prefetch, or to the end. */
+  void resume() const noexcept {
+    assert(!done());
+    m_handle.resume();
+  }
+
+  /** @return the element found, nullptr while not done() or if none. */
+  [[nodiscard]] T* result() const noexcept {
+    return done() && m_handle ? m_handle.promise().m_item : nullptr;
+  }
+
+  /** Run the lookup to the end, like find(). */
+  [[nodiscard]] T* get() const noexcept {
+    while (!done()) {
+      resume();
+    }
+    return result();
+  }
+
+private:
+  explicit Find_task(std::coroutine_handle<promise_type> handle) noexcept : m_handle(handle) {}
+
+  void destroy() noexcept {
+    if (m_handle) {
+      m_handle.destroy();
+      m_handle = {};
+    }
+  }
+
+  std::coroutine_handle<promise_type> m_handle{};
+};
+
+/**
+ * Run the lookups make(0) ... make(n - 1) on the calling thread, Width of
+ * them at a time (asynchronous memory access chaining). A lookup runs
+ * until it has prefetched its next node, then the next one runs, by the
+ * time a lookup is resumed its node has had Width - 1 steps to arrive.
+ * A lookup that finishes is replaced by the next one.
+ *
+ *   Entry* out[BATCH];
+ *
+ *   auto found = ut::find_interleaved<16>(BATCH, [&](size_t i) {
+ *     return buckets[hash(keys[i])].async_find([key = keys[i]](const Entry* entry) {
+ *       return entry->m_key == key;
+ *     });
+ *   }, out);
+ *
+ * Width should cover the memory latency in lookup steps, up to the number
+ * of misses the core can have in flight, 10 to 20 on current x86-64.
+ *
+ * @param[in] make Returns the Find_task of lookup i.
+ * @param[out] out out[i] is the result of lookup i.
+ *
+ * @return the number of lookups that found an element.
+ */
+template <size_t Width = 16, typename Make, typename T>
+size_t find_interleaved(size_t n, Make&& make, T** out) noexcept(noexcept(make(size_t{}))) {
+  static_assert(Width > 0, "Width must be at least one lookup");
+
+  std::array<Find_task<T>, Width> tasks{};
+  std::array<size_t, Width> lookup{};
+  size_t next{};
+  size_t found{};
+
+  /* Start the next lookup in slot, lookups that finish in their first
+   * step don't take it. @return false if there are none left. */
+  auto start = [&](size_t slot) {
+    while (next < n) {
+      auto task = make(next);
+
+      if (!task.done()) [[likely]] {
+        tasks[slot] = std::move(task);
+        lookup[slot] = next++;
+        return true;
+      }
+
+      found += (out[next] = task.result()) != nullptr;
+      ++next;
+    }
+    return false;
+  };
+
+  size_t active{};
+
+  while (active < Width && start(active)) {
+    ++active;
+  }
+
+  while (active > 0) {
+    for (size_t slot = 0; slot < active;) {
+      auto& task = tasks[slot];
+
+      task.resume();
+
+      if (!task.done()) [[likely]] {
+        ++slot;
+        continue;
+      }
+
+      found += (out[lookup[slot]] = task.result()) != nullptr;
+
+      if (start(slot)) {
+        ++slot;
+      } else if (slot != --active) {
+        /* No lookups left, the last slot takes this one, it's due next */
+        task = std::move(tasks[active]);
+        lookup[slot] = lookup[active];
+      }
+    }
+  }
+
+  return found;
+}
+
+template <typename T, auto N, typename Backoff, typename Stats, typename Reclaim>
+template <typename Predicate>
+Find_task<T> List<T, N, Backoff, Stats, Reclaim>::async_find(Predicate predicate) noexcept {
+  uint32_t retries{};
+  Backoff backoff{};
+  [[maybe_unused]] const auto guard = m_reclaim.guard();
+
+  /* Each load that is likely a miss is prefetched before the lookup
+   * suspends, the load is issued when it's resumed. With many lists the
+   * list object itself is one. */
+  prefetch(this);
+  co_await std::suspend_always{};
+
+  prefetch(&m_state->m_head);
+  co_await std::suspend_always{};
+
+  auto current = m_state->m_head.load(std::memory_order_acquire);
+
+  while (current != node_type::NULL_PTR && current != node_type::DELETING_MARK) [[likely]] {
+    auto node = to_node(current);
+    auto item = to_item(*node);
+
+    prefetch(node);
+
+    if constexpr (slot_map::SIDE_LINKS) {
+      prefetch(item);
+    }
+
+    co_await std::suspend_always{};
+
+    const auto links = node->m_links.load(std::memory_order_acquire);
+    const auto link_data = unpack_links<layout_type>(links);
+
+    if (links == node_type::NULL_LINK || link_data.is_deleting()) [[unlikely]] {
+      m_stats.add(List_stat::FIND_RESTARTS);
+
+      if (++retries >= Backoff::MAX_RETRIES) [[unlikely]] {
+        m_stats.add(List_stat::RETRY_EXHAUSTED);
+        co_return nullptr;
+      }
+      /* Node was removed or being deleted, try to recover from head */
+      backoff.pause();
+      current = m_state->m_head.load(std::memory_order_acquire);
+      continue;
+    }
+
+    if (predicate(item)) [[unlikely]] {
+      co_return item;
+    }
+
+    current = link_data.next;
+  }
+
+  co_return nullptr;
+}
+
+} // namespace ut
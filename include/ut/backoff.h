@@ -0,0 +1,138 @@
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#if defined(__linux__)
+#include <ctime>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace ut {
+
+/** Default retry budget for every CAS retry loop in ut::List. */
+inline constexpr uint32_t DEFAULT_MAX_RETRIES = 100;
+
+/** Hint to the CPU that we are spinning on a contended cache line. */
+inline void cpu_relax() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+  _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+  __asm__ __volatile__("yield" ::: "memory");
+#else
+  std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+}
+
+/** Cheap per-thread xorshift generator used for backoff jitter. */
+[[nodiscard]] inline uint32_t backoff_random() noexcept {
+  thread_local uint32_t state = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(&state)) | 1u;
+
+  state ^= state << 13;
+  state ^= state >> 17;
+  state ^= state << 5;
+
+  return state;
+}
+
+/**
+ * Backoff policies for the CAS retry loops in ut::List.
+ *
+ * A policy is a small value type, one instance per retry loop:
+ *  - MAX_RETRIES is the retry budget of the loop, the operation gives up
+ *    (returns false/nullptr) once it is exhausted.
+ *  - pause() is called after every failed attempt, before the next one.
+ */
+
+/** Retry back-to-back, this was the original behaviour of ut::List. */
+template <uint32_t Retries = DEFAULT_MAX_RETRIES>
+struct No_backoff {
+  static constexpr uint32_t MAX_RETRIES = Retries;
+
+  void pause() noexcept {}
+};
+
+/** Issue a fixed number of pause instructions between attempts. */
+template <uint32_t Retries = DEFAULT_MAX_RETRIES, uint32_t Spins = 4>
+struct Spin_backoff {
+  static constexpr uint32_t MAX_RETRIES = Retries;
+
+  void pause() noexcept {
+    for (uint32_t i = 0; i < Spins; ++i) {
+      cpu_relax();
+    }
+  }
+};
+
+/** Truncated exponential backoff, each pause spins for a random number
+ * of iterations in [0, limit) and then doubles the limit (up to MaxSpins).
+ * The jitter breaks up convoys of threads retrying in lock step. */
+template <uint32_t Retries = DEFAULT_MAX_RETRIES, uint32_t MinSpins = 4, uint32_t MaxSpins = 1024>
+struct Exponential_backoff {
+  static_assert(MinSpins > 0 && MinSpins <= MaxSpins, "Invalid spin bounds");
+  static_assert((MaxSpins & (MaxSpins - 1)) == 0, "MaxSpins must be a power of two");
+
+  static constexpr uint32_t MAX_RETRIES = Retries;
+
+  void pause() noexcept {
+    const auto spins = backoff_random() & (m_limit - 1);
+
+    for (uint32_t i = 0; i < spins; ++i) {
+      cpu_relax();
+    }
+
+    if (m_limit < MaxSpins) {
+      m_limit <<= 1;
+    }
+  }
+
+  uint32_t m_limit{std::bit_ceil(MinSpins)};
+};
+
+/** Exponential backoff for the first SpinRounds attempts, after that the
+ * thread is parked for a short, doubling interval (capped at MaxParkUs).
+ * On Linux the park is a private futex wait with a timeout, there is no
+ * waker so the thread resumes when the interval expires. */
+template <uint32_t Retries = DEFAULT_MAX_RETRIES, uint32_t SpinRounds = 8, uint32_t MaxParkUs = 64>
+struct Park_backoff {
+  static constexpr uint32_t MAX_RETRIES = Retries;
+
+  void pause() noexcept {
+    if (m_rounds++ < SpinRounds) {
+      m_spin.pause();
+      return;
+    }
+
+    park(m_park_us);
+
+    if (m_park_us < MaxParkUs) {
+      m_park_us <<= 1;
+    }
+  }
+
+  static void park(uint32_t us) noexcept {
+#if defined(__linux__)
+    uint32_t word{};
+    timespec timeout{0, static_cast<long>(us) * 1000};
+
+    (void) syscall(SYS_futex, &word, FUTEX_WAIT_PRIVATE, 0, &timeout, nullptr, 0);
+#else
+    std::this_thread::sleep_for(std::chrono::microseconds(us));
+#endif
+  }
+
+  uint32_t m_rounds{};
+  uint32_t m_park_us{1};
+  Exponential_backoff<Retries> m_spin{};
+};
+
+} // namespace ut
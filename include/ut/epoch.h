@@ -0,0 +1,385 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <utility>
+
+#include "ut/backoff.h"
+#include "ut/lock_free_list.h"
+
+namespace ut {
+
+/**
+ * Epoch based reclamation for slots removed from a ut::List.
+ *
+ * A removed node keeps NULL_LINK until its slot is reused, that is what
+ * lets a concurrent iterator or find() notice the removal and recover. If
+ * the slot is handed out again and pushed somewhere else while a reader
+ * still holds it, the reader silently continues in the wrong position.
+ * The domain defers the reuse until every reader that could have seen the
+ * node has finished:
+ *
+ *  - Readers pin the current epoch with a Guard for the duration of an
+ *    iteration or find().
+ *  - Removed slots are retire()d instead of released, each one is tagged
+ *    with the epoch it was retired in.
+ *  - The global epoch only advances when every pinned participant has
+ *    observed it, so a slot retired in epoch e can't be reached by any
+ *    reader once the global epoch is e + 2. It's then released to the
+ *    participant's pool cache.
+ *
+ *   Domain::Participant participant(domain);     // One per thread
+ *
+ *   {
+ *     auto guard = participant.pin();
+ *     for (auto& item : list) { ... }
+ *   }
+ *
+ *   participant.retire(list.pop_front());
+ *   auto item = participant.allocate();
+ *
+ * A List with the Epoch_reclaim policy below does the pinning and the
+ * retiring itself.
+ *
+ * Retiring never blocks unless the participant's limbo ring is full and a
+ * reader has been pinned for the entire time it took to fill it. A thread
+ * must not fill its own ring while it holds a guard, it would wait on
+ * itself.
+ *
+ * @tparam Pool             A ut::Fixed_pool, reclaimed slots go to its Cache.
+ * @tparam MaxParticipants  Upper bound on concurrently live participants.
+ * @tparam Backoff          Pause between reclaim attempts while a participant
+ *                          waits for its retired slots to become safe, the
+ *                          retry budget is not used.
+ */
+template <typename Pool, size_t MaxParticipants = 128, typename Backoff = Park_backoff<>>
+struct Epoch_domain {
+  using item_pointer = typename Pool::item_pointer;
+
+  /** Retired slots a participant can hold before it must reclaim. */
+  static constexpr size_t LIMBO_SIZE = 1024;
+
+  /** Try to advance the epoch and reclaim after this many retires. */
+  static constexpr size_t COLLECT_INTERVAL = 64;
+
+  /** Value of a participant's epoch when it isn't pinned. */
+  static constexpr uint64_t QUIESCENT = 0;
+
+  explicit Epoch_domain(Pool& pool) noexcept : m_pool(pool) {}
+
+  Epoch_domain(const Epoch_domain&) = delete;
+  Epoch_domain& operator=(const Epoch_domain&) = delete;
+
+  ~Epoch_domain() noexcept {
+    for ([[maybe_unused]] const auto& slot : m_slots) {
+      assert(!slot.m_in_use.load(std::memory_order_relaxed));
+    }
+  }
+
+  [[nodiscard]] uint64_t epoch() const noexcept {
+    return m_epoch.load(std::memory_order_acquire);
+  }
+
+  /**
+   * Advance the global epoch if every pinned participant has observed the
+   * current one.
+   *
+   * @return the global epoch after the attempt.
+   */
+  uint64_t try_advance() noexcept {
+    auto epoch = m_epoch.load(std::memory_order_acquire);
+
+    /* Order our earlier removals before reading the participants' epochs,
+     * pairs with the fence in Participant::enter(). */
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    for (const auto& slot : m_slots) {
+      const auto pinned = slot.m_epoch.load(std::memory_order_acquire);
+
+      if (pinned != QUIESCENT && pinned != epoch) {
+        return epoch;
+      }
+    }
+
+    if (m_epoch.compare_exchange_strong(epoch, epoch + 1, std::memory_order_acq_rel)) {
+      return epoch + 1;
+    }
+    return epoch;
+  }
+
+  /** A participant's published epoch, on its own cache line. */
+  struct alignas(CACHE_LINE_SIZE) Slot {
+    std::atomic<uint64_t> m_epoch{QUIESCENT};
+    std::atomic<bool> m_in_use{};
+  };
+
+  struct Participant;
+
+  /** Keeps the owning participant pinned while it's alive, guards nest. */
+  struct Guard {
+    explicit Guard(Participant& participant) noexcept : m_participant(participant) {
+      m_participant.enter();
+    }
+
+    ~Guard() noexcept {
+      m_participant.exit();
+    }
+
+    Guard(const Guard&) = delete;
+    Guard& operator=(const Guard&) = delete;
+
+    Participant& m_participant;
+  };
+
+  /**
+   * Per-thread state: the epoch slot readers pin, the ring of retired
+   * slots waiting for two epoch advances and the pool cache they are
+   * reclaimed into. A participant belongs to the thread that created it,
+   * only that thread may use and destroy it, see local(). The destructor
+   * waits for its retired slots to become safe and releases them.
+   */
+  struct Participant {
+    explicit Participant(Epoch_domain& domain) noexcept
+      : m_domain(domain),
+        m_slot(domain.acquire_slot()),
+        m_cache(domain.m_pool),
+        m_outer(thread_chain()) {
+      thread_chain() = this;
+    }
+
+    ~Participant() noexcept {
+      assert(m_depth == 0);
+
+      drain(0);
+
+      /* Usually the innermost one, but participants of different domains
+       * needn't be destroyed in order */
+      auto link = &thread_chain();
+
+      while (*link != this) {
+        link = &(*link)->m_outer;
+      }
+      *link = m_outer;
+
+      m_slot.m_in_use.store(false, std::memory_order_release);
+    }
+
+    Participant(const Participant&) = delete;
+    Participant& operator=(const Participant&) = delete;
+
+    [[nodiscard]] Guard pin() noexcept {
+      return Guard(*this);
+    }
+
+    /** Allocate a slot from the pool, reclaimed slots are reused first. */
+    [[nodiscard]] item_pointer allocate() noexcept {
+      return m_cache.allocate();
+    }
+
+    /**
+     * Defer the release of a slot that was removed from its list, nullptr
+     * is ignored. The slot's node must not be linked into a list.
+     */
+    void retire(item_pointer item) noexcept {
+      if (item == nullptr) [[unlikely]] {
+        return;
+      }
+
+      if (m_count == LIMBO_SIZE) [[unlikely]] {
+        drain(LIMBO_SIZE - 1);
+      }
+
+      m_limbo[(m_first + m_count) % LIMBO_SIZE] = {item, m_domain.m_epoch.load(std::memory_order_acquire)};
+
+      if (++m_count % COLLECT_INTERVAL == 0) {
+        collect();
+      }
+    }
+
+    /** Advance the epoch if possible and release every retired slot it
+     * made safe. */
+    void collect() noexcept {
+      const auto epoch = m_domain.try_advance();
+
+      while (m_count > 0 && m_limbo[m_first].m_epoch + 2 <= epoch) {
+        m_cache.release(m_limbo[m_first].m_item);
+        m_first = (m_first + 1) % LIMBO_SIZE;
+        --m_count;
+      }
+    }
+
+    /** Number of retired slots not yet reclaimed. */
+    [[nodiscard]] size_t pending() const noexcept {
+      return m_count;
+    }
+
+    /** The calling thread's participant in domain, the innermost one if it
+     * has several. nullptr if it has none. */
+    [[nodiscard]] static Participant* local(const Epoch_domain& domain) noexcept {
+      auto participant = thread_chain();
+
+      while (participant != nullptr && &participant->m_domain != &domain) {
+        participant = participant->m_outer;
+      }
+      return participant;
+    }
+
+    void enter() noexcept {
+      if (m_depth++ == 0) {
+        m_slot.m_epoch.store(m_domain.m_epoch.load(std::memory_order_acquire), std::memory_order_relaxed);
+
+        /* Publish the pin before reading any list links, pairs with the
+         * fence in try_advance(). */
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+      }
+    }
+
+    void exit() noexcept {
+      assert(m_depth > 0);
+
+      if (--m_depth == 0) {
+        m_slot.m_epoch.store(QUIESCENT, std::memory_order_release);
+      }
+    }
+
+    /** Reclaim until at most count retired slots are left. Waits on the
+     * pinned readers, paused by the domain's Backoff. */
+    void drain(size_t count) noexcept {
+      Backoff backoff{};
+
+      for (collect(); m_count > count; collect()) {
+        backoff.pause();
+      }
+    }
+
+    /** The live participants of the calling thread, innermost first,
+     * chained through m_outer. */
+    [[nodiscard]] static Participant*& thread_chain() noexcept {
+      thread_local Participant* chain{};
+      return chain;
+    }
+
+    struct Retired {
+      item_pointer m_item{};
+      uint64_t m_epoch{};
+    };
+
+    Epoch_domain& m_domain;
+    Slot& m_slot;
+    typename Pool::Cache m_cache;
+    Participant* m_outer{};
+    uint32_t m_depth{};
+    size_t m_first{};
+    size_t m_count{};
+    std::array<Retired, LIMBO_SIZE> m_limbo{};
+  };
+
+private:
+  [[nodiscard]] Slot& acquire_slot() noexcept {
+    for (auto& slot : m_slots) {
+      bool expected{false};
+
+      if (!slot.m_in_use.load(std::memory_order_relaxed) &&
+          slot.m_in_use.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+        return slot;
+      }
+    }
+
+    /* More live participants than MaxParticipants is a configuration error */
+    std::abort();
+  }
+
+  Pool& m_pool;
+
+  /** Starts at 1, 0 is QUIESCENT. */
+  alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> m_epoch{1};
+
+  std::array<Slot, MaxParticipants> m_slots{};
+};
+
+/**
+ * Reclaim policy of a ut::List over the slots of an Epoch_domain's pool.
+ * The list pins the domain in find(), the walks, the removals and for the
+ * life of its iterators, and retire() defers the reuse of a removed slot
+ * through the domain:
+ *
+ *   using Reclaim = ut::Epoch_reclaim<Domain>;
+ *   ut::List<Item, &Item::node, ut::No_backoff<>, ut::No_stats, Reclaim> list(base, end, Reclaim(domain));
+ *
+ *   Domain::Participant participant(domain);     // One per thread
+ *
+ *   for (auto& item : list) { ... }
+ *   list.retire(list.pop_front());
+ *
+ * Every thread that uses the list must have a live participant of the
+ * domain, the policy finds it with Participant::local(). Iterators must
+ * not outlive it or be handed to another thread.
+ */
+template <typename Domain>
+struct Epoch_reclaim {
+  using item_pointer = typename Domain::item_pointer;
+  using Participant = typename Domain::Participant;
+
+  static constexpr bool ENABLED = true;
+
+  /** Keeps a participant pinned while it's alive, like Domain::Guard, but
+   * copyable so that an iterator can carry it. A default constructed one
+   * pins nothing. */
+  struct Guard {
+    Guard() = default;
+
+    explicit Guard(Participant& participant) noexcept : m_participant(&participant) {
+      m_participant->enter();
+    }
+
+    Guard(const Guard& rhs) noexcept : m_participant(rhs.m_participant) {
+      if (m_participant != nullptr) {
+        m_participant->enter();
+      }
+    }
+
+    Guard(Guard&& rhs) noexcept : m_participant(std::exchange(rhs.m_participant, nullptr)) {}
+
+    Guard& operator=(Guard rhs) noexcept {
+      std::swap(m_participant, rhs.m_participant);
+      return *this;
+    }
+
+    ~Guard() noexcept {
+      if (m_participant != nullptr) {
+        m_participant->exit();
+      }
+    }
+
+    Participant* m_participant{};
+  };
+
+  explicit Epoch_reclaim(Domain& domain) noexcept : m_domain(&domain) {}
+
+  [[nodiscard]] Guard guard() const noexcept {
+    return Guard(participant());
+  }
+
+  void retire(item_pointer item) const noexcept {
+    participant().retire(item);
+  }
+
+  /** The calling thread's participant, a thread without one is a usage
+   * error. */
+  [[nodiscard]] Participant& participant() const noexcept {
+    const auto participant = Participant::local(*m_domain);
+
+    if (participant == nullptr) [[unlikely]] {
+      std::abort();
+    }
+    return *participant;
+  }
+
+  Domain* m_domain;
+};
+
+} // namespace ut
@@ -0,0 +1,378 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <type_traits>
+
+#include "ut/lock_free_list.h"
+
+namespace ut {
+
+/**
+ * Owner of the fixed backing array that ut::List is built over, and
+ * allocator for its slots.
+ *
+ * Free slots are kept on a lock-free Treiber stack. The stack links are
+ * kept beside the array, one link per slot, and a free slot's Node stays
+ * invalidated: that's the state of a removed node, which every List
+ * operation rejects and no node scan such as List::for_each_unordered()
+ * or List::recover() takes for an element. No link word value is left
+ * for a free link in the Node itself, every other one can be that of a
+ * live, claimed or pinned node. The stack top is a 64 bit word, a 32 bit
+ * version in the upper half and the slot index in the lower half, the
+ * version is bumped by every update so that a stale top can't be CASed
+ * back in (ABA).
+ *
+ * Slots are handed out with their Node invalidated, which is the state
+ * List::remove() and List::pop_front() leave a node in, so the result of
+ * either can be passed straight to release():
+ *
+ *   pool.release(list.pop_front());
+ *
+ * The hot path should go through a per-thread Cache, see below.
+ *
+ * @tparam T       Item type, default constructed when the pool is created.
+ * @tparam N       Member function of T returning the embedded Node, or
+ *                 SIDE_LINKS<Node_type>. The pool then owns a parallel
+ *                 node array too, pass nodes() to the List.
+ * @tparam Backoff Contention policy for the stack CAS loops. The retry
+ *                 budget is not used, an allocation only fails when the
+ *                 pool is empty.
+ */
+template <typename T, auto N, typename Backoff = No_backoff<>>
+struct Fixed_pool {
+  using value_type = T;
+  using slot_map = Slot_map<T, N>;
+  using node_type = typename slot_map::node_type;
+  using layout_type = typename node_type::layout_type;
+  using item_type = T;
+  using item_pointer = item_type*;
+  using Link_type = typename node_type::Link_type;
+
+  /** Number of slots a Cache moves to or from the pool at a time. */
+  static constexpr size_t CACHE_SIZE = 64;
+
+  explicit Fixed_pool(size_t capacity)
+    : m_items(std::make_unique<T[]>(capacity)),
+      m_base(m_items.get()),
+      m_capacity(capacity) {
+
+    if constexpr (slot_map::SIDE_LINKS) {
+      m_nodes = std::make_unique<node_type[]>(capacity);
+      m_slots.m_nodes = m_nodes.get();
+    }
+
+    init();
+  }
+
+  /**
+   * Pool over the caller's slots [base, end), which must outlive it. The
+   * range can be part of a larger List's array, the pool's links are only
+   * used while a slot is free. Used to keep separate pools for parts of
+   * one array, see ut::Numa_pool.
+   */
+  Fixed_pool(item_pointer base, item_pointer end) requires (!slot_map::SIDE_LINKS)
+    : m_base(base),
+      m_capacity(static_cast<size_t>(end - base)) {
+    init();
+  }
+
+  /** @see Fixed_pool(base, end), nodes[i] is the node of base[i]. */
+  Fixed_pool(item_pointer base, item_pointer end, node_type* nodes) requires (slot_map::SIDE_LINKS)
+    : m_base(base),
+      m_capacity(static_cast<size_t>(end - base)) {
+    m_slots.m_nodes = nodes;
+    init();
+  }
+
+  Fixed_pool(const Fixed_pool&) = delete;
+  Fixed_pool& operator=(const Fixed_pool&) = delete;
+
+  /** Start of the backing array, to build a List over the pool. */
+  [[nodiscard]] item_pointer base() noexcept {
+    return m_base;
+  }
+
+  /** End of the backing array. */
+  [[nodiscard]] item_pointer end() noexcept {
+    return m_base + m_capacity;
+  }
+
+  /** The node array of a side links pool. */
+  [[nodiscard]] node_type* nodes() noexcept requires (slot_map::SIDE_LINKS) {
+    return m_slots.m_nodes;
+  }
+
+  [[nodiscard]] size_t capacity() const noexcept {
+    return m_capacity;
+  }
+
+  /**
+   * Take a free slot from the shared stack.
+   *
+   * @return nullptr if the pool is empty.
+   */
+  [[nodiscard]] item_pointer allocate() noexcept {
+    const auto chain = pop_chain(1);
+
+    if (chain.m_first == node_type::NULL_PTR) [[unlikely]] {
+      return nullptr;
+    }
+
+    return take(chain.m_first);
+  }
+
+  /** Return a slot to the shared stack, nullptr is ignored. The slot's
+   * node must not be linked into a list. */
+  void release(item_pointer item) noexcept {
+    if (item == nullptr) [[unlikely]] {
+      return;
+    }
+
+    const auto link = to_link(item);
+
+    push_chain(link, link);
+  }
+
+  /**
+   * Per-thread magazine of free slots. allocate() and release() work on a
+   * private stack and don't touch shared memory. The shared stack is only
+   * used to refill an empty cache with up to CACHE_SIZE slots, or to give
+   * back CACHE_SIZE slots when the cache holds twice that, one CAS each.
+   *
+   * A Cache must only be used by one thread at a time, the slots it holds
+   * are returned to the pool when it is destroyed.
+   */
+  struct Cache {
+    explicit Cache(Fixed_pool& pool) noexcept : m_pool(pool) {}
+
+    ~Cache() noexcept {
+      flush();
+    }
+
+    Cache(const Cache&) = delete;
+    Cache& operator=(const Cache&) = delete;
+
+    /** @return nullptr if both the cache and the pool are empty. */
+    [[nodiscard]] item_pointer allocate() noexcept {
+      if (m_count == 0) [[unlikely]] {
+        const auto chain = m_pool.pop_chain(CACHE_SIZE);
+
+        if (chain.m_first == node_type::NULL_PTR) [[unlikely]] {
+          return nullptr;
+        }
+
+        m_head = chain.m_first;
+        m_count = chain.m_count;
+      }
+
+      const auto link = m_head;
+
+      m_head = m_pool.get_next(link);
+      --m_count;
+
+      return m_pool.take(link);
+    }
+
+    /** Return a slot to the cache, nullptr is ignored. */
+    void release(item_pointer item) noexcept {
+      if (item == nullptr) [[unlikely]] {
+        return;
+      }
+
+      if (m_count == 2 * CACHE_SIZE) [[unlikely]] {
+        auto last = m_head;
+
+        for (size_t i = 1; i < CACHE_SIZE; ++i) {
+          last = m_pool.get_next(last);
+        }
+
+        const auto first = m_head;
+
+        m_head = m_pool.get_next(last);
+        m_count -= CACHE_SIZE;
+        m_pool.push_chain(first, last);
+      }
+
+      const auto link = m_pool.to_link(item);
+
+      m_pool.set_next(link, m_head);
+      m_head = link;
+      ++m_count;
+    }
+
+    /** Return all cached slots to the pool. */
+    void flush() noexcept {
+      if (m_count == 0) {
+        return;
+      }
+
+      auto last = m_head;
+
+      for (size_t i = 1; i < m_count; ++i) {
+        last = m_pool.get_next(last);
+      }
+
+      m_pool.push_chain(m_head, last);
+      m_head = node_type::NULL_PTR;
+      m_count = 0;
+    }
+
+    [[nodiscard]] size_t size() const noexcept {
+      return m_count;
+    }
+
+    Fixed_pool& m_pool;
+    Link_type m_head{node_type::NULL_PTR};
+    size_t m_count{};
+  };
+
+private:
+  /** A run of free slots linked through their stack links, see set_next(). */
+  struct Free_chain {
+    Link_type m_first{node_type::NULL_PTR};
+    Link_type m_last{node_type::NULL_PTR};
+    size_t m_count{};
+  };
+
+  /** Index of an empty stack top, the top has room for 32 bit indices. */
+  static constexpr uint32_t EMPTY = std::numeric_limits<uint32_t>::max();
+
+  /** Thread all slots onto the free stack. */
+  void init() {
+    m_slots.m_base = m_base;
+
+    assert(m_capacity > 0 && m_capacity <= layout_type::MAX_CAPACITY && m_capacity < EMPTY);
+
+    m_next = std::make_unique<std::atomic<Link_type>[]>(m_capacity);
+
+    for (size_t i = 0; i < m_capacity; ++i) {
+      const auto next = i + 1 < m_capacity ? static_cast<Link_type>(i + 1) : node_type::NULL_PTR;
+
+      set_next(static_cast<Link_type>(i), next);
+    }
+
+    m_free.store(pack_top(0, 0), std::memory_order_release);
+  }
+
+  [[nodiscard]] static constexpr uint64_t pack_top(Link_type link, uint32_t version) noexcept {
+    const auto index = link == node_type::NULL_PTR ? EMPTY : static_cast<uint32_t>(link);
+
+    return (static_cast<uint64_t>(version) << 32) | index;
+  }
+
+  [[nodiscard]] static constexpr Link_type top_link(uint64_t top) noexcept {
+    const auto index = static_cast<uint32_t>(top);
+
+    return index == EMPTY ? node_type::NULL_PTR : static_cast<Link_type>(index);
+  }
+
+  [[nodiscard]] static constexpr uint32_t top_version(uint64_t top) noexcept {
+    return static_cast<uint32_t>(top >> 32);
+  }
+
+  [[nodiscard]] node_type& node(Link_type link) noexcept {
+    return *m_slots.node(link);
+  }
+
+  [[nodiscard]] Link_type to_link(item_pointer item) const noexcept {
+    assert(item >= m_base && item < m_base + m_capacity);
+    return static_cast<Link_type>(item - m_base);
+  }
+
+  [[nodiscard]] Link_type get_next(Link_type link) noexcept {
+    return m_next[link].load(std::memory_order_relaxed);
+  }
+
+  /** Link a free slot to next on the stack, its node is invalidated like
+   * that of a removed element. */
+  void set_next(Link_type link, Link_type next) noexcept {
+    node(link).invalidate();
+    m_next[link].store(next, std::memory_order_relaxed);
+  }
+
+  /** A free slot's node is already invalidated, see set_next(). */
+  [[nodiscard]] item_pointer take(Link_type link) noexcept {
+    return &m_base[link];
+  }
+
+  /**
+   * Pop up to n slots with a single CAS: walk n - 1 hops down from the top
+   * and swing the top past the last slot taken. The nodes below the top
+   * can only change after the top does, so a successful CAS implies the
+   * walk saw a consistent stack. A walk that races with another pop can
+   * see a reused node, indices out of range are rejected for that reason.
+   */
+  [[nodiscard]] Free_chain pop_chain(size_t n) noexcept {
+    Backoff backoff{};
+    auto top = m_free.load(std::memory_order_acquire);
+
+    for (;;) {
+      Free_chain chain{top_link(top), top_link(top), 1};
+
+      if (chain.m_first == node_type::NULL_PTR) {
+        return {};
+      }
+
+      auto next = get_next(chain.m_last);
+
+      while (chain.m_count < n && next < m_capacity) {
+        chain.m_last = next;
+        next = get_next(chain.m_last);
+        ++chain.m_count;
+      }
+
+      if (next != node_type::NULL_PTR && next >= m_capacity) [[unlikely]] {
+        /* Torn read, try again */
+        top = m_free.load(std::memory_order_acquire);
+        continue;
+      }
+
+      const auto new_top = pack_top(next, top_version(top) + 1);
+
+      if (m_free.compare_exchange_weak(top, new_top, std::memory_order_acquire, std::memory_order_acquire)) [[likely]] {
+        return chain;
+      }
+
+      backoff.pause();
+    }
+  }
+
+  /** Push the chain first..last, already linked through set_next(), with
+   * one CAS. */
+  void push_chain(Link_type first, Link_type last) noexcept {
+    Backoff backoff{};
+    auto top = m_free.load(std::memory_order_relaxed);
+
+    for (;;) {
+      set_next(last, top_link(top));
+
+      const auto new_top = pack_top(first, top_version(top) + 1);
+
+      if (m_free.compare_exchange_weak(top, new_top, std::memory_order_release, std::memory_order_relaxed)) [[likely]] {
+        return;
+      }
+
+      backoff.pause();
+    }
+  }
+
+  /** Storage of an owning pool, empty for borrowed slots. */
+  std::unique_ptr<T[]> m_items;
+  std::unique_ptr<node_type[]> m_nodes;
+  item_pointer m_base{};
+  size_t m_capacity{};
+  slot_map m_slots{};
+
+  /** Stack links of the free slots, see set_next(). */
+  std::unique_ptr<std::atomic<Link_type>[]> m_next;
+
+  /** Top of the free stack, see pack_top(). */
+  alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> m_free{};
+};
+
+} // namespace ut
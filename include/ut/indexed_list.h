@@ -0,0 +1,437 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "ut/lock_free_list.h"
+
+namespace ut {
+
+/**
+ * A ut::List with a lock-free hash index from keys to elements, for LRU
+ * style use: look an element up by key in O(1), then remove it, insert
+ * next to it or move it to the front.
+ *
+ * The index is an open addressing table of slot links next to the list,
+ * twice the list's capacity rounded up to a power of two. Keys are not
+ * stored, they are read from the elements with KeyFn, so an element's key
+ * must not change while it's in the list. Entries are claimed pending
+ * before the element is linked, published once it is and cleared after it
+ * was unlinked:
+ *
+ *  - Keys are unique, a push of a key that is already present or pending
+ *    fails. find() skips pending entries, it never returns an element
+ *    that isn't linked yet.
+ *  - find() can return an element whose removal is in progress, like the
+ *    list's own find() it is a hint that the element was there.
+ *  - Cleared entries are tombstones that later inserts reuse. Probing is
+ *    bounded to MAX_PROBES positions, or the whole table if it's smaller,
+ *    an insert that finds no free entry in that window fails.
+ *  - Tombstones never turn back into empty entries while the list is in
+ *    use, a concurrent insert may depend on them. After churn a miss in
+ *    find() or the duplicate check of an insert probes all MAX_PROBES
+ *    positions, compact_index() clears them while the list is quiescent.
+ *
+ * Removed slots must not be reused while a find() may still hold them:
+ * with ut::Epoch_reclaim as the Reclaim policy the lookups and inserts
+ * hold a guard of the Epoch_domain and removed slots go to
+ * list().retire(), otherwise that's up to the caller.
+ *
+ *   auto key_of = [](const Page& page) { return page.m_id; };
+ *   ut::Indexed_list<Page, &Page::node, decltype(key_of)> lru(base, end);
+ *
+ *   lru.push_front(page);
+ *   if (auto hit = lru.touch(id)) { ... }
+ *   evict(lru.pop_back());
+ *
+ * @tparam T       Item type.
+ * @tparam N       Node accessor, as for ut::List.
+ * @tparam KeyFn   Callable, KeyFn{}(const T&) returns the element's key.
+ * @tparam Hash    Hash for the key type.
+ * @tparam Backoff Contention policy of the list.
+ * @tparam Stats   Statistics policy of the list, see ut::List.
+ * @tparam Reclaim Reclaim policy of the list, see ut::List.
+ */
+template <typename T, auto N, typename KeyFn, typename Hash = std::hash<std::decay_t<std::invoke_result_t<KeyFn, const T&>>>,
+          typename Backoff = No_backoff<>, typename Stats = No_stats, typename Reclaim = No_reclaim>
+struct Indexed_list {
+  using list_type = List<T, N, Backoff, Stats, Reclaim>;
+  using slot_map = typename list_type::slot_map;
+  using node_type = typename list_type::node_type;
+  using node_pointer = typename list_type::node_pointer;
+  using item_pointer = typename list_type::item_pointer;
+  using item_reference = typename list_type::item_reference;
+  using key_type = std::decay_t<std::invoke_result_t<KeyFn, const T&>>;
+  using Link_type = typename node_type::Link_type;
+
+  /** Longest probe sequence of a lookup or insert. */
+  static constexpr size_t MAX_PROBES = 64;
+
+  Indexed_list(item_pointer base, item_pointer end, KeyFn key_fn = KeyFn{}, Hash hash = Hash{}, Reclaim reclaim = {})
+    requires (!slot_map::SIDE_LINKS)
+    : m_list(base, end, std::move(reclaim)),
+      m_key_fn(key_fn),
+      m_hash(hash) {
+    init_table(static_cast<size_t>(end - base));
+  }
+
+  Indexed_list(item_pointer base, item_pointer end, node_pointer nodes, KeyFn key_fn = KeyFn{}, Hash hash = Hash{},
+               Reclaim reclaim = {}) requires (slot_map::SIDE_LINKS)
+    : m_list(base, end, nodes, std::move(reclaim)),
+      m_key_fn(key_fn),
+      m_hash(hash) {
+    init_table(static_cast<size_t>(end - base));
+  }
+
+  Indexed_list(const Indexed_list&) = delete;
+  Indexed_list& operator=(const Indexed_list&) = delete;
+
+  /** The underlying list, for iteration and for_each(). Elements must be
+   * added and removed through the Indexed_list. */
+  [[nodiscard]] list_type& list() noexcept {
+    return m_list;
+  }
+
+  [[nodiscard]] size_t size() const noexcept {
+    return m_list.size();
+  }
+
+  /** @return false if the key is already present, the index window is full
+   *          or the list push failed. */
+  [[nodiscard]] bool push_front(item_reference item) noexcept {
+    return link(item, [&]() { return m_list.push_front(item); });
+  }
+
+  /** @see push_front() */
+  [[nodiscard]] bool push_back(item_reference item) noexcept {
+    return link(item, [&]() { return m_list.push_back(item); });
+  }
+
+  /** @see push_front() */
+  [[nodiscard]] bool insert_after(item_reference item, item_reference new_item) noexcept {
+    return link(new_item, [&]() { return m_list.insert_after(item, new_item); });
+  }
+
+  /** @see push_front() */
+  [[nodiscard]] bool insert_before(item_reference item, item_reference new_item) noexcept {
+    return link(new_item, [&]() { return m_list.insert_before(item, new_item); });
+  }
+
+  /** @return the element with key, nullptr if there is none. */
+  [[nodiscard]] item_pointer find(const key_type& key) noexcept {
+    [[maybe_unused]] const auto guard = m_list.guard();
+    const auto link = lookup(key);
+
+    return link == EMPTY ? nullptr : m_list.to_item(link);
+  }
+
+  /** Remove item from the list and the index. @return item, nullptr if it
+   * could not be removed. */
+  [[nodiscard]] item_pointer remove(item_reference item) noexcept {
+    auto removed = m_list.remove(item);
+
+    if (removed != nullptr) [[likely]] {
+      unindex(*removed);
+    }
+    return removed;
+  }
+
+  /** Remove the element with key. @return the element, nullptr if there is
+   *  none or it could not be removed. */
+  [[nodiscard]] item_pointer erase(const key_type& key) noexcept {
+    [[maybe_unused]] const auto guard = m_list.guard();
+    auto item = find(key);
+
+    return item == nullptr ? nullptr : remove(*item);
+  }
+
+  /**
+   * Look key up and move its element to the front, the LRU hit path, see
+   * List::move_to_front().
+   *
+   * @return the element, nullptr if there is none or it is being removed.
+   *         If the move became a removal the element is unindexed and
+   *         nullptr returned, it's then the caller's like after a failed
+   *         lookup and a remove().
+   */
+  [[nodiscard]] item_pointer touch(const key_type& key) noexcept {
+    [[maybe_unused]] const auto guard = m_list.guard();
+    auto item = find(key);
+
+    if (item == nullptr) [[unlikely]] {
+      return nullptr;
+    }
+
+    switch (m_list.move_to_front(*item)) {
+      case Move_result::MOVED:
+        return item;
+      case Move_result::REMOVED:
+        /* Only the mover owns the unlinked element, a remover that raced
+         * with it failed and left the entry alone */
+        unindex(*item);
+        return nullptr;
+      case Move_result::UNCHANGED:
+        break;
+    }
+    return nullptr;
+  }
+
+  /** Remove the element at the front, nullptr if the list is empty. */
+  [[nodiscard]] item_pointer pop_front() noexcept {
+    auto item = m_list.pop_front();
+
+    if (item != nullptr) [[likely]] {
+      unindex(*item);
+    }
+    return item;
+  }
+
+  /** Remove the element at the back, the LRU victim. */
+  [[nodiscard]] item_pointer pop_back() noexcept {
+    auto item = m_list.pop_back();
+
+    if (item != nullptr) [[likely]] {
+      unindex(*item);
+    }
+    return item;
+  }
+
+  /**
+   * Turn the index's tombstones back into empty entries. Each element's
+   * entry moves to the first free entry of its probe sequence, which is
+   * never further from its home than before. No other thread may use the
+   * list.
+   *
+   * @return the number of tombstones cleared.
+   */
+  size_t compact_index() noexcept {
+    size_t start{};
+
+    /* Inserts reuse tombstones before empty entries, after enough churn
+     * there may be none left. Otherwise a probe sequence never crosses
+     * one, so walking from there every live entry's home comes before
+     * it. */
+    while (start <= m_mask && m_table[start].load(std::memory_order_relaxed) != EMPTY) {
+      ++start;
+    }
+
+    if (start > m_mask) [[unlikely]] {
+      return rebuild_index();
+    }
+
+    size_t cleared{};
+
+    for (size_t i = 1; i <= m_mask; ++i) {
+      auto& entry = m_table[(start + i) & m_mask];
+      const auto link = entry.load(std::memory_order_relaxed);
+
+      if (link == EMPTY) {
+        continue;
+      }
+
+      entry.store(EMPTY, std::memory_order_relaxed);
+
+      if (link == TOMBSTONE) {
+        ++cleared;
+        continue;
+      }
+
+      assert((link & PENDING) == 0);
+
+      auto pos = home(m_key_fn(*m_list.to_item(static_cast<Link_type>(link))));
+
+      while (m_table[pos].load(std::memory_order_relaxed) != EMPTY) {
+        pos = (pos + 1) & m_mask;
+      }
+      m_table[pos].store(link, std::memory_order_relaxed);
+    }
+
+    std::atomic_thread_fence(std::memory_order_release);
+
+    return cleared;
+  }
+
+private:
+  /** compact_index() of a table without empty entries: clear it and index
+   * the list's elements again. @return the number of tombstones cleared. */
+  size_t rebuild_index() noexcept {
+    size_t cleared{};
+
+    for (size_t i = 0; i <= m_mask; ++i) {
+      cleared += m_table[i].load(std::memory_order_relaxed) == TOMBSTONE;
+      m_table[i].store(EMPTY, std::memory_order_relaxed);
+    }
+
+    m_list.for_each([this](item_reference item) {
+      auto pos = home(m_key_fn(item));
+
+      while (m_table[pos].load(std::memory_order_relaxed) != EMPTY) {
+        pos = (pos + 1) & m_mask;
+      }
+      m_table[pos].store(m_list.to_link(*m_list.to_node(item)), std::memory_order_relaxed);
+    });
+
+    std::atomic_thread_fence(std::memory_order_release);
+
+    return cleared;
+  }
+
+  /** Positions a probe sequence visits, no more than the table has. */
+  [[nodiscard]] size_t probes() const noexcept {
+    return std::min(MAX_PROBES, m_mask + 1);
+  }
+
+  /** An entry holds a slot link, with PENDING while the element is being
+   * linked. It takes the bit above the link, links as wide as Link_type
+   * get a 64 bit entry. */
+  using Entry_word = std::conditional_t<(node_type::LINK_BITS < std::numeric_limits<Link_type>::digits), Link_type, uint64_t>;
+  using Entry = std::atomic<Entry_word>;
+
+  /** Entry values besides slot links. Lookups stop at EMPTY and skip
+   * TOMBSTONE, inserts reuse both. */
+  static constexpr Entry_word EMPTY = node_type::NULL_PTR;
+  static constexpr Entry_word TOMBSTONE = node_type::DELETING_MARK;
+  static constexpr Entry_word PENDING = Entry_word{1} << node_type::LINK_BITS;
+
+  void init_table(size_t capacity) {
+    m_mask = std::bit_ceil(2 * capacity) - 1;
+    m_table = std::make_unique<Entry[]>(m_mask + 1);
+
+    for (size_t i = 0; i <= m_mask; ++i) {
+      m_table[i].store(EMPTY, std::memory_order_relaxed);
+    }
+  }
+
+  /** Start of key's probe sequence. The multiply spreads hashes that are
+   * the identity, like std::hash<int>. */
+  [[nodiscard]] size_t home(const key_type& key) const noexcept {
+    const auto hash = static_cast<uint64_t>(m_hash(key)) * 0x9E3779B97F4A7C15ull;
+
+    return static_cast<size_t>(hash >> 32) & m_mask;
+  }
+
+  /** @return whether entry, pending or not, holds an element with key. */
+  [[nodiscard]] bool matches(Entry_word entry, const key_type& key) noexcept {
+    return entry != EMPTY && entry != TOMBSTONE && m_key_fn(*m_list.to_item(static_cast<Link_type>(entry & ~PENDING))) == key;
+  }
+
+  /** @return the link of the published element with key, EMPTY if there is
+   *          none. */
+  [[nodiscard]] Link_type lookup(const key_type& key) noexcept {
+    auto pos = home(key);
+
+    for (size_t probe = 0; probe < probes(); ++probe, pos = (pos + 1) & m_mask) {
+      const auto entry = m_table[pos].load(std::memory_order_acquire);
+
+      if (entry == EMPTY) {
+        break;
+      }
+
+      if ((entry & PENDING) == 0 && matches(entry, key)) {
+        return static_cast<Link_type>(entry);
+      }
+    }
+
+    return EMPTY;
+  }
+
+  /**
+   * Claim a pending entry for item, run push, and publish the entry if
+   * push succeeds, drop it otherwise.
+   *
+   * Inserts claim the first free entry in the probe sequence and then
+   * check the rest of the sequence up to an EMPTY entry for the same key.
+   * The claim and the check are sequentially consistent, of two racing
+   * inserts of one key at least the later one sees the other and backs
+   * out, possibly both.
+   *
+   * Once push returns the element can already be removed again by a
+   * thread that found it in the list, its unindex() clears the pending
+   * entry and the publishing CAS leaves it alone.
+   */
+  template <typename Push>
+  [[nodiscard]] bool link(item_reference item, Push push) noexcept {
+    [[maybe_unused]] const auto guard = m_list.guard();
+    const auto& key = m_key_fn(item);
+    const Entry_word self = m_list.to_link(*m_list.to_node(item));
+    Entry* claimed{};
+    auto pos = home(key);
+
+    for (size_t probe = 0; probe < probes(); ++probe, pos = (pos + 1) & m_mask) {
+      auto& entry = m_table[pos];
+      auto link = entry.load(std::memory_order_seq_cst);
+
+      if (claimed == nullptr && (link == EMPTY || link == TOMBSTONE)) {
+        if (entry.compare_exchange_strong(link, self | PENDING, std::memory_order_seq_cst)) {
+          claimed = &entry;
+          continue;
+        }
+        /* Lost the entry, link is what the winner put there */
+      }
+
+      if (link == EMPTY) {
+        break;
+      }
+
+      if (&entry != claimed && matches(link, key)) {
+        /* Duplicate key */
+        if (claimed != nullptr) {
+          claimed->store(TOMBSTONE, std::memory_order_release);
+        }
+        return false;
+      }
+    }
+
+    if (claimed == nullptr) [[unlikely]] {
+      return false;
+    }
+
+    if (!push()) [[unlikely]] {
+      claimed->store(TOMBSTONE, std::memory_order_release);
+      return false;
+    }
+
+    auto pending = self | PENDING;
+
+    (void) claimed->compare_exchange_strong(pending, self, std::memory_order_release, std::memory_order_relaxed);
+    return true;
+  }
+
+  /** Clear the entry of item, which was removed from the list. It is
+   * still pending if the push that linked item hasn't published it. */
+  void unindex(item_reference item) noexcept {
+    const Entry_word self = m_list.to_link(*m_list.to_node(item));
+    auto pos = home(m_key_fn(item));
+
+    for (size_t probe = 0; probe < probes(); ++probe, pos = (pos + 1) & m_mask) {
+      auto& entry = m_table[pos];
+      auto link = entry.load(std::memory_order_relaxed);
+
+      /* The CAS fails if the entry was published meanwhile */
+      while ((link & ~PENDING) == self) {
+        if (entry.compare_exchange_weak(link, TOMBSTONE, std::memory_order_release, std::memory_order_relaxed)) {
+          return;
+        }
+      }
+    }
+
+    assert(false);
+  }
+
+  list_type m_list;
+  [[no_unique_address]] KeyFn m_key_fn{};
+  [[no_unique_address]] Hash m_hash{};
+  size_t m_mask{};
+  std::unique_ptr<Entry[]> m_table;
+};
+
+} // namespace ut
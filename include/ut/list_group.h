@@ -0,0 +1,295 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <utility>
+
+#include "ut/fixed_pool.h"
+#include "ut/lock_free_list.h"
+
+namespace ut {
+
+/** Whether a List_group allocates the slots of its array. */
+enum class Group_slots {
+  /** The group's pool owns the free slots. */
+  OWNED,
+
+  /** Slots are allocated elsewhere, e.g. by the group of another Node
+   * member of the same items. */
+  SHARED
+};
+
+/**
+ * Lists for the states of items over one backing array, e.g. clean, dirty and
+ * pinned pages, with shared slot allocation and per-item membership.
+ *
+ * An item is in at most one list of the group at a time. The group keeps
+ * a membership byte per slot, so membership() answers which one without a
+ * side table of the caller's. transfer() relinks an item from one list to
+ * another in place, see List::move_to_back(item, to): it is never free or
+ * in no list on the way.
+ *
+ *   ut::List_group<Page, &Page::state_node, 3> states(base, end);
+ *
+ *   auto page = states.allocate();
+ *   (void) states.push_back(CLEAN, *page);
+ *   ...
+ *   (void) states.transfer(*page, CLEAN, DIRTY);
+ *
+ * Items can embed a Node per group, one group per member addressed by its
+ * member pointer N, so a record can be in a list of each group at once.
+ * One group allocates the slots, the others are built with
+ * Group_slots::SHARED over the same array:
+ *
+ *   ut::List_group<Page, &Page::lru_node, 2> lru(base, end, ut::Group_slots::SHARED);
+ *
+ * Membership is claimed with a CAS before the lists are touched, group
+ * operations on the same item are serialized by it. Updating the lists
+ * directly through list() bypasses the membership bytes, use it to read.
+ *
+ * The lists share a Reclaim policy, each gets a copy of the one passed in.
+ * With epoch reclamation the domain's pool owns the slots: build the group
+ * with Group_slots::SHARED and retire() items instead of release()ing them.
+ *
+ * @tparam T       Item type.
+ * @tparam N       Member function of T returning the embedded Node.
+ * @tparam Lists   Number of lists in the group.
+ * @tparam Backoff Contention policy of the lists and the pool.
+ * @tparam Stats   Statistics policy of the lists, each counts its own.
+ * @tparam Reclaim Reclaim policy of the lists, see ut::List.
+ */
+template <typename T, auto N, size_t Lists, typename Backoff = No_backoff<>, typename Stats = No_stats,
+          typename Reclaim = No_reclaim>
+struct List_group {
+  using list_type = List<T, N, Backoff, Stats, Reclaim>;
+  using pool_type = Fixed_pool<T, N, Backoff>;
+  using slot_map = typename list_type::slot_map;
+  using item_pointer = typename list_type::item_pointer;
+  using item_reference = typename list_type::item_reference;
+
+  static_assert(!slot_map::SIDE_LINKS, "List_group needs embedded nodes");
+
+  /** membership() of an item that is in none of the lists. */
+  static constexpr size_t NO_LIST = 0xff;
+
+  /** membership() of an item that a group operation is relinking. */
+  static constexpr size_t MOVING = 0xfe;
+
+  static_assert(Lists > 0 && Lists < MOVING);
+
+  /** Lists over [base, end), with OWNED all slots start out free in the
+   * group's pool. */
+  List_group(item_pointer base, item_pointer end, Group_slots slots = Group_slots::OWNED, Reclaim reclaim = {})
+    : m_base(base),
+      m_capacity(static_cast<size_t>(end - base)),
+      m_lists(make_lists(base, end, reclaim, std::make_index_sequence<Lists>{})),
+      m_members(std::make_unique<std::atomic<uint8_t>[]>(m_capacity)) {
+
+    for (size_t i = 0; i < m_capacity; ++i) {
+      m_members[i].store(NO_LIST, std::memory_order_relaxed);
+    }
+
+    if (slots == Group_slots::OWNED) {
+      m_pool.emplace(base, end);
+    }
+  }
+
+  List_group(const List_group&) = delete;
+  List_group& operator=(const List_group&) = delete;
+
+  [[nodiscard]] list_type& list(size_t id) noexcept {
+    assert(id < Lists);
+    return m_lists[id];
+  }
+
+  /** @return nullptr if the slots are SHARED. */
+  [[nodiscard]] pool_type* pool() noexcept {
+    return m_pool ? &*m_pool : nullptr;
+  }
+
+  /**
+   * Take a free slot, it's in none of the lists.
+   *
+   * @return nullptr if the pool is empty or the slots are SHARED.
+   */
+  [[nodiscard]] item_pointer allocate() noexcept {
+    return m_pool ? m_pool->allocate() : nullptr;
+  }
+
+  /** Return an item that is in none of the lists to the pool. */
+  void release(item_reference item) noexcept {
+    assert(membership(item) == NO_LIST);
+
+    if (m_pool) [[likely]] {
+      m_pool->release(&item);
+    }
+  }
+
+  /** Hand an item that is in none of the lists to the Reclaim policy,
+   * see List::retire(). */
+  void retire(item_reference item) noexcept requires (Reclaim::ENABLED) {
+    assert(membership(item) == NO_LIST);
+    m_lists[0].retire(&item);
+  }
+
+  /** @return the list item is in, NO_LIST or MOVING. */
+  [[nodiscard]] size_t membership(const T& item) const noexcept {
+    return member(item).load(std::memory_order_acquire);
+  }
+
+  /** Append item, which must be in none of the lists, to list id.
+   * @return false if the push failed, item is then still in none. */
+  [[nodiscard]] bool push_back(size_t id, item_reference item) noexcept {
+    return link(id, item, false);
+  }
+
+  /** push_back() to the front of list id. */
+  [[nodiscard]] bool push_front(size_t id, item_reference item) noexcept {
+    return link(id, item, true);
+  }
+
+  /** Pop the front element of list id, it's then in none of the lists.
+   * @return nullptr if the list is empty. */
+  [[nodiscard]] item_pointer pop_front(size_t id) noexcept {
+    return unlisted(id, list(id).pop_front());
+  }
+
+  /** @see pop_front() */
+  [[nodiscard]] item_pointer pop_back(size_t id) noexcept {
+    return unlisted(id, list(id).pop_back());
+  }
+
+  /**
+   * Move item from list from to the back, or with to_front the front, of
+   * list to. from and to may be the same list.
+   *
+   * @return UNCHANGED if item is not in from, another group operation is
+   *         relinking it, or the move ran out of retries. REMOVED if the
+   *         move became a removal, see List::move_to_front(), the item is
+   *         then in none of the lists and the caller's.
+   */
+  [[nodiscard]] Move_result transfer(item_reference item, size_t from, size_t to, bool to_front = false) noexcept {
+    assert(from < Lists && to < Lists);
+
+    auto& state = member(item);
+    auto expected = static_cast<uint8_t>(from);
+
+    if (!state.compare_exchange_strong(expected, static_cast<uint8_t>(MOVING), std::memory_order_acq_rel)) [[unlikely]] {
+      return Move_result::UNCHANGED;
+    }
+
+    auto& source = m_lists[from];
+    Move_result result;
+
+    if (from == to) {
+      result = to_front ? source.move_to_front(item) : source.move_to_back(item);
+    } else {
+      result = to_front ? source.move_to_front(item, m_lists[to]) : source.move_to_back(item, m_lists[to]);
+    }
+
+    switch (result) {
+      case Move_result::MOVED:
+        state.store(static_cast<uint8_t>(to), std::memory_order_release);
+        break;
+      case Move_result::UNCHANGED:
+        state.store(static_cast<uint8_t>(from), std::memory_order_release);
+        break;
+      case Move_result::REMOVED:
+        state.store(static_cast<uint8_t>(NO_LIST), std::memory_order_release);
+        break;
+    }
+
+    return result;
+  }
+
+  /**
+   * Remove item from the list it's in.
+   *
+   * @return false if it's in none, or lost the race for it to another
+   *         thread.
+   */
+  [[nodiscard]] bool remove(item_reference item) noexcept {
+    auto& state = member(item);
+    auto id = state.load(std::memory_order_acquire);
+
+    for (;;) {
+      if (id == NO_LIST) [[unlikely]] {
+        return false;
+      } else if (id == MOVING) [[unlikely]] {
+        cpu_relax();
+        id = state.load(std::memory_order_acquire);
+      } else if (state.compare_exchange_weak(id, static_cast<uint8_t>(MOVING), std::memory_order_acq_rel)) [[likely]] {
+        break;
+      }
+    }
+
+    const bool removed = m_lists[id].remove(item) != nullptr;
+
+    state.store(removed ? static_cast<uint8_t>(NO_LIST) : id, std::memory_order_release);
+
+    return removed;
+  }
+
+private:
+  template <size_t... I>
+  [[nodiscard]] static std::array<list_type, Lists> make_lists(item_pointer base, item_pointer end, const Reclaim& reclaim,
+                                                               std::index_sequence<I...>) {
+    return {{((void) I, list_type(base, end, reclaim))...}};
+  }
+
+  [[nodiscard]] std::atomic<uint8_t>& member(const T& item) const noexcept {
+    assert(&item >= m_base && &item < m_base + m_capacity);
+    return m_members[static_cast<size_t>(&item - m_base)];
+  }
+
+  [[nodiscard]] bool link(size_t id, item_reference item, bool to_front) noexcept {
+    auto& state = member(item);
+    auto expected = static_cast<uint8_t>(NO_LIST);
+
+    if (!state.compare_exchange_strong(expected, static_cast<uint8_t>(MOVING), std::memory_order_acq_rel)) [[unlikely]] {
+      return false;
+    }
+
+    const bool linked = to_front ? list(id).push_front(item) : list(id).push_back(item);
+
+    state.store(static_cast<uint8_t>(linked ? id : NO_LIST), std::memory_order_release);
+
+    return linked;
+  }
+
+  /** Record that item, which was popped from list id, is in none. */
+  [[nodiscard]] item_pointer unlisted(size_t id, item_pointer item) noexcept {
+    if (item == nullptr) {
+      return nullptr;
+    }
+
+    auto& state = member(*item);
+
+    /* A group operation that claimed the item before we popped it fails
+     * and puts id back, or NO_LIST as it finds the item unlinked, a push
+     * that linked it hasn't recorded id yet */
+    for (;;) {
+      auto expected = static_cast<uint8_t>(id);
+
+      if (state.compare_exchange_weak(expected, static_cast<uint8_t>(NO_LIST), std::memory_order_acq_rel) || expected == NO_LIST) [[likely]] {
+        return item;
+      }
+      cpu_relax();
+    }
+  }
+
+  item_pointer m_base{};
+  size_t m_capacity{};
+  std::array<list_type, Lists> m_lists;
+  std::optional<pool_type> m_pool;
+
+  /** List id of each slot, NO_LIST or MOVING. */
+  std::unique_ptr<std::atomic<uint8_t>[]> m_members;
+};
+
+} // namespace ut
@@ -0,0 +1,271 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#if defined(__linux__)
+#include <ctime>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "ut/lock_free_list.h"
+
+namespace ut {
+
+/**
+ * Bounded MPMC work queue over a ut::List, push_back() in and pop_front()
+ * out, with blocking pops for idle consumers.
+ *
+ * Sleeping consumers wait on an eventcount: a waiter registers itself,
+ * reads the epoch and checks the queue once more before it sleeps on the
+ * epoch. A producer only bumps the epoch and wakes a waiter if one is
+ * registered, so with items present neither side makes a syscall.
+ * close() closes the queue, which returns parked consumers for a
+ * shutdown, notify_all() only wakes them to recheck.
+ *
+ * The bound is enforced with an exact element count next to the list's,
+ * try_push() fails without touching the list once it's reached.
+ *
+ *   ut::List_queue<Task, &Task::node> queue(base, end, 1024);
+ *
+ *   if (!queue.try_push(task)) {
+ *     // Full
+ *   }
+ *
+ *   auto task = queue.pop_front_wait(std::chrono::milliseconds(10));
+ *
+ * @tparam T       Item type.
+ * @tparam N       Node accessor, as for ut::List.
+ * @tparam Backoff Contention policy of the list.
+ * @tparam Stats   Statistics policy of the list, see ut::List.
+ * @tparam Reclaim Reclaim policy of the list, popped elements go to
+ *                 list().retire().
+ */
+template <typename T, auto N, typename Backoff = No_backoff<>, typename Stats = No_stats, typename Reclaim = No_reclaim>
+struct List_queue {
+  using list_type = List<T, N, Backoff, Stats, Reclaim>;
+  using slot_map = typename list_type::slot_map;
+  using node_pointer = typename list_type::node_pointer;
+  using item_pointer = typename list_type::item_pointer;
+  using item_reference = typename list_type::item_reference;
+
+  /** bound 0 is the capacity of [base, end). */
+  List_queue(item_pointer base, item_pointer end, size_t bound = 0, Reclaim reclaim = {}) noexcept
+    requires (!slot_map::SIDE_LINKS)
+    : m_list(base, end, std::move(reclaim)),
+      m_bound(bound == 0 ? static_cast<size_t>(end - base) : bound) {}
+
+  List_queue(item_pointer base, item_pointer end, node_pointer nodes, size_t bound = 0, Reclaim reclaim = {}) noexcept
+    requires (slot_map::SIDE_LINKS)
+    : m_list(base, end, nodes, std::move(reclaim)),
+      m_bound(bound == 0 ? static_cast<size_t>(end - base) : bound) {}
+
+  List_queue(const List_queue&) = delete;
+  List_queue& operator=(const List_queue&) = delete;
+
+  [[nodiscard]] list_type& list() noexcept {
+    return m_list;
+  }
+
+  [[nodiscard]] size_t bound() const noexcept {
+    return m_bound;
+  }
+
+  /** Elements in the queue, exact when it's quiescent. */
+  [[nodiscard]] size_t size() const noexcept {
+    return m_count.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * Append item and wake a waiting consumer if there is one.
+   *
+   * @return false if the queue is full or the push ran out of retries.
+   */
+  [[nodiscard]] bool try_push(item_reference item) noexcept {
+    if (m_count.fetch_add(1, std::memory_order_relaxed) >= m_bound) [[unlikely]] {
+      m_count.fetch_sub(1, std::memory_order_relaxed);
+      return false;
+    }
+
+    if (!m_list.push_back(item)) [[unlikely]] {
+      m_count.fetch_sub(1, std::memory_order_relaxed);
+      return false;
+    }
+
+    notify(1);
+    return true;
+  }
+
+  /** @return nullptr if the queue is empty, never blocks. */
+  [[nodiscard]] item_pointer try_pop() noexcept {
+    auto item = m_list.pop_front();
+
+    if (item != nullptr) [[likely]] {
+      m_count.fetch_sub(1, std::memory_order_relaxed);
+    }
+    return item;
+  }
+
+  /**
+   * Pop the front element, park until there is one.
+   *
+   * @return nullptr if the queue is empty and was closed by close().
+   */
+  [[nodiscard]] item_pointer pop_front_wait() noexcept {
+    for (;;) {
+      if (auto item = try_pop(); item != nullptr) [[likely]] {
+        return item;
+      }
+
+      const auto key = prepare_wait();
+
+      if (auto item = try_pop(); item != nullptr) {
+        cancel_wait();
+        return item;
+      }
+
+      if (closed()) [[unlikely]] {
+        cancel_wait();
+        return nullptr;
+      }
+
+      wait(key, nullptr);
+      cancel_wait();
+    }
+  }
+
+  /**
+   * Pop the front element, park for at most timeout until there is one.
+   *
+   * @return nullptr if the queue stayed empty, or is empty and was closed
+   *         by close().
+   */
+  template <typename Rep, typename Period>
+  [[nodiscard]] item_pointer pop_front_wait(const std::chrono::duration<Rep, Period>& timeout) noexcept {
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+
+    for (;;) {
+      if (auto item = try_pop(); item != nullptr) [[likely]] {
+        return item;
+      }
+
+      const auto key = prepare_wait();
+
+      if (auto item = try_pop(); item != nullptr) {
+        cancel_wait();
+        return item;
+      }
+
+      const auto now = std::chrono::steady_clock::now();
+
+      if (now >= deadline || closed()) {
+        cancel_wait();
+        return nullptr;
+      }
+
+      const auto remaining = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - now);
+
+      wait(key, &remaining);
+      cancel_wait();
+    }
+  }
+
+  /** Close the queue and wake all parked consumers, e.g. to shut down.
+   * From then on the blocking pops return nullptr on an empty queue
+   * instead of parking, the elements still in it can be popped. */
+  void close() noexcept {
+    m_closed.store(true, std::memory_order_seq_cst);
+    notify(INT32_MAX);
+  }
+
+  /** Wake all parked consumers without closing the queue. They recheck it
+   * and park again if it's still empty, a timed pop keeps its deadline. */
+  void notify_all() noexcept {
+    notify(INT32_MAX);
+  }
+
+  /** @return true once close() closed the queue. */
+  [[nodiscard]] bool closed() const noexcept {
+    return m_closed.load(std::memory_order_seq_cst);
+  }
+
+private:
+  /** Register as a waiter. @return the epoch to wait on. The waiter
+   * checks closed() after this, close() sets it before it reads the
+   * waiters, so either the waiter sees it or it's woken. */
+  [[nodiscard]] uint32_t prepare_wait() noexcept {
+    m_waiters.fetch_add(1, std::memory_order_seq_cst);
+    return m_epoch.load(std::memory_order_seq_cst);
+  }
+
+  void cancel_wait() noexcept {
+    m_waiters.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  /** Sleep while the epoch is key, for at most timeout if it's set. */
+  void wait(uint32_t key, const std::chrono::nanoseconds* timeout) noexcept {
+#if defined(__linux__)
+    timespec ts{};
+
+    if (timeout != nullptr) {
+      ts.tv_sec = static_cast<time_t>(timeout->count() / 1000000000);
+      ts.tv_nsec = static_cast<long>(timeout->count() % 1000000000);
+    }
+
+    (void) syscall(SYS_futex, reinterpret_cast<uint32_t*>(&m_epoch), FUTEX_WAIT_PRIVATE, key,
+                   timeout != nullptr ? &ts : nullptr, nullptr, 0);
+#else
+    if (timeout == nullptr) {
+      m_epoch.wait(key, std::memory_order_acquire);
+    } else {
+      /* No timed atomic wait, poll in short parks */
+      Park_backoff<>::park(64);
+    }
+#endif
+  }
+
+  /** Wake up to n waiters if there are any, after a state change. */
+  void notify(int n) noexcept {
+    /* Order the push before reading the waiters, pairs with
+     * prepare_wait(): either the waiter's recheck sees the element or we
+     * see the waiter. */
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (m_waiters.load(std::memory_order_relaxed) == 0) [[likely]] {
+      return;
+    }
+
+    m_epoch.fetch_add(1, std::memory_order_seq_cst);
+
+#if defined(__linux__)
+    (void) syscall(SYS_futex, reinterpret_cast<uint32_t*>(&m_epoch), FUTEX_WAKE_PRIVATE, n, nullptr, nullptr, 0);
+#else
+    if (n == 1) {
+      m_epoch.notify_one();
+    } else {
+      m_epoch.notify_all();
+    }
+#endif
+  }
+
+  list_type m_list;
+  size_t m_bound{};
+
+  /** Exact element count, for the bound. */
+  alignas(CACHE_LINE_SIZE) std::atomic<size_t> m_count{};
+
+  /** Eventcount, bumped by producers when a consumer is parked. */
+  alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> m_epoch{};
+  std::atomic<uint32_t> m_waiters{};
+
+  /** Set by close(), parked consumers return instead of parking again. */
+  std::atomic<bool> m_closed{};
+};
+
+} // namespace ut
@@ -1,40 +1,471 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <atomic>
+#include <bit>
 #include <cassert>
+#include <cstddef>
 #include <cstdint>
 #include <iterator>
 #include <limits>
+#include <memory>
+#include <thread>
+#include <type_traits>
 #include <utility>
+#include <vector>
 #include <optional>
 
+#include "ut/backoff.h"
+
+/** Define UT_LIST_PACKED_LAYOUT=1 to get the original List layout, with
+ * m_head, m_tail and a single m_size counter sharing one cache line. It
+ * exists to measure the effect of the padded layout. */
+#ifndef UT_LIST_PACKED_LAYOUT
+#define UT_LIST_PACKED_LAYOUT 0
+#endif
+
+/** Define UT_LIST_SNAPSHOT_EPOCH=1 to have every operation that updates
+ * links announce itself in the List_state, which makes List::snapshot()
+ * linearizable. It costs two atomic adds on a shared cache line per
+ * operation. */
+#ifndef UT_LIST_SNAPSHOT_EPOCH
+#define UT_LIST_SNAPSHOT_EPOCH 0
+#endif
+
+/** List::for_each_unordered() tests side link nodes with AVX2 or SSE4.1
+ * where the compiler can build them, define UT_LIST_SIMD_SCAN=0 for the
+ * scalar scan only. */
+#ifndef UT_LIST_SIMD_SCAN
+#if defined(__x86_64__) && defined(__GNUC__)
+#define UT_LIST_SIMD_SCAN 1
+#else
+#define UT_LIST_SIMD_SCAN 0
+#endif
+#endif
+
+#if UT_LIST_SIMD_SCAN
+#include <immintrin.h>
+#endif
+
 namespace ut {
 
+/** We don't use std::hardware_destructive_interference_size because its
+ * value is not ABI stable (GCC warns when it's used in a header). 64 bytes
+ * is right for current x86-64 and most AArch64 parts. */
+inline constexpr size_t CACHE_LINE_SIZE = 64;
+
+/** Prefetch the cache line at ptr for reading. */
+inline void prefetch(const void* ptr) noexcept {
+#if defined(__GNUC__)
+  __builtin_prefetch(ptr, 0, 3);
+#else
+  (void) ptr;
+#endif
+}
+
+/** Index of the calling thread's shard, threads are assigned round robin. */
+[[nodiscard]] inline size_t this_thread_shard() noexcept {
+  static std::atomic<size_t> next_shard{};
+  thread_local const size_t shard = next_shard.fetch_add(1, std::memory_order_relaxed);
+
+  return shard;
+}
+
+/**
+ * Element counter split into per-thread shards, each on its own cache
+ * line, so that concurrent updates don't bounce a single line. Updates
+ * from one thread always go to the same shard but any thread may
+ * decrement, so individual shards can go negative.
+ *
+ * load() sums the shards without synchronizing with writers, it is exact
+ * when the list is quiescent and approximate otherwise.
+ */
+template <size_t Shards = 16>
+struct Sharded_counter {
+  static_assert((Shards & (Shards - 1)) == 0, "Shards must be a power of two");
+
+  void add(int64_t n) noexcept {
+    m_shards[this_thread_shard() & (Shards - 1)].m_value.fetch_add(n, std::memory_order_relaxed);
+  }
+
+  void sub(int64_t n) noexcept {
+    m_shards[this_thread_shard() & (Shards - 1)].m_value.fetch_sub(n, std::memory_order_relaxed);
+  }
+
+  [[nodiscard]] size_t load() const noexcept {
+    int64_t sum{};
+
+    for (const auto& shard : m_shards) {
+      sum += shard.m_value.load(std::memory_order_relaxed);
+    }
+    return sum > 0 ? static_cast<size_t>(sum) : 0;
+  }
+
+  /** Set the count, not safe against concurrent updates. */
+  void store(size_t n) noexcept {
+    for (auto& shard : m_shards) {
+      shard.m_value.store(0, std::memory_order_relaxed);
+    }
+    m_shards[0].m_value.store(static_cast<int64_t>(n), std::memory_order_relaxed);
+  }
+
+  struct alignas(CACHE_LINE_SIZE) Shard {
+    std::atomic<int64_t> m_value{};
+  };
+
+  std::array<Shard, Shards> m_shards{};
+};
+
+/** Single shared counter, used by the packed layout. */
+struct Packed_counter {
+  void add(int64_t n) noexcept {
+    m_value.fetch_add(n, std::memory_order_relaxed);
+  }
+
+  void sub(int64_t n) noexcept {
+    m_value.fetch_sub(n, std::memory_order_relaxed);
+  }
+
+  [[nodiscard]] size_t load() const noexcept {
+    const auto value = m_value.load(std::memory_order_relaxed);
+    return value > 0 ? static_cast<size_t>(value) : 0;
+  }
+
+  void store(size_t n) noexcept {
+    m_value.store(static_cast<int64_t>(n), std::memory_order_relaxed);
+  }
+
+  std::atomic<int64_t> m_value{};
+};
+
+/** Events counted by a List's stats policy. */
+enum class List_stat : size_t {
+  /** Operations started: remove(), push_*(), insert_*(), move_to_*(),
+   * pop_*() and the front detach. pop_*() also count their remove(). */
+  ATTEMPTS,
+
+  /** Iterations of an operation's retry loop after the first. */
+  RETRIES,
+
+  /** Failed DELETING_MARK CAS that claims a node for removal or a move. */
+  CLAIM_CAS_FAILURES,
+
+  /** A claim that found a neighbour claimed too, or no longer pointing at
+   * it, and put the node's links back. */
+  CLAIM_BACKOFFS,
+
+  /** Failed CAS on the list's head or tail. */
+  HEAD_CAS_FAILURES,
+  TAIL_CAS_FAILURES,
+
+  /** Failed CAS of insert_*() on the node the new node is linked to. */
+  INSERT_CAS_FAILURES,
+
+  /** Failed CAS fixing up a neighbour's link, in unlink() or an insert. */
+  FIXUP_CAS_FAILURES,
+
+  /** An operation gave up because its retry budget was exhausted. */
+  RETRY_EXHAUSTED,
+
+  /** unlink() left a neighbour's link as is after exhausting its budget,
+   * steps 4 and 5 of remove(). */
+  FIXUP_GIVE_UPS,
+
+  /** push_*() found the old end node being removed and waited for it. */
+  END_NODE_REMOVED,
+
+  /** find(), find_prefetched() or a for_each() walk hit a removed node and
+   * restarted or waited. */
+  FIND_RESTARTS,
+
+  /** An iterator stepped past nodes removed under it. */
+  ITERATOR_RESYNCS,
+
+  /** Iterator_invalidated was thrown. */
+  ITERATOR_INVALIDATED,
+
+  COUNT
+};
+
+/** Name of stat, e.g. for a metrics exporter. */
+[[nodiscard]] constexpr const char* to_string(List_stat stat) noexcept {
+  constexpr const char* NAMES[] = {
+    "attempts", "retries", "claim_cas_failures", "claim_backoffs", "head_cas_failures", "tail_cas_failures",
+    "insert_cas_failures", "fixup_cas_failures", "retry_exhausted", "fixup_give_ups",
+    "end_node_removed", "find_restarts", "iterator_resyncs", "iterator_invalidated",
+  };
+
+  static_assert(std::size(NAMES) == static_cast<size_t>(List_stat::COUNT));
+
+  return NAMES[static_cast<size_t>(stat)];
+}
+
+/** Outcome of List::move_to_front() and move_to_back(). */
+enum class Move_result {
+  /** The item is at the requested end. */
+  MOVED,
+
+  /** The item is not in the list or its claim ran out of retries, nothing
+   * changed. */
+  UNCHANGED,
+
+  /** The item was unlinked but publishing it ran out of retries, the move
+   * became a removal and the item is in no list. The caller owns it like
+   * after a remove(). */
+  REMOVED,
+};
+
+/** Snapshot of a List's counters, returned by List::stats(). */
+struct List_stats {
+  [[nodiscard]] uint64_t operator[](List_stat stat) const noexcept {
+    return m_counters[static_cast<size_t>(stat)];
+  }
+
+  /** Call f(stat, value) for each counter. */
+  template <typename F>
+  void for_each(F&& f) const {
+    for (size_t i = 0; i < m_counters.size(); ++i) {
+      f(static_cast<List_stat>(i), m_counters[i]);
+    }
+  }
+
+  std::array<uint64_t, static_cast<size_t>(List_stat::COUNT)> m_counters{};
+};
+
+/**
+ * Stats policies of ut::List, the last template parameter.
+ *
+ *  - ENABLED is false if the policy records nothing, the iterators then
+ *    don't carry a pointer to it.
+ *  - add(stat, n) records n events, it's called on the hot paths.
+ *  - snapshot() sums the counters, reset() clears them.
+ */
+
+/** Record nothing, the default. Every call compiles away. */
+struct No_stats {
+  static constexpr bool ENABLED = false;
+
+  void add(List_stat, uint64_t = 1) noexcept {}
+
+  [[nodiscard]] List_stats snapshot() const noexcept {
+    return {};
+  }
+
+  void reset() noexcept {}
+};
+
+/**
+ * Counters split into per-thread shards like Sharded_counter, a thread
+ * only touches its own shard's cache lines. snapshot() is exact when no
+ * thread is updating them.
+ */
+template <size_t Shards = 16>
+struct Sharded_stats {
+  static_assert((Shards & (Shards - 1)) == 0, "Shards must be a power of two");
+
+  static constexpr bool ENABLED = true;
+
+  void add(List_stat stat, uint64_t n = 1) noexcept {
+    m_shards[this_thread_shard() & (Shards - 1)].m_counters[static_cast<size_t>(stat)].fetch_add(n, std::memory_order_relaxed);
+  }
+
+  [[nodiscard]] List_stats snapshot() const noexcept {
+    List_stats stats{};
+
+    for (const auto& shard : m_shards) {
+      for (size_t i = 0; i < stats.m_counters.size(); ++i) {
+        stats.m_counters[i] += shard.m_counters[i].load(std::memory_order_relaxed);
+      }
+    }
+    return stats;
+  }
+
+  void reset() noexcept {
+    for (auto& shard : m_shards) {
+      for (auto& counter : shard.m_counters) {
+        counter.store(0, std::memory_order_relaxed);
+      }
+    }
+  }
+
+  struct alignas(CACHE_LINE_SIZE) Shard {
+    std::array<std::atomic<uint64_t>, static_cast<size_t>(List_stat::COUNT)> m_counters{};
+  };
+
+  std::array<Shard, Shards> m_shards{};
+};
+
+/**
+ * Reclaim policies of ut::List, the parameter after Stats. They decide
+ * when a removed slot may be reused:
+ *
+ *  - ENABLED is false if the policy leaves that to the caller, the list
+ *    then has no retire() and the iterators don't carry a guard.
+ *  - guard() returns a Guard that keeps the slots the calling thread can
+ *    reach from being reused while it's alive. find(), the walks, the
+ *    removals, the inserts and every iterator hold one. A Guard is
+ *    copyable, copies guard again.
+ *  - retire(item) hands a removed slot to the policy, it's reused once no
+ *    guard that could have seen it is left.
+ *
+ * See ut/epoch.h for the epoch based policy.
+ */
+
+/** Guard nothing, the default. The caller must not reuse a removed slot
+ * while a reader may still hold it. */
+struct No_reclaim {
+  static constexpr bool ENABLED = false;
+
+  struct Guard {};
+
+  [[nodiscard]] Guard guard() const noexcept {
+    return {};
+  }
+};
+
+/** Rounds of await() that spin before it starts to yield. */
+inline constexpr uint32_t AWAIT_SPINS = 64;
+
+/** Bound of await(), in rounds. */
+inline constexpr uint32_t AWAIT_ROUNDS = AWAIT_SPINS + 4096;
+
+/**
+ * Wait for a step of another thread that is a handful of instructions
+ * once that thread runs, e.g. a claim that backs off. Spins first, then
+ * yields in case the other thread was preempted.
+ *
+ * @return false if done() still didn't hold after AWAIT_ROUNDS.
+ */
+template <typename Done>
+[[nodiscard]] inline bool await(Done&& done) noexcept(noexcept(done())) {
+  for (uint32_t round{}; round < AWAIT_ROUNDS; ++round) {
+    if (done()) [[likely]] {
+      return true;
+    } else if (round < AWAIT_SPINS) {
+      cpu_relax();
+    } else {
+      std::this_thread::yield();
+    }
+  }
+  return done();
+}
+
 struct Iterator_invalidated : public std::runtime_error {
   explicit Iterator_invalidated(const char* msg) : std::runtime_error(msg) {}
 };
 
-struct Node {
-  using Link_type = uint32_t;
-  using Version_type = uint8_t;
+/**
+ * Bit layout of a node's link word: the next and prev links of LinkBits
+ * each and one version counter per link taking the remaining bits. All
+ * the shifts and masks are compile time constants, pack_links() and
+ * unpack_links() compile to the same code as hand written bit fiddling.
+ *
+ * The all ones link values are reserved (NULL_PTR, DELETING_MARK), a list
+ * over this layout can address at most MAX_CAPACITY slots.
+ *
+ * Link bits and version bits trade against each other. A link's version
+ * wraps after VERSION_PERIOD modifications, a thread that stalls between
+ * reading a neighbour's links and its CAS in remove() or insert_*() is
+ * only protected against ABA if fewer modifications than that happen in
+ * between. Layout_for_capacity picks the widest versions for a capacity.
+ *
+ * @tparam Word     Unsigned integer holding both links, it must be usable
+ *                  with std::atomic.
+ * @tparam LinkBits Width of the next and prev links.
+ */
+template <typename Word, uint32_t LinkBits>
+struct Link_layout {
+  static constexpr uint32_t WORD_BITS = sizeof(Word) * 8;
+
+  static constexpr uint32_t LINK_BITS = LinkBits;
+  static constexpr uint32_t VERSION_BITS_PER_LINK = (WORD_BITS - 2 * LinkBits) / 2;
+
+  static_assert(LinkBits >= 2 && LinkBits < 64, "Invalid link width");
+  static_assert(VERSION_BITS_PER_LINK > 0, "No room for the version counters");
+
+  using Word_type = Word;
+  using Link_type = std::conditional_t<(LinkBits <= 32), uint32_t, uint64_t>;
+  using Version_type =
+    std::conditional_t<(VERSION_BITS_PER_LINK <= 8), uint8_t,
+    std::conditional_t<(VERSION_BITS_PER_LINK <= 16), uint16_t,
+    std::conditional_t<(VERSION_BITS_PER_LINK <= 32), uint32_t, uint64_t>>>;
+
+  static constexpr Link_type LINK_MASK = static_cast<Link_type>((uint64_t{1} << LINK_BITS) - 1);
+  static constexpr Version_type VERSION_MASK = static_cast<Version_type>((uint64_t{1} << VERSION_BITS_PER_LINK) - 1);
+
+  /** Modifications of a link before its version repeats. */
+  static constexpr uint64_t VERSION_PERIOD = uint64_t{VERSION_MASK} + 1;
+
+  /* Field positions, from the least significant bit up: prev_version,
+   * prev, next_version, next. */
+  static constexpr uint32_t PREV_LINK_SHIFT = VERSION_BITS_PER_LINK;
+  static constexpr uint32_t NEXT_VERSION_SHIFT = VERSION_BITS_PER_LINK + LINK_BITS;
+  static constexpr uint32_t NEXT_LINK_SHIFT = 2 * VERSION_BITS_PER_LINK + LINK_BITS;
+
+  static constexpr Link_type NULL_PTR = LINK_MASK;
+  static constexpr Link_type DELETING_MARK = NULL_PTR - 1;
+  static constexpr Word NULL_LINK = static_cast<Word>(~Word{0});
+  static constexpr uint64_t MAX_CAPACITY = DELETING_MARK;
+};
+
+#if defined(__SIZEOF_INT128__)
+__extension__ using uint128_t = unsigned __int128;
+#endif
 
-  // Configuration: Total bits for version counters (2 bits per version)
-  static constexpr uint32_t VERSION_BITS_PER_LINK = 2;
-  static constexpr uint32_t TOTAL_VERSION_BITS = VERSION_BITS_PER_LINK * 2;  // next_version + prev_version
+/** 32 bit link word, 14 bit links. For many small lists where the size of
+ * the embedded node matters, a list is limited to 16K - 2 slots. */
+using Layout_32 = Link_layout<uint32_t, 14>;
 
-  // Derived constants
-  static constexpr uint32_t LINK_BITS = (64 - TOTAL_VERSION_BITS) / 2;  // 30 bits per link
-  static constexpr auto VERSION_MASK = (1u << VERSION_BITS_PER_LINK) - 1;  // 0x3 for 2 bits
-  static constexpr auto NULL_PTR = (1u << LINK_BITS) - 1;  // Max value for link bits
-  static constexpr auto DELETING_MARK = NULL_PTR - 1;  // Marks node as being deleted
-  static constexpr auto NULL_LINK = std::numeric_limits<uint64_t>::max();
-  static constexpr uint32_t MAX_RETRIES = 100;
+/** The default, 30 bit links and 2 bit versions in a 64 bit word. */
+using Layout_64 = Link_layout<uint64_t, 30>;
 
-  Node() = default;
-  Node(Node&& rhs) noexcept : m_links(rhs.m_links.load(std::memory_order_relaxed)) {}
-  Node(Link_type next, Link_type prev, Version_type version) noexcept;
+/** Narrowest link width that can address capacity slots. */
+[[nodiscard]] constexpr uint32_t link_bits_for(uint64_t capacity) noexcept {
+  uint32_t bits{2};
 
-  Node& operator=(Node&& rhs) noexcept {
+  /* The two largest link values are reserved */
+  while (bits < 63 && (uint64_t{1} << bits) - 2 < capacity) {
+    ++bits;
+  }
+  return bits;
+}
+
+/**
+ * Layout with the widest version counters that still addresses Capacity
+ * slots, e.g. Layout_for_capacity<(1 << 24) - 2> has 24 bit links and 8
+ * bit versions. A Word too small for Capacity fails to compile.
+ */
+template <uint64_t Capacity, typename Word = uint64_t>
+using Layout_for_capacity = Link_layout<Word, link_bits_for(Capacity)>;
+
+#if defined(__SIZEOF_INT128__)
+/** 48 bit links and 16 bit versions for arenas beyond 1G slots. The 128
+ * bit CAS is cmpxchg16b on x86-64 (build with -mcx16, or link libatomic
+ * which selects it at run time). */
+using Layout_128 = Link_layout<uint128_t, 48>;
+#endif
+
+template <typename Layout>
+struct Basic_node {
+  using layout_type = Layout;
+  using Link_word = typename Layout::Word_type;
+  using Link_type = typename Layout::Link_type;
+  using Version_type = typename Layout::Version_type;
+
+  static constexpr uint32_t VERSION_BITS_PER_LINK = Layout::VERSION_BITS_PER_LINK;
+  static constexpr uint32_t TOTAL_VERSION_BITS = VERSION_BITS_PER_LINK * 2;  // next_version + prev_version
+  static constexpr uint32_t LINK_BITS = Layout::LINK_BITS;
+  static constexpr auto VERSION_MASK = Layout::VERSION_MASK;
+  static constexpr auto NULL_PTR = Layout::NULL_PTR;  // Max value for link bits
+  static constexpr auto DELETING_MARK = Layout::DELETING_MARK;  // Marks node as being deleted
+  static constexpr auto NULL_LINK = Layout::NULL_LINK;
+  static constexpr uint32_t MAX_RETRIES = DEFAULT_MAX_RETRIES;
+
+  Basic_node() = default;
+  Basic_node(Basic_node&& rhs) noexcept : m_links(rhs.m_links.load(std::memory_order_relaxed)) {}
+
+  Basic_node& operator=(Basic_node&& rhs) noexcept {
     m_links.store(rhs.m_links.load(std::memory_order_relaxed), std::memory_order_relaxed);
     return *this;
   }
@@ -46,70 +477,231 @@ struct Node {
   [[nodiscard]] bool is_deleting() const noexcept {
     auto links = m_links.load(std::memory_order_acquire);
     if (links == NULL_LINK) return false;
-    auto next = static_cast<Link_type>((links >> (VERSION_BITS_PER_LINK + LINK_BITS + VERSION_BITS_PER_LINK)) & ((1u << LINK_BITS) - 1));
-    return next == DELETING_MARK;
+    return next_link(links) == DELETING_MARK;
   }
 
+  /** Removed or claimed for removal. A pinned node, an insert anchor or a
+   * node being moved, is neither: its next link is kept, see
+   * List::is_claimed(). */
   [[nodiscard]] bool is_removed_or_deleting() const noexcept {
     auto links = m_links.load(std::memory_order_acquire);
     if (links == NULL_LINK) return true;
-    auto next = static_cast<Link_type>((links >> (VERSION_BITS_PER_LINK + LINK_BITS + VERSION_BITS_PER_LINK)) & ((1u << LINK_BITS) - 1));
-    return next == DELETING_MARK;
+    return next_link(links) == DELETING_MARK;
   }
 
   void invalidate() noexcept {
     m_links.store(NULL_LINK, std::memory_order_relaxed);
   }
 
-  /** Atomic links storage layout (64 bits total):
+  [[nodiscard]] static constexpr Link_type next_link(Link_word links) noexcept {
+    return static_cast<Link_type>((links >> Layout::NEXT_LINK_SHIFT) & Layout::LINK_MASK);
+  }
+
+  /** Atomic links storage, see Link_layout:
    *  - next link (LINK_BITS)
    *  - next_version (VERSION_BITS_PER_LINK)
    *  - prev link (LINK_BITS)
    *  - prev_version (VERSION_BITS_PER_LINK)
    */
-  std::atomic<uint64_t> m_links{NULL_LINK};
+  std::atomic<Link_word> m_links{NULL_LINK};
 };
 
-[[nodiscard]] inline constexpr uint64_t pack_links(Node::Link_type next, Node::Link_type prev, Node::Version_type next_version, Node::Version_type prev_version) noexcept {
-  constexpr uint32_t LINK_MASK = (1u << Node::LINK_BITS) - 1;
-  constexpr uint32_t PREV_VERSION_BITS = Node::VERSION_BITS_PER_LINK;
-  constexpr uint32_t PREV_LINK_SHIFT = PREV_VERSION_BITS;
-  constexpr uint32_t NEXT_VERSION_SHIFT = PREV_VERSION_BITS + Node::LINK_BITS;
-  constexpr uint32_t NEXT_LINK_SHIFT = PREV_VERSION_BITS + Node::LINK_BITS + Node::VERSION_BITS_PER_LINK;
-
-  return (static_cast<uint64_t>(next & LINK_MASK) << NEXT_LINK_SHIFT) |
-         (static_cast<uint64_t>(next_version & Node::VERSION_MASK) << NEXT_VERSION_SHIFT) |
-         (static_cast<uint64_t>(prev & LINK_MASK) << PREV_LINK_SHIFT) |
-         static_cast<uint64_t>(prev_version & Node::VERSION_MASK);
+using Node = Basic_node<Layout_64>;
+using Node_32 = Basic_node<Layout_32>;
+
+#if defined(__SIZEOF_INT128__)
+using Node_128 = Basic_node<Layout_128>;
+#endif
+
+/** Node for lists of at most Capacity slots, see Layout_for_capacity. */
+template <uint64_t Capacity, typename Word = uint64_t>
+using Node_for_capacity = Basic_node<Layout_for_capacity<Capacity, Word>>;
+
+template <typename Layout = Layout_64>
+[[nodiscard]] inline constexpr typename Layout::Word_type pack_links(
+  typename Layout::Link_type next, typename Layout::Link_type prev,
+  typename Layout::Version_type next_version, typename Layout::Version_type prev_version) noexcept {
+
+  using Word = typename Layout::Word_type;
+
+  return (static_cast<Word>(next & Layout::LINK_MASK) << Layout::NEXT_LINK_SHIFT) |
+         (static_cast<Word>(next_version & Layout::VERSION_MASK) << Layout::NEXT_VERSION_SHIFT) |
+         (static_cast<Word>(prev & Layout::LINK_MASK) << Layout::PREV_LINK_SHIFT) |
+         static_cast<Word>(prev_version & Layout::VERSION_MASK);
 }
 
-struct Link_pack {
-  Node::Link_type next;
-  Node::Link_type prev;
-  Node::Version_type next_version;
-  Node::Version_type prev_version;
+template <typename Layout = Layout_64>
+struct Basic_link_pack {
+  typename Layout::Link_type next;
+  typename Layout::Link_type prev;
+  typename Layout::Version_type next_version;
+  typename Layout::Version_type prev_version;
 
   [[nodiscard]] bool is_deleting() const noexcept {
-    return next == Node::DELETING_MARK;
+    return next == Layout::DELETING_MARK;
+  }
+
+  /** Held by an insert next to the node or a move of it, the prev link is
+   * not in the word meanwhile, see List::is_claimed(). */
+  [[nodiscard]] bool is_pinned() const noexcept {
+    return prev == Layout::DELETING_MARK;
   }
 };
 
-[[nodiscard]] inline Link_pack unpack_links(uint64_t links) noexcept {
-  constexpr uint32_t LINK_MASK = (1u << Node::LINK_BITS) - 1;
-  constexpr uint32_t PREV_VERSION_BITS = Node::VERSION_BITS_PER_LINK;
-  constexpr uint32_t PREV_LINK_SHIFT = PREV_VERSION_BITS;
-  constexpr uint32_t NEXT_VERSION_SHIFT = PREV_VERSION_BITS + Node::LINK_BITS;
-  constexpr uint32_t NEXT_LINK_SHIFT = PREV_VERSION_BITS + Node::LINK_BITS + Node::VERSION_BITS_PER_LINK;
+using Link_pack = Basic_link_pack<Layout_64>;
+
+template <typename Layout = Layout_64>
+[[nodiscard]] inline constexpr Basic_link_pack<Layout> unpack_links(typename Layout::Word_type links) noexcept {
+  using Link_type = typename Layout::Link_type;
+  using Version_type = typename Layout::Version_type;
 
   return {
-    static_cast<Node::Link_type>((links >> NEXT_LINK_SHIFT) & LINK_MASK),
-    static_cast<Node::Link_type>((links >> PREV_LINK_SHIFT) & LINK_MASK),
-    static_cast<Node::Version_type>((links >> NEXT_VERSION_SHIFT) & Node::VERSION_MASK),
-    static_cast<Node::Version_type>(links & Node::VERSION_MASK)
+    static_cast<Link_type>((links >> Layout::NEXT_LINK_SHIFT) & Layout::LINK_MASK),
+    static_cast<Link_type>((links >> Layout::PREV_LINK_SHIFT) & Layout::LINK_MASK),
+    static_cast<Version_type>((links >> Layout::NEXT_VERSION_SHIFT) & Layout::VERSION_MASK),
+    static_cast<Version_type>(links & Layout::VERSION_MASK)
   };
 }
 
-template<typename T, auto N, bool IsConst = false>
+/** Inverse of an odd number modulo 2^64, each Newton step doubles the
+ * number of correct low bits. */
+[[nodiscard]] constexpr uint64_t modular_inverse(uint64_t odd) noexcept {
+  /* odd * odd == 1 (mod 8), 3 correct bits to start with */
+  uint64_t inverse{odd};
+
+  for (int i = 0; i < 5; ++i) {
+    inverse *= 2 - odd * inverse;
+  }
+  return inverse;
+}
+
+/**
+ * n / Divisor for an n that is known to be a multiple of Divisor. A power
+ * of two is a shift, otherwise we shift out the divisor's trailing zeros
+ * and multiply by the inverse of its odd part, one imul. A plain division
+ * by a constant needs a widening multiply plus a shift.
+ */
+template <uint64_t Divisor>
+[[nodiscard]] constexpr uint64_t exact_divide(uint64_t n) noexcept {
+  static_assert(Divisor > 0);
+
+  constexpr auto SHIFT = std::countr_zero(Divisor);
+
+  if constexpr (std::has_single_bit(Divisor)) {
+    return n >> SHIFT;
+  } else {
+    constexpr auto INVERSE = modular_inverse(Divisor >> SHIFT);
+
+    return (n >> SHIFT) * INVERSE;
+  }
+}
+
+/** Index of the slot in the array at base whose embedded node is node. We
+ * measure from the first slot's node, so the offset is an exact multiple
+ * of sizeof(T). */
+template <typename T, auto N, typename Node_type>
+[[nodiscard]] inline uint64_t slot_index(const T* base, const Node_type* node) noexcept {
+  const auto first = reinterpret_cast<const std::byte*>(&(const_cast<T*>(base)->*N)());
+  const auto offset = reinterpret_cast<const std::byte*>(node) - first;
+
+  return exact_divide<sizeof(T)>(static_cast<uint64_t>(offset));
+}
+
+/**
+ * Pass SIDE_LINKS<Node_type> as the List's N to keep the nodes out of T.
+ * They then live in a separate, caller provided array parallel to the
+ * items, node i belongs to item i. Traversals only touch the dense node
+ * array, 64 / sizeof(Node_type) links per cache line, and the payload is
+ * read only for the items actually visited.
+ */
+template <typename Node_type = Node>
+struct Side_links {
+  using node_type = Node_type;
+};
+
+template <typename Node_type = Node>
+inline constexpr Side_links<Node_type> SIDE_LINKS{};
+
+template <typename N>
+struct Is_side_links : std::false_type {};
+
+template <typename Node_type>
+struct Is_side_links<Side_links<Node_type>> : std::true_type {};
+
+template <typename T, auto N, bool = Is_side_links<std::remove_cv_t<decltype(N)>>::value>
+struct Node_of {
+  using type = std::remove_reference_t<typename std::invoke_result_t<decltype(N), T>>;
+};
+
+template <typename T, auto N>
+struct Node_of<T, N, true> {
+  using type = typename std::remove_cv_t<decltype(N)>::node_type;
+};
+
+/** Placeholder for the node array pointer of embedded nodes. */
+struct No_side_links {
+  [[nodiscard]] bool operator==(const No_side_links&) const noexcept = default;
+};
+
+/**
+ * Mapping between items, their nodes and their links (array indices),
+ * for either node placement. Embedded nodes are found through N, side
+ * link nodes by index into m_nodes.
+ */
+template <typename T, auto N>
+struct Slot_map {
+  static constexpr bool SIDE_LINKS = Is_side_links<std::remove_cv_t<decltype(N)>>::value;
+
+  using node_type = typename Node_of<T, N>::type;
+  using Link_type = typename node_type::Link_type;
+  using Nodes = std::conditional_t<SIDE_LINKS, node_type*, No_side_links>;
+
+  [[nodiscard]] node_type& node(const T& item) const noexcept {
+    if constexpr (SIDE_LINKS) {
+      return m_nodes[&item - m_base];
+    } else {
+      return (const_cast<T&>(item).*N)();
+    }
+  }
+
+  [[nodiscard]] node_type* node(Link_type link) const noexcept {
+    if constexpr (SIDE_LINKS) {
+      return &m_nodes[link];
+    } else {
+      return &(m_base[link].*N)();
+    }
+  }
+
+  [[nodiscard]] Link_type link(const node_type& node) const noexcept {
+    if constexpr (SIDE_LINKS) {
+      return static_cast<Link_type>(&node - m_nodes);
+    } else {
+      return static_cast<Link_type>(slot_index<T, N>(m_base, &node));
+    }
+  }
+
+  [[nodiscard]] T* item(Link_type link) const noexcept {
+    return &m_base[link];
+  }
+
+  [[nodiscard]] T* item(const node_type& node) const noexcept {
+    return item(link(node));
+  }
+
+  [[nodiscard]] bool operator==(const Slot_map&) const noexcept = default;
+
+  T* m_base{};
+  [[no_unique_address]] Nodes m_nodes{};
+};
+
+/**
+ * Bidirectional iterator of a List. Resyncs past removed nodes are
+ * bounded by the list's Backoff budget and paused by its policy. With an
+ * enabled stats policy it records resyncs and invalidations in the list's
+ * counters. With an enabled reclaim policy it holds a guard for as long
+ * as it lives, the nodes it can reach aren't reused under it.
+ */
+template<typename T, auto N, bool IsConst = false, typename Backoff = No_backoff<>, typename Stats = No_stats, typename Reclaim = No_reclaim>
 struct List_iterator {
   using value_type = T;
   using difference_type = std::ptrdiff_t;
@@ -117,35 +709,72 @@ struct List_iterator {
   using reference = std::conditional_t<IsConst, const T&, T&>;
   using iterator_category = std::bidirectional_iterator_tag;
 
-  using result_type = typename std::invoke_result_t<decltype(N), T>;
-  using node_type = typename std::remove_reference<result_type>::type;
+  using slot_map = Slot_map<T, N>;
+  using node_type = typename slot_map::node_type;
+  using layout_type = typename node_type::layout_type;
   using node_pointer = std::conditional_t<IsConst, const node_type*, node_type*>;
 
+  /** A pointer to the list's stats, nothing if they're disabled. */
+  using stats_ref = std::conditional_t<Stats::ENABLED, Stats*, No_stats>;
+
+  /** A guard of the list's reclaim policy, nothing if it's disabled. */
+  using guard_type = typename Reclaim::Guard;
+
   List_iterator() = default;
 
   template<bool WasConst, typename = std::enable_if_t<IsConst && !WasConst>>
-  List_iterator(const List_iterator<T, N, WasConst>& rhs) noexcept
-    : m_base(rhs.m_base),
+  List_iterator(const List_iterator<T, N, WasConst, Backoff, Stats, Reclaim>& rhs) noexcept
+    : m_slots(rhs.m_slots),
       m_prev(rhs.m_prev),
-      m_current(rhs.m_current) {}
+      m_current(rhs.m_current),
+      m_stats(rhs.m_stats),
+      m_guard(rhs.m_guard) {}
 
-  List_iterator(pointer base, node_pointer current, node_pointer prev) noexcept
-    : m_base(base),
+  List_iterator(const slot_map& slots, node_pointer current, node_pointer prev, stats_ref stats = {}, guard_type guard = {}) noexcept
+    : m_slots(slots),
       m_prev(prev),
-      m_current(current) {}
+      m_current(current),
+      m_stats(stats),
+      m_guard(std::move(guard)) {}
+
+  void record(List_stat stat) const noexcept {
+    if constexpr (Stats::ENABLED) {
+      if (m_stats != nullptr) {
+        m_stats->add(stat);
+      }
+    }
+  }
+
+  /**
+   * The links of node for a step back. The prev link of a node that an
+   * insert or a move pins is not in its word, we wait for the pin to go,
+   * which is a few stores once the other thread runs.
+   *
+   * @throws Iterator_invalidated if the pin is still there after await().
+   */
+  [[nodiscard]] typename node_type::Link_word settled_links(const node_type& node) const {
+    auto links = node.m_links.load(std::memory_order_acquire);
+
+    if (unpack_links<layout_type>(links).is_pinned()) [[unlikely]] {
+      record(List_stat::ITERATOR_RESYNCS);
+
+      if (!await([&] { return !unpack_links<layout_type>(links = node.m_links.load(std::memory_order_acquire)).is_pinned(); })) {
+        record(List_stat::ITERATOR_INVALIDATED);
+        throw Iterator_invalidated("Iterator invalidated by concurrent modifications");
+      }
+    }
+
+    return links;
+  }
 
   [[nodiscard]] inline pointer to_item(node_pointer node) const noexcept {
     if (!node) return nullptr;
-    auto ptr = reinterpret_cast<const std::byte*>(node);
-    const auto offset = ptr - reinterpret_cast<const std::byte*>(m_base);
-    return &const_cast<pointer>(m_base)[offset / sizeof(T)];
+    return m_slots.item(*node);
   }
 
   [[nodiscard]] inline node_pointer to_node(typename node_type::Link_type link) const noexcept {
     if (link == node_type::NULL_PTR || link == node_type::DELETING_MARK) return nullptr;
-    auto base = const_cast<T*>(m_base);
-    auto& node = (base[link].*N)();
-    return const_cast<node_pointer>(&node);
+    return m_slots.node(link);
   }
 
   [[nodiscard]] inline bool operator==(const List_iterator& rhs) const noexcept {
@@ -170,7 +799,8 @@ struct List_iterator {
     }
 
     uint32_t retries{};
-    uint64_t raw_links = m_current->m_links.load(std::memory_order_acquire);
+    Backoff backoff{};
+    typename node_type::Link_word raw_links = m_current->m_links.load(std::memory_order_acquire);
 
     /* Handle deleted or deleting nodes */
     if (raw_links == node_type::NULL_LINK) [[unlikely]] {
@@ -180,12 +810,19 @@ struct List_iterator {
       return *this;
     }
 
-    auto current_links = unpack_links(raw_links);
+    auto current_links = unpack_links<layout_type>(raw_links);
     node_pointer next{to_node(current_links.next)};
 
-    /* Validate current node hasn't been removed */
-    if (to_node(current_links.prev) != m_prev) [[unlikely]] {
-      while (m_current != nullptr && to_node(current_links.prev) != m_prev && retries++ < node_type::MAX_RETRIES) [[likely]] {
+    /* Validate current node hasn't been removed. A pinned node is in
+     * place, its prev link just isn't in the word. */
+    if (!current_links.is_pinned() && to_node(current_links.prev) != m_prev) [[unlikely]] {
+      record(List_stat::ITERATOR_RESYNCS);
+
+      while (m_current != nullptr && to_node(current_links.prev) != m_prev && retries++ < Backoff::MAX_RETRIES) [[likely]] {
+        if (retries > 1) [[unlikely]] {
+          backoff.pause();
+        }
+
         m_current = to_node(current_links.next);
         if (m_current != nullptr) [[likely]] {
           raw_links = m_current->m_links.load(std::memory_order_acquire);
@@ -194,12 +831,13 @@ struct List_iterator {
             m_current = nullptr;
             return *this;
           }
-          current_links = unpack_links(raw_links);
+          current_links = unpack_links<layout_type>(raw_links);
           m_prev = to_node(current_links.prev);
         }
       }
 
-      if (retries >= node_type::MAX_RETRIES) {
+      if (retries >= Backoff::MAX_RETRIES) {
+        record(List_stat::ITERATOR_INVALIDATED);
         throw Iterator_invalidated("Iterator invalidated by concurrent modifications");
       }
     }
@@ -219,7 +857,8 @@ struct List_iterator {
     if (!m_prev) return *this;
 
     uint32_t retries = 0;
-    uint64_t raw_links = m_prev->m_links.load(std::memory_order_acquire);
+    Backoff backoff{};
+    typename node_type::Link_word raw_links = settled_links(*m_prev);
 
     /* Handle deleted nodes */
     if (raw_links == node_type::NULL_LINK) [[unlikely]] {
@@ -227,21 +866,30 @@ struct List_iterator {
       return *this;
     }
 
-    auto prev_links = unpack_links(raw_links);
+    auto prev_links = unpack_links<layout_type>(raw_links);
+
+    if (prev_links.is_deleting()) [[unlikely]] {
+      record(List_stat::ITERATOR_RESYNCS);
+    }
 
     /* Handle node being deleted - move past it */
-    while (prev_links.is_deleting() && m_prev != nullptr && retries++ < node_type::MAX_RETRIES) [[unlikely]] {
+    while (prev_links.is_deleting() && m_prev != nullptr && retries++ < Backoff::MAX_RETRIES) [[unlikely]] {
+      if (retries > 1) [[unlikely]] {
+        backoff.pause();
+      }
+
       m_prev = to_node(prev_links.prev);
       if (!m_prev) return *this;
-      raw_links = m_prev->m_links.load(std::memory_order_acquire);
+      raw_links = settled_links(*m_prev);
       if (raw_links == node_type::NULL_LINK) {
         m_prev = nullptr;
         return *this;
       }
-      prev_links = unpack_links(raw_links);
+      prev_links = unpack_links<layout_type>(raw_links);
     }
 
-    if (retries >= node_type::MAX_RETRIES) {
+    if (retries >= Backoff::MAX_RETRIES) {
+      record(List_stat::ITERATOR_INVALIDATED);
       throw Iterator_invalidated("Iterator invalidated by concurrent modifications");
     }
 
@@ -264,38 +912,230 @@ struct List_iterator {
     return tmp;
   }
 
-  pointer m_base{};
+  slot_map m_slots{};
   node_pointer m_prev{};
   node_pointer m_current{};
+  [[no_unique_address]] stats_ref m_stats{};
+  [[no_unique_address]] guard_type m_guard{};
 };
 
-template <typename T, auto N>
+/**
+ * Head, tail and element count of a List. A List has its own unless it's
+ * built over an external one, which makes the list's state independent of
+ * the List object: a shared memory segment can hold the state and the
+ * array, and each process builds a List over them at whatever address it
+ * mapped the segment, see ut/shared_list.h. Everything in it is a slot
+ * index or a count.
+ */
+template <typename Layout>
+struct List_state {
+  using Link_type = typename Layout::Link_type;
+
+  static constexpr Link_type NULL_PTR = Layout::NULL_PTR;
+
+#if UT_LIST_PACKED_LAYOUT
+  using Size_counter = Packed_counter;
+
+  std::atomic<Link_type> m_head{NULL_PTR};
+  std::atomic<Link_type> m_tail{NULL_PTR};
+  Size_counter m_size{};
+#else
+  using Size_counter = Sharded_counter<>;
+
+  /* Producers CAS m_tail, consumers CAS m_head and every operation updates
+   * the size, give each its own cache line. */
+  alignas(CACHE_LINE_SIZE) std::atomic<Link_type> m_head{NULL_PTR};
+  alignas(CACHE_LINE_SIZE) std::atomic<Link_type> m_tail{NULL_PTR};
+  Size_counter m_size{};
+#endif // UT_LIST_PACKED_LAYOUT
+
+#if UT_LIST_SNAPSHOT_EPOCH
+  /* Operations that started and finished updating links, they're equal
+   * when no update is in flight. */
+  alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> m_writes_begun{};
+  std::atomic<uint64_t> m_writes_done{};
+#endif // UT_LIST_SNAPSHOT_EPOCH
+};
+
+/** Mapping options of List::create_mapped(), see ut/mapped.h. */
+enum class Map_flags : unsigned;
+
+template <typename T, auto N, typename Backoff, typename Stats = No_stats, typename Reclaim = No_reclaim>
+struct Mapped_list;
+
+/** Coroutine of List::async_find(), see ut/async_find.h. */
+template <typename T>
+struct Find_task;
+
+/**
+ * @tparam T       Item type, stored in a caller provided array.
+ * @tparam N       Member function of T returning the embedded node, a
+ *                 ut::Basic_node, its layout sets the link width. Or
+ *                 SIDE_LINKS<Node_type> to keep the nodes in a separate
+ *                 array, see Side_links.
+ * @tparam Backoff Contention policy for the CAS retry loops, it also sets
+ *                 the retry budget (see ut/backoff.h).
+ * @tparam Stats   Counters of CAS failures, retries and give ups, see
+ *                 stats(). No_stats records nothing and costs nothing,
+ *                 Sharded_stats counts per thread.
+ * @tparam Reclaim When a removed slot may be reused. No_reclaim leaves it
+ *                 to the caller, Epoch_reclaim (ut/epoch.h) defers it
+ *                 until no reader of the list can hold the slot.
+ */
+template <typename T, auto N, typename Backoff = No_backoff<>, typename Stats = No_stats, typename Reclaim = No_reclaim>
 struct List {
-  using iterator = List_iterator<T, N, false>;
-  using const_iterator = List_iterator<T, N, true>;
+  using iterator = List_iterator<T, N, false, Backoff, Stats, Reclaim>;
+  using const_iterator = List_iterator<T, N, true, Backoff, Stats, Reclaim>;
   using reverse_iterator = std::reverse_iterator<iterator>;
   using const_reverse_iterator = std::reverse_iterator<const_iterator>;
 
   using value_type = T;
-  using node_type = std::remove_reference_t<typename std::invoke_result_t<decltype(N), T>>;
+  using slot_map = Slot_map<T, N>;
+  using node_type = typename slot_map::node_type;
+  using layout_type = typename node_type::layout_type;
   using node_pointer = node_type*;
   using item_type = T;
   using item_pointer = item_type*;
   using item_reference = item_type&;
+  using backoff_type = Backoff;
+  using stats_type = Stats;
+  using reclaim_type = Reclaim;
+  using state_type = List_state<layout_type>;
+
+  /**
+   * A run of nodes that is not reachable from any list and is owned by
+   * the caller, returned by take_all(). The chain is linked by next links
+   * and NULL terminated, walking it needs no atomic RMWs. Its nodes are
+   * detached until they're pushed onto a list again or spliced: a remove(),
+   * an insert next to them or a move of them fails, see take_all(). The
+   * iterator reads the next link before yielding an item, so the loop body
+   * may push the item onto another list.
+   */
+  struct Chain {
+    struct iterator {
+      using value_type = T;
+      using difference_type = std::ptrdiff_t;
+      using pointer = item_pointer;
+      using reference = item_reference;
+      using iterator_category = std::forward_iterator_tag;
+
+      iterator() = default;
+
+      iterator(const slot_map& slots, node_pointer current) noexcept
+        : m_slots(slots),
+          m_current(current) {
+        load_next();
+      }
+
+      [[nodiscard]] reference operator*() const noexcept {
+        return *m_slots.item(*m_current);
+      }
+
+      [[nodiscard]] pointer operator->() const noexcept {
+        return m_slots.item(*m_current);
+      }
+
+      iterator& operator++() noexcept {
+        m_current = m_next == node_type::NULL_PTR ? nullptr : m_slots.node(m_next);
+        load_next();
+        return *this;
+      }
+
+      iterator operator++(int) noexcept {
+        auto tmp = *this;
+        ++(*this);
+        return tmp;
+      }
+
+      [[nodiscard]] bool operator==(const iterator& rhs) const noexcept {
+        return m_current == rhs.m_current;
+      }
 
-  List(item_pointer base, item_pointer end) noexcept : m_bounds(base, end) {
+      void load_next() noexcept {
+        if (m_current != nullptr) [[likely]] {
+          m_next = unpack_links<layout_type>(m_current->m_links.load(std::memory_order_relaxed)).next;
+        }
+      }
+
+      slot_map m_slots{};
+      node_pointer m_current{};
+      typename node_type::Link_type m_next{node_type::NULL_PTR};
+    };
+
+    [[nodiscard]] iterator begin() const noexcept {
+      return iterator(m_slots, m_first);
+    }
+
+    [[nodiscard]] iterator end() const noexcept {
+      return iterator(m_slots, nullptr);
+    }
+
+    [[nodiscard]] bool empty() const noexcept {
+      return m_size == 0;
+    }
+
+    [[nodiscard]] size_t size() const noexcept {
+      return m_size;
+    }
+
+    slot_map m_slots{};
+    node_pointer m_first{};
+    node_pointer m_last{};
+    size_t m_size{};
+  };
+
+  List(item_pointer base, item_pointer end, Reclaim reclaim = {}) noexcept requires (!slot_map::SIDE_LINKS)
+    : m_slots{base},
+      m_capacity(static_cast<size_t>(end - base)),
+      m_reclaim(std::move(reclaim)) {
     assert(base <= end);
     assert(base != nullptr);
+    assert(static_cast<uint64_t>(end - base) <= layout_type::MAX_CAPACITY);
+  }
+
+  /** Side links list, nodes[i] is the node of base[i], see Side_links. */
+  List(item_pointer base, item_pointer end, node_pointer nodes, Reclaim reclaim = {}) noexcept requires (slot_map::SIDE_LINKS)
+    : m_slots{base, nodes},
+      m_capacity(static_cast<size_t>(end - base)),
+      m_reclaim(std::move(reclaim)) {
+    assert(base <= end);
+    assert(base != nullptr && nodes != nullptr);
+    assert(static_cast<uint64_t>(end - base) <= layout_type::MAX_CAPACITY);
+  }
+
+  /**
+   * List over an external state, which must outlive it. The state is used
+   * as is, several List objects over the same state and array are views of
+   * the same list, see List_state.
+   */
+  List(item_pointer base, item_pointer end, state_type& state, Reclaim reclaim = {}) noexcept requires (!slot_map::SIDE_LINKS)
+    : List(base, end, std::move(reclaim)) {
+    m_state = &state;
+  }
+
+  /** @see List(base, end, state) */
+  List(item_pointer base, item_pointer end, node_pointer nodes, state_type& state, Reclaim reclaim = {}) noexcept requires (slot_map::SIDE_LINKS)
+    : List(base, end, nodes, std::move(reclaim)) {
+    m_state = &state;
   }
 
-  [[nodiscard]] static item_pointer to_item(const item_pointer base, const node_type& node) noexcept {
-    auto ptr = reinterpret_cast<const std::byte*>(&node);
-    const auto offset{ptr - reinterpret_cast<const std::byte*>(base)};
-    return &const_cast<item_pointer>(base)[offset / sizeof(T)];
+  /**
+   * Create a list that owns its backing array of capacity items, mapped
+   * with huge pages and prefaulted as flags ask. Include ut/mapped.h to
+   * use it.
+   *
+   * @throws std::bad_alloc if the array can't be mapped.
+   */
+  [[nodiscard]] static std::unique_ptr<Mapped_list<T, N, Backoff, Stats, Reclaim>> create_mapped(size_t capacity, Map_flags flags);
+
+  [[nodiscard]] static item_pointer to_item(const item_pointer base, const node_type& node) noexcept
+    requires (!slot_map::SIDE_LINKS) {
+    return &const_cast<item_pointer>(base)[slot_index<T, N>(base, &node)];
   }
 
   /* Utility methods */
-  [[nodiscard]] static node_pointer to_node(const item_pointer base, typename node_type::Link_type link) noexcept {
+  [[nodiscard]] static node_pointer to_node(const item_pointer base, typename node_type::Link_type link) noexcept
+    requires (!slot_map::SIDE_LINKS) {
     if (link == node_type::NULL_PTR || link == node_type::DELETING_MARK) [[unlikely]] {
       return nullptr;
     } else [[likely]] {
@@ -308,501 +1148,718 @@ struct List {
     if (link == node_type::NULL_PTR || link == node_type::DELETING_MARK) [[unlikely]] {
       return nullptr;
     } else [[likely]] {
-      return to_node(const_cast<item_pointer>(m_bounds.first), link);
+      return m_slots.node(link);
     }
   }
 
+  [[nodiscard]] node_pointer to_node(const item_type& item) const noexcept {
+    return &m_slots.node(item);
+  }
+
   [[nodiscard]] typename node_type::Link_type to_link(const node_type& node) const noexcept {
-    auto ptr = reinterpret_cast<const std::byte*>(&node);
-    return ((ptr - reinterpret_cast<const std::byte*>(m_bounds.first)) / sizeof(T));
+    return m_slots.link(node);
   }
   [[nodiscard]] item_pointer to_item(const node_type& node) const noexcept {
-    return to_item(const_cast<item_pointer>(m_bounds.first), node);
+    return m_slots.item(node);
   }
 
   [[nodiscard]] item_pointer to_item(typename node_type::Link_type link) const noexcept {
     assert(link != node_type::NULL_PTR);
-    return &const_cast<item_pointer>(m_bounds.first)[link];
+    return m_slots.item(link);
   }
 
   [[nodiscard]] item_pointer remove(item_reference item) noexcept {
-    uint32_t retries{};
-    auto& node = (item.*N)();
+    return remove(m_slots.node(item), End::ANY);
+  }
 
-    while (retries++ < Node::MAX_RETRIES) [[likely]] {
-      auto node_links = node.m_links.load(std::memory_order_acquire);
+  /**
+   * Move item to the front of the list, the LRU hit path. This is remove()
+   * with the last step replaced by a push_front(): the node is pinned, see
+   * is_claimed(), unlinked from its neighbours and published at the head.
+   * The size is not touched. A walk that is on the node while it's moved
+   * goes on to its old successor.
+   *
+   * The pin is checked against the node's neighbours like any claim, see
+   * neighbours_linked(), a mover that finds a neighbour claimed puts the
+   * links back and retries, as does a remover that finds the mover.
+   * Publishing at the head waits for a head that is being removed, see
+   * link_front().
+   *
+   * @return MOVED, also for an item that is already at the front, which
+   *         is not touched. UNCHANGED if item is not in the list or the
+   *         retry budget for claiming it was exhausted. REMOVED in the
+   *         unlikely case that the budget for publishing it ran out, the
+   *         item is then in no list and only this caller may unindex or
+   *         reuse it, a concurrent remove() did not get it.
+   */
+  [[nodiscard]] Move_result move_to_front(item_reference item) noexcept {
+    return move(m_slots.node(item), *this, true);
+  }
 
-      /* Check if already removed or being deleted */
-      if (node_links == Node::NULL_LINK) [[unlikely]] {
-        return nullptr;  /* Already removed */
-      }
+  /** Mirror image of move_to_front(), for FIFO style reinsertion. */
+  [[nodiscard]] Move_result move_to_back(item_reference item) noexcept {
+    return move(m_slots.node(item), *this, false);
+  }
 
-      auto link_data = unpack_links(node_links);
+  /**
+   * Move item from this list to the front of to, which must be built over
+   * the same backing array. The node goes from claimed in this list to
+   * linked in to without passing through a state in which it's free or
+   * in neither list, the sizes are adjusted when it's unlinked and when
+   * it's published.
+   *
+   * @return See move_to_front(), REMOVED leaves the item in neither
+   *         list.
+   */
+  [[nodiscard]] Move_result move_to_front(item_reference item, List& to) noexcept {
+    assert(to.m_slots == m_slots);
+    return move(m_slots.node(item), to, true);
+  }
 
-      /* Check if already being deleted by another thread */
-      if (link_data.is_deleting()) [[unlikely]] {
-        return nullptr;  /* Another thread is deleting this */
-      }
+  /** move_to_front() to another list, appending to its back. */
+  [[nodiscard]] Move_result move_to_back(item_reference item, List& to) noexcept {
+    assert(to.m_slots == m_slots);
+    return move(m_slots.node(item), to, false);
+  }
 
-      /* Save original values before any modifications */
-      auto original_prev = link_data.prev;
-      auto original_next = link_data.next;
-      auto prev_node = to_node(original_prev);
-      auto next_node = to_node(original_next);
-      auto node_link = to_link(node);
+  [[nodiscard]] bool push_front(item_reference item) noexcept {
+    auto& node = m_slots.node(item);
 
-      /* Step 1: Mark node as "deleting" - this is the commit point */
-      /* We encode the original_next in the prev field since we need it later */
-      /* Use DELETING_MARK as next to indicate deletion, keep prev as-is */
-      uint64_t deleting_links = pack_links(Node::DELETING_MARK, original_prev,
-                                           (link_data.next_version + 1) & Node::VERSION_MASK,
-                                           link_data.prev_version);
+    node.m_links.store(pack_links<layout_type>(node_type::NULL_PTR, node_type::NULL_PTR, 0, 0), std::memory_order_relaxed);
 
-      if (!node.m_links.compare_exchange_strong(node_links, deleting_links, std::memory_order_acq_rel)) [[unlikely]] {
-        continue;  /* Node was modified, retry */
-      }
+    if (!link_front(node, node, 1)) [[unlikely]] {
+      node.invalidate();
+      return false;
+    }
+    return true;
+  }
 
-      /* Node is now marked as deleting - we own this deletion */
-      /* Decrement size immediately since deletion is committed */
-      m_size.fetch_sub(1, std::memory_order_relaxed);
+  /**
+   * push_front() that only succeeds if the list's head is still head, a
+   * nullptr head means the list must be empty. The front counterpart of
+   * insert_between().
+   */
+  [[nodiscard]] bool push_front_if(item_pointer head, item_reference item) noexcept {
+    auto& node = m_slots.node(item);
+    const auto head_link = head == nullptr ? node_type::NULL_PTR : to_link(m_slots.node(*head));
 
-      /* Step 2: Update head if this was the head */
-      if (original_prev == Node::NULL_PTR) {
-        typename node_type::Link_type expected_head = node_link;
-        while (!m_head.compare_exchange_weak(expected_head, original_next, std::memory_order_acq_rel)) {
-          if (expected_head != node_link) break;  /* Head already updated */
-        }
-      }
+    node.m_links.store(pack_links<layout_type>(node_type::NULL_PTR, node_type::NULL_PTR, 0, 0), std::memory_order_relaxed);
 
-      /* Step 3: Update tail if this was the tail */
-      if (original_next == Node::NULL_PTR) {
-        typename node_type::Link_type expected_tail = node_link;
-        while (!m_tail.compare_exchange_weak(expected_tail, original_prev, std::memory_order_acq_rel)) {
-          if (expected_tail != node_link) break;  /* Tail already updated */
-        }
-      }
+    if (!link_front(node, node, 1, head_link)) [[unlikely]] {
+      node.invalidate();
+      return false;
+    }
+    return true;
+  }
 
-      /* Step 4: Update prev_node->next to skip this node */
-      if (prev_node != nullptr) [[likely]] {
-        uint32_t prev_retries{};
-        uint64_t prev_links;
-        Link_pack prev_link_data;
+  [[nodiscard]] bool push_back(item_reference item) noexcept {
+    auto& node = m_slots.node(item);
 
-        do {
-          if (prev_retries++ >= Node::MAX_RETRIES) [[unlikely]] {
-            break;  /* Give up but continue - deletion is committed */
-          }
+    node.m_links.store(pack_links<layout_type>(node_type::NULL_PTR, node_type::NULL_PTR, 0, 0), std::memory_order_relaxed);
 
-          prev_link_data = unpack_links(prev_links = prev_node->m_links.load(std::memory_order_acquire));
+    if (!link_back(node, node, 1)) [[unlikely]] {
+      node.invalidate();
+      return false;
+    }
+    return true;
+  }
 
-          if (prev_links == Node::NULL_LINK || prev_link_data.is_deleting()) [[unlikely]] {
-            break;  /* prev_node also being deleted */
-          }
+  /**
+   * Append the items in [first, last) in order. The chain is linked
+   * privately with relaxed stores and published with a single tail CAS,
+   * one fix-up of the old tail and one size update for the whole batch.
+   *
+   * The range is traversed twice on failure, *first must yield either an
+   * item reference or an item pointer.
+   *
+   * @return false if the batch could not be published, the items are then
+   *         not in the list and their nodes are invalidated.
+   */
+  template <typename Iterator>
+  [[nodiscard]] bool push_back_batch(Iterator first, Iterator last) noexcept {
+    const auto chain = link_chain(first, last);
+
+    if (chain.m_size == 0) [[unlikely]] {
+      return true;
+    } else if (!link_back(*chain.m_first, *chain.m_last, chain.m_size)) [[unlikely]] {
+      invalidate(first, last);
+      return false;
+    }
+    return true;
+  }
 
-          /* Check if already updated */
-          if (prev_link_data.next != node_link) [[unlikely]] {
-            break;  /* Already updated or something else happened */
-          }
+  /** Prepend the items in [first, last), the list then starts with *first.
+   * Same publication protocol and failure semantics as push_back_batch. */
+  template <typename Iterator>
+  [[nodiscard]] bool push_front_batch(Iterator first, Iterator last) noexcept {
+    const auto chain = link_chain(first, last);
 
-        } while (!prev_node->m_links.compare_exchange_weak(prev_links,
-                  pack_links(original_next, prev_link_data.prev,
-                            (prev_link_data.next_version + 1) & Node::VERSION_MASK, prev_link_data.prev_version),
-                  std::memory_order_acq_rel));
-      }
+    if (chain.m_size == 0) [[unlikely]] {
+      return true;
+    } else if (!link_front(*chain.m_first, *chain.m_last, chain.m_size)) [[unlikely]] {
+      invalidate(first, last);
+      return false;
+    }
+    return true;
+  }
 
-      /* Step 5: Update next_node->prev to skip this node */
-      if (next_node != nullptr) [[likely]] {
-        uint32_t next_retries{};
-        uint64_t next_links;
-        Link_pack next_link_data;
+  /**
+   * Move all elements of other to the back of this list, in order, without
+   * relinking them individually: the chain is detached from other with
+   * take_all() and published here with a single tail CAS. Both lists must be
+   * built over the same backing array. A remove() or an insert next to
+   * one of other's elements that runs meanwhile may fail, until splice()
+   * returns, like one that runs while take_all() drains them.
+   *
+   * @return false if the chain could not be published here, it is then put
+   *         back into other. If that fails too the nodes are invalidated.
+   */
+  [[nodiscard]] bool splice(List& other) noexcept {
+    assert(other.m_slots == m_slots);
 
-        do {
-          if (next_retries++ >= Node::MAX_RETRIES) [[unlikely]] {
-            break;  /* Give up but continue - deletion is committed */
-          }
+    if (&other == this) [[unlikely]] {
+      return true;
+    }
 
-          next_link_data = unpack_links(next_links = next_node->m_links.load(std::memory_order_acquire));
+    auto chain = other.take_all();
 
-          if (next_links == Node::NULL_LINK || next_link_data.is_deleting()) [[unlikely]] {
-            break;  /* next_node also being deleted */
-          }
+    if (chain.empty()) {
+      return true;
+    }
 
-          /* Check if already updated */
-          if (next_link_data.prev != node_link) [[unlikely]] {
-            break;  /* Already updated or something else happened */
-          }
+    /* link_back() sets the first node's links, the others stay detached
+     * until they're attached */
+    const auto second = node_type::next_link(chain.m_first->m_links.load(std::memory_order_relaxed));
+
+    if (link_back(*chain.m_first, *chain.m_last, chain.m_size)) [[likely]] {
+      attach(to_link(*chain.m_first), second);
+      return true;
+    } else if (other.link_back(*chain.m_first, *chain.m_last, chain.m_size)) {
+      attach(to_link(*chain.m_first), second);
+    } else {
+      invalidate(chain.begin(), chain.end());
+    }
+    return false;
+  }
 
-        } while (!next_node->m_links.compare_exchange_weak(next_links,
-                  pack_links(next_link_data.next, original_prev,
-                            next_link_data.next_version, (next_link_data.prev_version + 1) & Node::VERSION_MASK),
-                  std::memory_order_acq_rel));
-      }
+  /**
+   * Remove up to n elements from the front, in list order, and store them
+   * in out[0..n). The leading run is detached without running the
+   * remove() protocol per element, but it still costs one CAS per
+   * element: each node of the run is claimed as in remove() step 1, that
+   * is what keeps a concurrent remove() or insert off it. The head CAS,
+   * the successor's prev fix-up and the size update are then done once for
+   * the entire run, and each node is finalized with a plain store. A
+   * drain of k elements costs k + 2 CASes and one size update, pop_front()
+   * k times costs about 4k RMWs. The removed nodes are invalidated.
+   *
+   * Same concurrency guarantees as pop_front(): a concurrent remove() or
+   * insert next to a node of the run either completes before the node is
+   * claimed or fails. The run ends early at a node that another thread is
+   * removing or inserting next to.
+   *
+   * @return the number of elements stored in out.
+   */
+  [[nodiscard]] size_t pop_front_n(item_pointer* out, size_t n) noexcept {
+    const auto run = detach_front(n);
+    auto node = run.m_last;
 
-      /* Step 6: Finalize - mark node as fully removed */
-      node.m_links.store(Node::NULL_LINK, std::memory_order_release);
+    /* Finalize back to front along the prev links the claims kept */
+    for (auto count = run.m_count; count > 0; --count) {
+      const auto prev = unpack_links<layout_type>(node->m_links.load(std::memory_order_relaxed)).prev;
 
-      return to_item(node);
+      out[count - 1] = to_item(*node);
+      node->m_links.store(node_type::NULL_LINK, std::memory_order_release);
+
+      if (count > 1) {
+        node = to_node(prev);
+      }
     }
 
-    /* Failed to remove after max retries */
-    return nullptr;
+    return run.m_count;
   }
 
-  [[nodiscard]] bool push_front(item_reference item) noexcept {
-    uint32_t retries{};
-    auto& node = (item.*N)();
+  /**
+   * Detach all elements, see pop_front_n(). Elements added concurrently
+   * may or may not be included, the chain ends early at a node that
+   * another thread is removing or inserting next to.
+   *
+   * Same concurrency guarantees as pop_front_n(). The chain's nodes are
+   * left detached, see detached_links(), with the chain's next links: a
+   * remove(), an insert next to them or a move of them fails at once
+   * until they're in a list again, readers that were on them when they
+   * were drained reach the end of the chain.
+   */
+  [[nodiscard]] Chain take_all() noexcept {
+    const auto run = detach_front(std::numeric_limits<size_t>::max());
+    Chain chain{m_slots};
 
-    while (retries++ < Node::MAX_RETRIES) [[likely]] {
-      typename node_type::Link_type old_head_link = m_head.load(std::memory_order_acquire);
-      auto new_node_link = to_link(node);
+    if (run.m_count == 0) {
+      return chain;
+    }
 
-      node.m_links.store(pack_links(old_head_link, Node::NULL_PTR, 0, 0), std::memory_order_relaxed);
+    /* Terminate the chain and rebuild the next links back to front along
+     * the prev links the claims kept, the head's prev is NULL */
+    auto next = node_type::NULL_PTR;
+    auto node = run.m_last;
 
-      if (m_head.compare_exchange_strong(old_head_link, new_node_link, std::memory_order_acq_rel)) [[likely]] {
+    for (auto count = run.m_count; count > 0; --count) {
+      const auto prev = unpack_links<layout_type>(node->m_links.load(std::memory_order_relaxed)).prev;
 
-        if (old_head_link != Node::NULL_PTR) [[likely]] {
-          uint32_t head_retries{};
-          uint64_t old_head_links;
-          auto old_head = to_node(old_head_link);
-          Link_pack old_head_data;
+      node->m_links.store(detached_links(next), std::memory_order_release);
+      next = to_link(*node);
 
-          do {
-            if (head_retries++ >= Node::MAX_RETRIES) {
-              /* Failed to update old head, try to restore state */
-              m_head.store(old_head_link, std::memory_order_release);
-              node.invalidate();
-              return false;
-            }
+      if (count > 1) {
+        node = to_node(prev);
+      }
+    }
 
-            old_head_data = unpack_links(old_head_links = old_head->m_links.load(std::memory_order_acquire));
+    chain.m_first = node;
+    chain.m_last = run.m_last;
+    chain.m_size = run.m_count;
 
-            if (old_head_links == Node::NULL_LINK) [[unlikely]] {
-              /* Old head was removed, try to restore state */
-              m_head.store(old_head_link, std::memory_order_release);
-              node.invalidate();
-              return false;
-            }
+    return chain;
+  }
 
-          } while (!old_head->m_links.compare_exchange_weak(old_head_links,
-                    pack_links(old_head_data.next, new_node_link,
-                              old_head_data.next_version, (old_head_data.prev_version + 1) & Node::VERSION_MASK),
-                    std::memory_order_acq_rel));
-        }
+  /**
+   * Remove first, last and the elements between them, in list order.
+   *
+   * The range is removed as runs of adjacent nodes: each node of a run is
+   * claimed with the DELETING_MARK CAS of remove(), then the run is
+   * unlinked with one predecessor and one successor fix-up and a single
+   * size update, instead of both fix-ups per element. A claim that loses
+   * to a concurrent update ends the run, the next run starts at the node
+   * that lost.
+   *
+   * last must not precede first. No other thread may remove elements of
+   * the range meanwhile, elements inserted inside the range before their
+   * predecessor is claimed are removed with it. The removed elements are
+   * invalidated.
+   *
+   * @return the number of elements removed, less than the length of the
+   *         range if a claim ran out of retries.
+   */
+  size_t erase_range(item_reference first, item_reference last) noexcept {
+    size_t removed{};
+    const auto& stop = m_slots.node(last);
+    auto node = &m_slots.node(first);
 
-        typename node_type::Link_type expected_tail = Node::NULL_PTR;
-        m_tail.compare_exchange_strong(expected_tail, new_node_link, std::memory_order_acq_rel);
+    for (;;) {
+      const auto run = remove_run(*node, &stop, [](const node_type&) { return true; });
 
-        m_size.fetch_add(1, std::memory_order_relaxed);
-        return true;
+      removed += run.m_count;
+
+      if (run.m_count == 0 || run.m_last == &stop || run.m_next == node_type::NULL_PTR) {
+        return removed;
       }
-    }
 
-    node.invalidate();
-    return false;
+      node = to_node(run.m_next);
+    }
   }
 
-  [[nodiscard]] bool push_back(item_reference item) noexcept {
+  /**
+   * Remove the elements predicate(item) accepts, in one pass over the
+   * list. Adjacent matches are removed as one run, see erase_range().
+   *
+   * The walk has the semantics of for_each(): matches that are in the list
+   * for the whole pass are removed unless the walk stops early, matches
+   * inserted or removed by other threads meanwhile may or may not be.
+   * predicate may be called more than once for an element whose claim lost
+   * a race.
+   *
+   * @return the number of elements removed.
+   */
+  template <typename Predicate>
+  size_t remove_if(Predicate&& predicate) noexcept(noexcept(predicate(std::declval<item_reference>()))) {
+    [[maybe_unused]] const auto guard = m_reclaim.guard();
     uint32_t retries{};
-    auto& node = (item.*N)();
-
-    while (retries++ < Node::MAX_RETRIES) [[likely]] {
-      typename node_type::Link_type old_tail_link = m_tail.load(std::memory_order_acquire);
-      auto new_node_link = to_link(node);
+    Backoff backoff{};
+    size_t removed{};
+    node_pointer prev{};
+    auto link = m_state->m_head.load(std::memory_order_acquire);
+
+    const auto matches = [&](const node_type& node) {
+      return predicate(*to_item(node));
+    };
+
+    while (link != node_type::NULL_PTR) [[likely]] {
+      auto node = to_node(link);
+      const auto links = node->m_links.load(std::memory_order_acquire);
+
+      if (links != node_type::NULL_LINK && node_type::next_link(links) != node_type::DELETING_MARK) [[likely]] {
+        if (!matches(*node)) [[likely]] {
+          retries = 0;
+          prev = node;
+          link = node_type::next_link(links);
+          continue;
+        }
 
-      node.m_links.store(pack_links(Node::NULL_PTR, old_tail_link, 0, 0), std::memory_order_relaxed);
+        const auto run = remove_run(*node, nullptr, matches);
 
-      if (m_tail.compare_exchange_strong(old_tail_link, new_node_link, std::memory_order_acq_rel)) [[likely]] {
+        if (run.m_count > 0) [[likely]] {
+          removed += run.m_count;
+          retries = 0;
+          link = run.m_next;
+          continue;
+        }
+      }
 
-        if (old_tail_link != Node::NULL_PTR) [[likely]] {
-          uint64_t old_tail_links;
-          uint32_t tail_retries{};
-          auto old_tail = to_node(old_tail_link);
-          Link_pack old_tail_data;
+      /* Removed by another thread, as in walk() */
+      m_stats.add(List_stat::FIND_RESTARTS);
 
-          do {
-            if (tail_retries++ >= Node::MAX_RETRIES) {
-              m_tail.store(old_tail_link, std::memory_order_release);
-              node.invalidate();
-              return false;
-            }
+      if (++retries >= Backoff::MAX_RETRIES) [[unlikely]] {
+        return removed;
+      }
 
-            old_tail_data = unpack_links(old_tail_links = old_tail->m_links.load(std::memory_order_acquire));
+      backoff.pause();
 
-            if (old_tail_links == Node::NULL_LINK) [[unlikely]] {
-              /* Old tail was removed, try to restore state */
-              m_tail.store(old_tail_link, std::memory_order_release);
-              node.invalidate();
-              return false;
-            }
+      if (prev == nullptr) {
+        link = m_state->m_head.load(std::memory_order_acquire);
+      } else {
+        const auto prev_links = prev->m_links.load(std::memory_order_acquire);
 
-          } while (!old_tail->m_links.compare_exchange_weak(old_tail_links,
-                    pack_links(new_node_link, old_tail_data.prev,
-                              (old_tail_data.next_version + 1) & Node::VERSION_MASK, old_tail_data.prev_version),
-                    std::memory_order_acq_rel));
+        if (prev_links == node_type::NULL_LINK || node_type::next_link(prev_links) == node_type::DELETING_MARK) [[unlikely]] {
+          return removed;
         }
-
-        typename node_type::Link_type expected_head = Node::NULL_PTR;
-        m_head.compare_exchange_strong(expected_head, new_node_link, std::memory_order_acq_rel);
-
-        m_size.fetch_add(1, std::memory_order_relaxed);
-        return true;
+        link = node_type::next_link(prev_links);
       }
     }
 
-    node.invalidate();
-    return false;
+    return removed;
   }
 
   [[nodiscard]] bool insert_after(item_reference item, item_reference new_item) noexcept {
-    auto& node = (item.*N)();
-
-    if (node.is_null()) {
-      return false;
-    }
-
-    auto& new_node = (new_item.*N)();
-    uint32_t retries{};
+    return insert(m_slots.node(item), m_slots.node(new_item), std::nullopt, false);
+  }
 
-    while (retries++ < Node::MAX_RETRIES) [[likely]] {
-      uint64_t node_links = node.m_links.load(std::memory_order_acquire);
-      auto link_data = unpack_links(node_links);
-      auto new_node_link = to_link(new_node);
+  /**
+   * Insert new_item between item and next, a nullptr next means item is
+   * the tail. Unlike insert_after() this fails if item's successor is no
+   * longer next, for callers that chose the position by looking at both
+   * neighbours, e.g. to keep the list ordered.
+   *
+   * @return false if item was removed, its successor changed or the retry
+   *         budget was exhausted. new_item is not in the list then.
+   */
+  [[nodiscard]] bool insert_between(item_reference item, item_pointer next, item_reference new_item) noexcept {
+    const auto next_link = next == nullptr ? node_type::NULL_PTR : to_link(m_slots.node(*next));
 
-      if (node_links == Node::NULL_LINK || link_data.is_deleting()) [[unlikely]] {
-        /* Node was removed or is being deleted */
-        new_node.invalidate();
-        return false;
-      }
+    return insert(m_slots.node(item), m_slots.node(new_item), next_link, false);
+  }
 
-      /* Set new node's links */
-      new_node.m_links.store(pack_links(link_data.next, to_link(node), 0, 0), std::memory_order_relaxed);
-
-      if (node.m_links.compare_exchange_strong(node_links,
-            pack_links(new_node_link, link_data.prev,
-                      (link_data.next_version + 1) & Node::VERSION_MASK, link_data.prev_version),
-            std::memory_order_acq_rel)) [[likely]] {
-
-        /* Update next node's prev link if it exists */
-        bool next_updated = true;
-        if (link_data.next != Node::NULL_PTR) {
-          uint64_t next_links;
-          uint32_t next_retries{};
-          auto next_node = to_node(link_data.next);
-          Link_pack next_link_data;
-
-          do {
-            if (next_retries++ >= Node::MAX_RETRIES) {
-              /* Restore original node links */
-              node.m_links.store(node_links, std::memory_order_release);
-              new_node.invalidate();
-              return false;
-            }
+  [[nodiscard]] bool insert_before(item_reference item, item_reference new_item) noexcept {
+    return insert(m_slots.node(item), m_slots.node(new_item), std::nullopt, true);
+  }
 
-            next_link_data = unpack_links(next_links = next_node->m_links.load(std::memory_order_acquire));
+  /** Find the first element matching predicate. Only restarts count
+   * against the retry budget, not hops. */
+  template <typename Predicate>
+  [[nodiscard]] item_pointer find(Predicate predicate) noexcept {
+    [[maybe_unused]] const auto guard = m_reclaim.guard();
+    uint32_t retries{};
+    Backoff backoff{};
+    typename node_type::Link_type current = m_state->m_head.load(std::memory_order_acquire);
 
-            if (next_links == Node::NULL_LINK || next_link_data.is_deleting()) [[unlikely]] {
-              /* Next node was removed or being deleted, restore and retry outer loop */
-              node.m_links.store(node_links, std::memory_order_release);
-              next_updated = false;
-              break;
-            }
+    while (current != node_type::NULL_PTR && current != node_type::DELETING_MARK) [[likely]] {
+      auto node = to_node(current);
+      auto item = to_item(*node);
 
-            if (next_link_data.prev != to_link(node)) [[unlikely]] {
-              /* Next node was modified, restore and retry outer loop */
-              node.m_links.store(node_links, std::memory_order_release);
-              next_updated = false;
-              break;
-            }
+      auto links = node->m_links.load(std::memory_order_acquire);
+      auto link_data = unpack_links<layout_type>(links);
 
-          } while (!next_node->m_links.compare_exchange_weak(next_links,
-                    pack_links(next_link_data.next, new_node_link,
-                              next_link_data.next_version, (next_link_data.prev_version + 1) & Node::VERSION_MASK),
-                    std::memory_order_acq_rel));
+      if (links == node_type::NULL_LINK || link_data.is_deleting()) [[unlikely]] {
+        m_stats.add(List_stat::FIND_RESTARTS);
 
-          if (!next_updated) {
-            continue;  /* Retry outer loop */
-          }
-        } else {
-          /* Update tail if necessary */
-          auto expected_tail = to_link(node);
-          m_tail.compare_exchange_strong(expected_tail, new_node_link, std::memory_order_acq_rel);
+        if (++retries >= Backoff::MAX_RETRIES) [[unlikely]] {
+          m_stats.add(List_stat::RETRY_EXHAUSTED);
+          return nullptr;
         }
+        /* Node was removed or being deleted, try to recover from head */
+        backoff.pause();
+        current = m_state->m_head.load(std::memory_order_acquire);
+        continue;
+      }
 
-        m_size.fetch_add(1, std::memory_order_relaxed);
-        return true;
+      if (predicate(item)) [[unlikely]] {
+        return item;
       }
+
+      current = link_data.next;
     }
 
-    new_node.invalidate();
-    return false;
+    return nullptr;
   }
 
-  [[nodiscard]] bool insert_before(item_reference item, item_reference new_item) noexcept {
-    uint32_t retries{};
-    auto& node = (item.*N)();
-    auto& new_node = (new_item.*N)();
+  /**
+   * Call f(item) for each element in list order. This is a lighter weight
+   * walk than the iterators: one acquire load per node, no prev link
+   * validation and no exceptions.
+   *
+   * Weak snapshot semantics:
+   *  - No element is visited twice, and elements are visited in list order.
+   *  - Elements that are in the list for the whole walk are visited, unless
+   *    the walk stops early.
+   *  - Elements inserted or removed during the walk may or may not be
+   *    visited.
+   *
+   * A node that is being removed is skipped by re-reading the predecessor's
+   * next link until the removal has unlinked it. If the last visited node
+   * is itself removed the walk can't continue without risking duplicates,
+   * it stops early.
+   *
+   * @return true if the walk reached the end of the list, false if it stopped
+   *         early.
+   */
+  template <typename F>
+  bool for_each(F&& f) noexcept(noexcept(f(std::declval<item_reference>()))) {
+    return walk([&f](item_reference item) {
+      f(item);
+      return false;
+    }) == Walk::END;
+  }
 
-    while (retries++ < Node::MAX_RETRIES) [[likely]] {
-      uint64_t node_links = node.m_links.load(std::memory_order_acquire);
-      auto link_data = unpack_links(node_links);
-      auto new_node_link = to_link(new_node);
+  /**
+   * Visit elements in list order until predicate(item) returns true, with
+   * the semantics of for_each().
+   *
+   * @return the element predicate accepted, nullptr if none did or the walk
+   *         stopped early.
+   */
+  template <typename Predicate>
+  [[nodiscard]] item_pointer visit_until(Predicate&& predicate) noexcept(noexcept(predicate(std::declval<item_reference>()))) {
+    item_pointer found{};
 
-      if (node_links == Node::NULL_LINK || link_data.is_deleting()) [[unlikely]] {
-        /* Node was removed or is being deleted */
-        new_node.invalidate();
-        return false;
+    (void) walk([&](item_reference item) {
+      if (predicate(item)) [[unlikely]] {
+        found = &item;
+        return true;
       }
+      return false;
+    });
 
-      /* Set new node's links */
-      new_node.m_links.store(pack_links(to_link(node), link_data.prev, 0, 0), std::memory_order_relaxed);
-
-      if (node.m_links.compare_exchange_strong(node_links,
-            pack_links(link_data.next, new_node_link,
-                      link_data.next_version, (link_data.prev_version + 1) & Node::VERSION_MASK),
-            std::memory_order_acq_rel)) [[likely]] {
-
-        /* Update prev node's next link if it exists */
-        bool prev_updated = true;
-        if (link_data.prev != Node::NULL_PTR) [[likely]] {
-          uint64_t prev_links;
-          uint32_t prev_retries{};
-          auto prev_node = to_node(link_data.prev);
-          Link_pack prev_link_data;
-
-          do {
-            if (prev_retries++ >= Node::MAX_RETRIES) {
-              /* Restore original node links */
-              node.m_links.store(node_links, std::memory_order_release);
-              new_node.invalidate();
-              return false;
-            }
-
-            prev_link_data = unpack_links(prev_links = prev_node->m_links.load(std::memory_order_acquire));
+    return found;
+  }
 
-            if (prev_links == Node::NULL_LINK || prev_link_data.is_deleting()) [[unlikely]] {
-              /* Prev node was removed or being deleted, restore and retry outer loop */
-              node.m_links.store(node_links, std::memory_order_release);
-              prev_updated = false;
-              break;
-            }
+  /**
+   * Visit the live elements in array order instead of list order. For
+   * passes that don't need the order, e.g. statistics or a GC sweep, on
+   * lists too long for the link chase to be cheap: the node array is
+   * streamed front to back and no link is followed.
+   *
+   * A slot is live if its node has links and isn't being removed, that is
+   * all a scan can tell from a node:
+   *  - Nodes of other lists over the same nodes look live too. Use it on
+   *    arrays whose nodes only this list links, or filter in f. The free
+   *    slots of a Fixed_pool over them are not live, see Fixed_pool.
+   *  - Like for_each() it's weakly consistent, elements inserted or
+   *    removed during the scan may or may not be visited. A push whose
+   *    links are set but not yet published may be visited.
+   *
+   * With side links in 64 bit words several nodes are tested per
+   * instruction, with AVX2 or SSE4.1 as the CPU supports at run time.
+   */
+  template <typename F>
+  void for_each_unordered(F&& f) const noexcept(noexcept(f(std::declval<item_reference>()))) {
+    size_t link{};
+
+#if UT_LIST_SIMD_SCAN
+    if constexpr (slot_map::SIDE_LINKS && std::is_same_v<typename node_type::Link_word, uint64_t>) {
+      uint64_t (*live_mask)(const node_type*) noexcept{};
+
+      if (__builtin_cpu_supports("avx2")) {
+        live_mask = live_mask_avx2;
+      } else if (__builtin_cpu_supports("sse4.1")) {
+        live_mask = live_mask_sse41;
+      }
 
-            if (prev_link_data.next != to_link(node)) [[unlikely]] {
-              /* Prev node was modified, restore and retry outer loop */
-              node.m_links.store(node_links, std::memory_order_release);
-              prev_updated = false;
-              break;
-            }
+      for (; live_mask != nullptr && link + SCAN_BLOCK <= m_capacity; link += SCAN_BLOCK) {
+        auto live = live_mask(m_slots.m_nodes + link);
 
-          } while (!prev_node->m_links.compare_exchange_weak(prev_links,
-                    pack_links(new_node_link, prev_link_data.prev,
-                              (prev_link_data.next_version + 1) & Node::VERSION_MASK, prev_link_data.prev_version),
-                    std::memory_order_acq_rel));
+        /* Order the item reads after the relaxed node loads */
+        std::atomic_thread_fence(std::memory_order_acquire);
 
-          if (!prev_updated) {
-            continue;  /* Retry outer loop */
-          }
-        } else {
-          /* Update head if necessary */
-          auto expected_head = to_link(node);
-          m_head.compare_exchange_strong(expected_head, new_node_link, std::memory_order_acq_rel);
+        for (; live != 0; live &= live - 1) {
+          f(*m_slots.item(static_cast<typename node_type::Link_type>(link + static_cast<size_t>(std::countr_zero(live)))));
         }
-
-        m_size.fetch_add(1, std::memory_order_relaxed);
-        return true;
       }
     }
+#endif // UT_LIST_SIMD_SCAN
 
-    new_node.invalidate();
-    return false;
+    for (; link < m_capacity; ++link) {
+      const auto links = m_slots.node(static_cast<typename node_type::Link_type>(link))->m_links.load(std::memory_order_acquire);
+
+      if (links != node_type::NULL_LINK && node_type::next_link(links) != node_type::DELETING_MARK) [[likely]] {
+        f(*m_slots.item(static_cast<typename node_type::Link_type>(link)));
+      }
+    }
   }
 
+  /**
+   * find() as a coroutine that prefetches each node and suspends before
+   * reading it. One thread can run many lookups at once, in the same or
+   * other lists, and overlap their cache misses, see find_interleaved().
+   * Results are the same as find(). The list must outlive the task.
+   * Include ut/async_find.h to use it.
+   */
   template <typename Predicate>
-  [[nodiscard]] item_pointer find(Predicate predicate) noexcept {
+  [[nodiscard]] Find_task<T> async_find(Predicate predicate) noexcept;
+
+  /**
+   * find() for long lists that don't fit in cache. The link chase runs
+   * Distance nodes ahead of the predicate: as soon as a node's next link
+   * is decoded the next node is prefetched, and the item is prefetched
+   * when its node enters the window, so the predicate's payload misses
+   * overlap with the chase. Results are the same as find().
+   *
+   * @tparam Distance Number of nodes between the chase and the predicate.
+   */
+  template <size_t Distance = 4, typename Predicate>
+  [[nodiscard]] item_pointer find_prefetched(Predicate predicate) noexcept {
+    [[maybe_unused]] const auto guard = m_reclaim.guard();
+    static_assert(Distance > 0, "Distance must be at least one node");
+
     uint32_t retries{};
-    typename node_type::Link_type current = m_head.load(std::memory_order_acquire);
+    Backoff backoff{};
+    std::array<node_pointer, Distance> window{};
+
+    for (;;) {
+      size_t first{};
+      size_t count{};
+      bool restart{};
+      auto chase = m_state->m_head.load(std::memory_order_acquire);
+
+      while (!restart) {
+        /* Fill the window */
+        while (count < Distance && chase != node_type::NULL_PTR && chase != node_type::DELETING_MARK) {
+          auto node = to_node(chase);
+          const auto links = node->m_links.load(std::memory_order_acquire);
+          const auto link_data = unpack_links<layout_type>(links);
+
+          if (links == node_type::NULL_LINK || link_data.is_deleting()) [[unlikely]] {
+            m_stats.add(List_stat::FIND_RESTARTS);
+
+            if (++retries >= Backoff::MAX_RETRIES) [[unlikely]] {
+              m_stats.add(List_stat::RETRY_EXHAUSTED);
+              return nullptr;
+            }
+            /* Node was removed or being deleted, recover from head */
+            backoff.pause();
+            restart = true;
+            break;
+          }
 
-    while (current != Node::NULL_PTR && current != Node::DELETING_MARK && retries++ < Node::MAX_RETRIES) [[likely]] {
-      auto node = to_node(current);
-      auto item = to_item(*node);
+          chase = link_data.next;
 
-      auto links = node->m_links.load(std::memory_order_acquire);
-      auto link_data = unpack_links(links);
+          if (chase != node_type::NULL_PTR && chase != node_type::DELETING_MARK) [[likely]] {
+            prefetch(to_node(chase));
+          }
+          prefetch(to_item(*node));
 
-      if (links == Node::NULL_LINK || link_data.is_deleting()) [[unlikely]] {
-        /* Node was removed or being deleted, try to recover from head */
-        current = m_head.load(std::memory_order_acquire);
-        retries++;
-        continue;
-      }
+          window[(first + count++) % Distance] = node;
+        }
 
-      if (predicate(item)) [[unlikely]] {
-        return item;
-      }
+        if (restart) [[unlikely]] {
+          break;
+        } else if (count == 0) {
+          return nullptr;
+        }
 
-      current = link_data.next;
-    }
+        auto item = to_item(*window[first]);
 
-    return nullptr;
+        if (predicate(item)) [[unlikely]] {
+          return item;
+        }
+
+        first = (first + 1) % Distance;
+        --count;
+      }
+    }
   }
 
   [[nodiscard]] item_pointer pop_front() noexcept {
     uint32_t retries{};
-    while (retries++ < Node::MAX_RETRIES) [[likely]] {
-      auto link = m_head.load(std::memory_order_acquire);
-      if (link == Node::NULL_PTR) [[unlikely]] {
+    Backoff backoff{};
+
+    m_stats.add(List_stat::ATTEMPTS);
+
+    while (retries++ < Backoff::MAX_RETRIES) [[likely]] {
+      if (retries > 1) [[unlikely]] {
+        m_stats.add(List_stat::RETRIES);
+        backoff.pause();
+      }
+
+      auto link = m_state->m_head.load(std::memory_order_acquire);
+      if (link == node_type::NULL_PTR) [[unlikely]] {
         return nullptr;
       }
-      if (auto* item = remove(*to_item(link))) [[likely]] {
+      if (auto* item = remove(*to_node(link), End::FRONT)) [[likely]] {
         return item;
       }
     }
+
+    m_stats.add(List_stat::RETRY_EXHAUSTED);
     return nullptr;
   }
 
   [[nodiscard]] item_pointer pop_back() noexcept {
     uint32_t retries{};
-    while (retries++ < Node::MAX_RETRIES) [[likely]] {
-      auto link = m_tail.load(std::memory_order_acquire);
-      if (link == Node::NULL_PTR) [[unlikely]] {
+    Backoff backoff{};
+
+    m_stats.add(List_stat::ATTEMPTS);
+
+    while (retries++ < Backoff::MAX_RETRIES) [[likely]] {
+      if (retries > 1) [[unlikely]] {
+        m_stats.add(List_stat::RETRIES);
+        backoff.pause();
+      }
+
+      auto link = m_state->m_tail.load(std::memory_order_acquire);
+      if (link == node_type::NULL_PTR) [[unlikely]] {
         return nullptr;
       }
-      if (auto* item = remove(*to_item(link))) [[likely]] {
+      if (auto* item = remove(*to_node(link), End::BACK)) [[likely]] {
         return item;
       }
     }
+
+    m_stats.add(List_stat::RETRY_EXHAUSTED);
     return nullptr;
   }
 
   [[nodiscard]] iterator begin() noexcept {
-    const auto head = m_head.load(std::memory_order_acquire);
+    auto guard = m_reclaim.guard();
+    const auto head = m_state->m_head.load(std::memory_order_acquire);
 
-    if (head != Node::NULL_PTR) [[likely]] {
+    if (head != node_type::NULL_PTR) [[likely]] {
       auto node = to_node(head);
-      return iterator(m_bounds.first, node, nullptr);
+      return iterator(m_slots, node, nullptr, stats_ref(), std::move(guard));
     }
     return end();
   }
 
   [[nodiscard]] const_iterator begin() const noexcept {
-    const auto head = m_head.load(std::memory_order_acquire);
+    auto guard = m_reclaim.guard();
+    const auto head = m_state->m_head.load(std::memory_order_acquire);
 
-    if (head != Node::NULL_PTR) [[likely]] {
+    if (head != node_type::NULL_PTR) [[likely]] {
       auto node = to_node(head);
-      return const_iterator(m_bounds.first, node, nullptr);
+      return const_iterator(m_slots, node, nullptr, stats_ref(), std::move(guard));
     }
     return end();
   }
 
   [[nodiscard]] iterator end() noexcept {
-    const auto tail = m_tail.load(std::memory_order_acquire);
-    auto node = tail != Node::NULL_PTR ? to_node(tail) : nullptr;
-    return iterator(m_bounds.first, nullptr, node);
+    auto guard = m_reclaim.guard();
+    const auto tail = m_state->m_tail.load(std::memory_order_acquire);
+    auto node = tail != node_type::NULL_PTR ? to_node(tail) : nullptr;
+    return iterator(m_slots, nullptr, node, stats_ref(), std::move(guard));
   }
 
   [[nodiscard]] const_iterator end() const noexcept {
-    const auto tail = m_tail.load(std::memory_order_acquire);
-    auto node = tail != Node::NULL_PTR ? to_node(tail) : nullptr;
-    return const_iterator(m_bounds.first, nullptr, node);
+    auto guard = m_reclaim.guard();
+    const auto tail = m_state->m_tail.load(std::memory_order_acquire);
+    auto node = tail != node_type::NULL_PTR ? to_node(tail) : nullptr;
+    return const_iterator(m_slots, nullptr, node, stats_ref(), std::move(guard));
   }
 
   [[nodiscard]] reverse_iterator rbegin() noexcept {
@@ -826,14 +1883,14 @@ struct List {
   [[nodiscard]] bool validate_node_links(const node_type& node) const noexcept {
     auto links = node.m_links.load(std::memory_order_acquire);
 
-    if (links == Node::NULL_LINK) [[likely]] {
+    if (links == node_type::NULL_LINK) [[likely]] {
       return true;  // Removed nodes are valid
     }
 
-    auto link_data = unpack_links(links);
+    auto link_data = unpack_links<layout_type>(links);
 
     /* Check next pointer consistency */
-    if (link_data.next != Node::NULL_PTR) [[likely]] {
+    if (link_data.next != node_type::NULL_PTR) [[likely]] {
       auto next_node = to_node(link_data.next);
 
       if (!next_node || next_node->is_null()) {
@@ -842,11 +1899,11 @@ struct List {
 
       auto next_links = next_node->m_links.load(std::memory_order_acquire);
 
-      if (next_links == Node::NULL_LINK) [[unlikely]] {
+      if (next_links == node_type::NULL_LINK) [[unlikely]] {
         return false;
       }
 
-      auto next_link_data = unpack_links(next_links);
+      auto next_link_data = unpack_links<layout_type>(next_links);
 
       if (next_link_data.prev != to_link(node)) [[unlikely]] {
         return false;
@@ -854,7 +1911,7 @@ struct List {
     }
 
     /* Check prev pointer consistency */
-    if (link_data.prev != Node::NULL_PTR) [[likely]] {
+    if (link_data.prev != node_type::NULL_PTR) [[likely]] {
       auto prev_node = to_node(link_data.prev);
 
       if (!prev_node || prev_node->is_null()) [[unlikely]] {
@@ -863,11 +1920,11 @@ struct List {
 
       auto prev_links = prev_node->m_links.load(std::memory_order_acquire);
 
-      if (prev_links == Node::NULL_LINK) [[unlikely]] {
+      if (prev_links == node_type::NULL_LINK) [[unlikely]] {
         return false;
       }
 
-      auto prev_link_data = unpack_links(prev_links);
+      auto prev_link_data = unpack_links<layout_type>(prev_links);
 
       if (prev_link_data.next != to_link(node)) [[unlikely]] {
         return false;
@@ -878,15 +1935,1655 @@ struct List {
   }
 #endif // UT_DEBUG
 
+  /** Approximate while the list is being modified, see Sharded_counter. */
   [[nodiscard]] size_t size() const noexcept {
-    return m_size.load(std::memory_order_relaxed);
+    return m_state->m_size.load();
+  }
+
+  /**
+   * Store the elements in list order in out[0..capacity), as they were at
+   * a single point in time, without stopping writers.
+   *
+   * The chain is collected twice and accepted if both collects match and
+   * end at the tail, no link changed in between. Each pass fails on a node
+   * that is being removed or a push that isn't fully linked yet. An
+   * element removed and reinserted at the same position between the two
+   * collects is not detected. With UT_LIST_SNAPSHOT_EPOCH a single collect
+   * is validated against the writes in flight instead, which has no such
+   * hole.
+   *
+   * A snapshot needs a window without writes as long as one walk, under a
+   * steady write rate it can run out of retries.
+   *
+   * @return the number of elements stored, the size of the list at the
+   *         snapshot. std::nullopt if the list didn't fit in capacity or
+   *         no collect validated within the retry budget.
+   */
+  [[nodiscard]] std::optional<size_t> snapshot(item_pointer* out, size_t capacity) const noexcept {
+    uint32_t retries{};
+    Backoff backoff{};
+
+    while (retries++ < Backoff::MAX_RETRIES) [[likely]] {
+      if (retries > 1) [[unlikely]] {
+        backoff.pause();
+      }
+
+#if UT_LIST_SNAPSHOT_EPOCH
+      const auto done = m_state->m_writes_done.load(std::memory_order_seq_cst);
+      const auto begun = m_state->m_writes_begun.load(std::memory_order_seq_cst);
+
+      if (begun != done) [[unlikely]] {
+        continue;
+      }
+
+      const auto count = collect(out, capacity, false);
+
+      if (count == COLLECT_OVERFLOW) [[unlikely]] {
+        return std::nullopt;
+      } else if (count != COLLECT_FAILED && m_state->m_writes_begun.load(std::memory_order_seq_cst) == begun) [[likely]] {
+        return count;
+      }
+#else
+      const auto count = collect(out, capacity, false);
+
+      if (count == COLLECT_OVERFLOW) [[unlikely]] {
+        return std::nullopt;
+      } else if (count != COLLECT_FAILED && collect(out, count, true) == count) [[likely]] {
+        return count;
+      }
+#endif // UT_LIST_SNAPSHOT_EPOCH
+    }
+
+    return std::nullopt;
+  }
+
+  /** A guard of the Reclaim policy, for callers whose reads of the list's
+   * elements span several calls, e.g. a lookup followed by a remove(). */
+  [[nodiscard]] typename Reclaim::Guard guard() const noexcept {
+    return m_reclaim.guard();
+  }
+
+  /**
+   * Hand a removed slot to the Reclaim policy, it's reused once no reader
+   * of the list can still hold it. nullptr is ignored, so the result of
+   * remove() or pop_front() can be passed as is.
+   */
+  void retire(item_pointer item) noexcept requires (Reclaim::ENABLED) {
+    m_reclaim.retire(item);
+  }
+
+  /** Snapshot of the counters of the Stats policy, all zero for No_stats.
+   * Exact when no thread is using the list. */
+  [[nodiscard]] List_stats stats() const noexcept {
+    return m_stats.snapshot();
+  }
+
+  void reset_stats() noexcept {
+    m_stats.reset();
+  }
+
+  /**
+   * Rebuild a consistent list from the links that threads or processes
+   * which died in the middle of an operation left behind. No other thread
+   * may use the list, the array has capacity slots.
+   *
+   *  - A node left in DELETING_MARK state has its removal completed. The
+   *    successor is found by its prev link, the node is then invalidated.
+   *  - A node pinned by an insert next to it or by a move stays, see
+   *    is_claimed(). The new node of an insert_before() that is still
+   *    pinned is dropped, so are the nodes of a chain that take_all()
+   *    detached. The new node of an insert_after() is kept if its
+   *    successor, or the tail, already points at it. A moved node that
+   *    isn't linked anywhere goes back in front of the successor it had,
+   *    or at the back if that's gone.
+   *  - The list is the chain of next links from the head. Nodes appended at
+   *    the back whose predecessor's next link wasn't fixed yet are reached
+   *    through the prev links from the tail.
+   *  - Every prev link on the chain is rewritten to match, which completes
+   *    inserts that had published their next link only and drops the pins.
+   *  - Any other node that still has links was being inserted and never
+   *    published, it's rolled back to the invalidated state.
+   *
+   * @return the number of elements in the list.
+   */
+  size_t recover(size_t capacity) {
+    using Link_type = typename node_type::Link_type;
+
+    constexpr auto NULL_PTR = node_type::NULL_PTR;
+    const auto n = static_cast<Link_type>(capacity);
+
+    auto links = [&](Link_type link) {
+      return unpack_links<layout_type>(m_slots.node(link)->m_links.load(std::memory_order_relaxed));
+    };
+
+    auto is_free = [&](Link_type link) { return m_slots.node(link)->is_null(); };
+    auto is_deleting = [&](Link_type link) { return m_slots.node(link)->is_deleting(); };
+    auto is_pinned = [&](Link_type link, typename layout_type::Version_type role) {
+      const auto link_data = links(link);
+      return link_data.is_pinned() && link_data.prev_version == role;
+    };
+    auto is_live = [&](Link_type link) { return !is_free(link) && !is_deleting(link) && !is_pinned(link, PIN_NEW); };
+
+    /* Successor of each deleting node: the node whose prev link points at
+     * it. An insert next to the deleting node that failed leaves a second
+     * such node, its next link points at the real successor. */
+    std::vector<Link_type> successor(capacity, NULL_PTR);
+
+    for (Link_type link = 0; link < n; ++link) {
+      if (is_free(link)) {
+        continue;
+      }
+
+      const auto prev = links(link).prev;
+
+      if (prev < n && is_deleting(prev)) {
+        auto& other = successor[prev];
+
+        if (other == NULL_PTR || links(other).next == link) {
+          other = link;
+        }
+      }
+    }
+
+    /* The new node of an insert_after() whose anchor is still pinned, if
+     * the successor or the tail points at it. */
+    const auto tail = m_state->m_tail.load(std::memory_order_relaxed);
+    std::vector<Link_type> inserted_after(capacity, NULL_PTR);
+
+    for (Link_type link = 0; link < n; ++link) {
+      if (!is_live(link) || is_pinned(link, PIN_HELD)) {
+        continue;
+      }
+
+      const auto link_data = links(link);
+
+      if (link_data.prev < n && is_pinned(link_data.prev, PIN_HELD) && links(link_data.prev).next == link_data.next &&
+          (link_data.next == NULL_PTR ? tail == link : link_data.next < n && links(link_data.next).prev == link)) {
+        inserted_after[link_data.prev] = link;
+      }
+    }
+
+    /* Skip deleting nodes, and pinned new nodes of insert_before(),
+     * bounded in case of a cycle. */
+    auto resolve_next = [&](Link_type link) {
+      for (size_t hops = 0; link < n && hops < capacity && !is_free(link) && !is_live(link); ++hops) {
+        link = is_deleting(link) ? successor[link] : links(link).next;
+      }
+      return link < n && is_live(link) ? link : NULL_PTR;
+    };
+
+    /* A pinned node has no prev link, the walk back ends there. */
+    auto resolve_prev = [&](Link_type link) {
+      for (size_t hops = 0; link < n && hops < capacity && is_deleting(link); ++hops) {
+        link = links(link).prev;
+      }
+      return link < n && is_live(link) ? link : NULL_PTR;
+    };
+
+    std::vector<bool> linked(capacity);
+    std::vector<Link_type> chain;
+
+    for (auto link = resolve_next(m_state->m_head.load(std::memory_order_relaxed));
+         link != NULL_PTR && !linked[link];
+         link = resolve_next(inserted_after[link] != NULL_PTR ? inserted_after[link] : links(link).next)) {
+      linked[link] = true;
+      chain.push_back(link);
+    }
+
+    const auto front = chain.size();
+
+    for (auto link = resolve_prev(m_state->m_tail.load(std::memory_order_relaxed));
+         link != NULL_PTR && !linked[link];
+         link = resolve_prev(links(link).prev)) {
+      linked[link] = true;
+      chain.push_back(link);
+    }
+
+    std::reverse(chain.begin() + static_cast<std::ptrdiff_t>(front), chain.end());
+
+    /* Moved nodes that were unlinked and not published yet, by the
+     * position they go back to */
+    std::vector<size_t> position(capacity, chain.size());
+    std::vector<std::pair<size_t, Link_type>> moved;
+
+    for (size_t i = 0; i < chain.size(); ++i) {
+      position[chain[i]] = i;
+    }
+
+    for (Link_type link = 0; link < n; ++link) {
+      if (!linked[link] && is_pinned(link, PIN_HELD)) {
+        const auto next = links(link).next;
+
+        moved.emplace_back(next < n && linked[next] ? position[next] : chain.size(), link);
+        linked[link] = true;
+      }
+    }
+
+    if (!moved.empty()) [[unlikely]] {
+      std::stable_sort(moved.begin(), moved.end(), [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
+
+      for (auto it = moved.rbegin(); it != moved.rend(); ++it) {
+        chain.insert(chain.begin() + static_cast<std::ptrdiff_t>(it->first), it->second);
+      }
+    }
+
+    for (size_t i = 0; i < chain.size(); ++i) {
+      const auto old = links(chain[i]);
+      const auto next = i + 1 < chain.size() ? chain[i + 1] : NULL_PTR;
+      const auto prev = i > 0 ? chain[i - 1] : NULL_PTR;
+
+      m_slots.node(chain[i])->m_links.store(pack_links<layout_type>(next, prev, old.next_version, old.prev_version),
+                                            std::memory_order_relaxed);
+    }
+
+    /* Completed removals and rolled back inserts */
+    for (Link_type link = 0; link < n; ++link) {
+      if (!linked[link]) {
+        m_slots.node(link)->invalidate();
+      }
+    }
+
+    m_state->m_head.store(chain.empty() ? NULL_PTR : chain.front(), std::memory_order_relaxed);
+    m_state->m_tail.store(chain.empty() ? NULL_PTR : chain.back(), std::memory_order_relaxed);
+    m_state->m_size.store(chain.size());
+    std::atomic_thread_fence(std::memory_order_release);
+
+    return chain.size();
   }
 
 private:
-  std::pair<item_pointer, item_pointer> m_bounds{};
-  std::atomic<typename node_type::Link_type> m_head{node_type::NULL_PTR};
-  std::atomic<typename node_type::Link_type> m_tail{node_type::NULL_PTR};
-  std::atomic<size_t> m_size{0};
+  enum class Walk { END, STOPPED, LOST };
+
+#if UT_LIST_SIMD_SCAN
+  /* for_each_unordered() kernels for side links. Writers may be updating
+   * the nodes during the scan, so each word is read with a relaxed atomic
+   * load, a plain vector load of the array would race with their CASes.
+   * The loads are movs on x86-64, only the tests are vectorized. */
+  static_assert(sizeof(node_type) == sizeof(typename node_type::Link_word));
+
+  /** Nodes tested per kernel call. */
+  static constexpr size_t SCAN_BLOCK = 64;
+
+  [[nodiscard]] static int64_t scan_word(const node_type& node) noexcept {
+    return static_cast<int64_t>(node.m_links.load(std::memory_order_relaxed));
+  }
+
+  /** @return bit i set if nodes[i] of the SCAN_BLOCK at nodes is live. */
+  [[gnu::target("avx2")]] static uint64_t live_mask_avx2(const node_type* nodes) noexcept {
+    const auto null_link = _mm256_set1_epi64x(-1);
+    const auto link_mask = _mm256_set1_epi64x(static_cast<int64_t>(layout_type::LINK_MASK));
+    const auto deleting = _mm256_set1_epi64x(static_cast<int64_t>(node_type::DELETING_MARK));
+
+    uint64_t dead{};
+
+    for (size_t i = 0; i < SCAN_BLOCK; i += 4) {
+      const auto words = _mm256_set_epi64x(scan_word(nodes[i + 3]), scan_word(nodes[i + 2]), scan_word(nodes[i + 1]), scan_word(nodes[i]));
+      const auto next = _mm256_and_si256(_mm256_srli_epi64(words, layout_type::NEXT_LINK_SHIFT), link_mask);
+      const auto mask = _mm256_or_si256(_mm256_cmpeq_epi64(words, null_link), _mm256_cmpeq_epi64(next, deleting));
+
+      dead |= uint64_t{static_cast<uint32_t>(_mm256_movemask_pd(_mm256_castsi256_pd(mask)))} << i;
+    }
+
+    return ~dead;
+  }
+
+  /** @see live_mask_avx2() */
+  [[gnu::target("sse4.1")]] static uint64_t live_mask_sse41(const node_type* nodes) noexcept {
+    const auto null_link = _mm_set1_epi64x(-1);
+    const auto link_mask = _mm_set1_epi64x(static_cast<int64_t>(layout_type::LINK_MASK));
+    const auto deleting = _mm_set1_epi64x(static_cast<int64_t>(node_type::DELETING_MARK));
+
+    uint64_t dead{};
+
+    for (size_t i = 0; i < SCAN_BLOCK; i += 2) {
+      const auto words = _mm_set_epi64x(scan_word(nodes[i + 1]), scan_word(nodes[i]));
+      const auto next = _mm_and_si128(_mm_srli_epi64(words, layout_type::NEXT_LINK_SHIFT), link_mask);
+      const auto mask = _mm_or_si128(_mm_cmpeq_epi64(words, null_link), _mm_cmpeq_epi64(next, deleting));
+
+      dead |= uint64_t{static_cast<uint32_t>(_mm_movemask_pd(_mm_castsi128_pd(mask)))} << i;
+    }
+
+    return ~dead;
+  }
+#endif // UT_LIST_SIMD_SCAN
+
+  /** collect() results that aren't counts. */
+  static constexpr size_t COLLECT_FAILED = std::numeric_limits<size_t>::max();
+  static constexpr size_t COLLECT_OVERFLOW = COLLECT_FAILED - 1;
+
+  /**
+   * One pass of snapshot(): walk from the head and store the elements in
+   * out, or with verify compare them with out instead.
+   *
+   * @return the number of elements, COLLECT_FAILED if the pass met a node
+   *         that is being removed or inserted, a verify mismatch or a last
+   *         node that isn't the tail, COLLECT_OVERFLOW if there are more
+   *         than capacity elements.
+   */
+  [[nodiscard]] size_t collect(item_pointer* out, size_t capacity, bool verify) const noexcept {
+    [[maybe_unused]] const auto guard = m_reclaim.guard();
+    size_t count{};
+    auto last = node_type::NULL_PTR;
+    auto link = m_state->m_head.load(std::memory_order_acquire);
+
+    while (link != node_type::NULL_PTR) {
+      const auto links = to_node(link)->m_links.load(std::memory_order_acquire);
+      const auto link_data = unpack_links<layout_type>(links);
+
+      /* A pinned anchor is in the list, the new node of an insert_before()
+       * in front of it isn't yet */
+      if (links == node_type::NULL_LINK || link_data.is_deleting() ||
+          (link_data.is_pinned() && link_data.prev_version == PIN_NEW)) [[unlikely]] {
+        return COLLECT_FAILED;
+      } else if (count == capacity) [[unlikely]] {
+        return verify ? COLLECT_FAILED : COLLECT_OVERFLOW;
+      }
+
+      const auto item = to_item(link);
+
+      if (!verify) {
+        out[count] = item;
+      } else if (out[count] != item) [[unlikely]] {
+        return COLLECT_FAILED;
+      }
+
+      ++count;
+      last = link;
+      link = node_type::next_link(links);
+    }
+
+    /* A push_back() moves the tail before it links the old one to it */
+    if (m_state->m_tail.load(std::memory_order_acquire) != last) [[unlikely]] {
+      return COLLECT_FAILED;
+    }
+
+    return count;
+  }
+
+  /** Brackets the link updates of one operation for snapshot(), empty
+   * unless UT_LIST_SNAPSHOT_EPOCH is set. */
+  struct Write_section {
+#if UT_LIST_SNAPSHOT_EPOCH
+    explicit Write_section(state_type& state) noexcept
+      : m_state(state) {
+      m_state.m_writes_begun.fetch_add(1, std::memory_order_seq_cst);
+    }
+
+    ~Write_section() noexcept {
+      m_state.m_writes_done.fetch_add(1, std::memory_order_seq_cst);
+    }
+
+    state_type& m_state;
+#else
+    explicit Write_section(state_type&) noexcept {}
+#endif // UT_LIST_SNAPSHOT_EPOCH
+
+    Write_section(const Write_section&) = delete;
+    Write_section& operator=(const Write_section&) = delete;
+  };
+
+  /** The walk behind for_each() and visit_until(), visitor returns true to
+   * stop. */
+  template <typename Visitor>
+  [[nodiscard]] Walk walk(Visitor&& visitor) noexcept(noexcept(visitor(std::declval<item_reference>()))) {
+    [[maybe_unused]] const auto guard = m_reclaim.guard();
+    uint32_t retries{};
+    Backoff backoff{};
+    node_pointer prev{};
+    auto link = m_state->m_head.load(std::memory_order_acquire);
+
+    while (link != node_type::NULL_PTR) [[likely]] {
+      auto node = to_node(link);
+      const auto links = node->m_links.load(std::memory_order_acquire);
+
+      if (links == node_type::NULL_LINK || node_type::next_link(links) == node_type::DELETING_MARK) [[unlikely]] {
+        m_stats.add(List_stat::FIND_RESTARTS);
+
+        if (++retries >= Backoff::MAX_RETRIES) [[unlikely]] {
+          return Walk::LOST;
+        }
+
+        /* Wait for the removal to unlink the node from our predecessor */
+        backoff.pause();
+
+        if (prev == nullptr) {
+          link = m_state->m_head.load(std::memory_order_acquire);
+        } else {
+          const auto prev_links = prev->m_links.load(std::memory_order_acquire);
+
+          if (prev_links == node_type::NULL_LINK || node_type::next_link(prev_links) == node_type::DELETING_MARK) [[unlikely]] {
+            return Walk::LOST;
+          }
+          link = node_type::next_link(prev_links);
+        }
+        continue;
+      }
+
+      if (visitor(*to_item(*node))) [[unlikely]] {
+        return Walk::STOPPED;
+      }
+
+      retries = 0;
+      prev = node;
+      link = node_type::next_link(links);
+    }
+
+    return Walk::END;
+  }
+
+  /** A run claimed by claim_run(). */
+  struct Run {
+    /** Nodes claimed, 0 if the first node couldn't be claimed. */
+    size_t m_count{};
+
+    /** Last node claimed. */
+    node_type* m_last{};
+
+    /** The run's successor when it was unlinked. */
+    typename node_type::Link_type m_next{node_type::NULL_PTR};
+  };
+
+  /**
+   * Claim first as in remove() step 1, then claim its successors while
+   * extend(successor) accepts them, up to and including stop if it's set
+   * and up to limit nodes, and unlink the run with one unlink(). With
+   * front, first must be the head. A successor that is claimed by another
+   * thread, or whose claim CAS fails, ends the run.
+   *
+   * The run's nodes are left claimed, with their prev links, the caller
+   * finalizes them back to front. extend() is called again for nodes of a
+   * claim that backed off, see claim_stands().
+   */
+  template <typename Extend>
+  [[nodiscard]] Run claim_run(node_type& first, const node_type* stop, size_t limit, bool front, Extend&& extend)
+      noexcept(noexcept(extend(first))) {
+    uint32_t retries{};
+    Backoff backoff{};
+
+    while (retries++ < Backoff::MAX_RETRIES) [[likely]] {
+      if (retries > 1) [[unlikely]] {
+        m_stats.add(List_stat::RETRIES);
+        backoff.pause();
+      }
+
+      auto first_links = first.m_links.load(std::memory_order_seq_cst);
+
+      if (first_links == node_type::NULL_LINK || is_detached(first_links)) [[unlikely]] {
+        return {};
+      }
+
+      const auto first_data = unpack_links<layout_type>(first_links);
+
+      if (is_claimed(first_links)) [[unlikely]] {
+        /* Removed, moved, linked next to or backing off, see remove() */
+        await_released(first);
+        continue;
+      }
+
+      if (front && first_data.prev != node_type::NULL_PTR) [[unlikely]] {
+        return {};
+      }
+
+      typename node_type::Link_word deleting_links = pack_links<layout_type>(node_type::DELETING_MARK, first_data.prev,
+                                           (first_data.next_version + 1) & node_type::VERSION_MASK,
+                                           first_data.prev_version);
+
+      if (!first.m_links.compare_exchange_strong(first_links, deleting_links, std::memory_order_seq_cst)) [[unlikely]] {
+        m_stats.add(List_stat::CLAIM_CAS_FAILURES);
+        continue;
+      }
+
+      Run run{1, &first, first_data.next};
+
+      while (run.m_count < limit && run.m_last != stop && run.m_next != node_type::NULL_PTR) {
+        auto next = to_node(run.m_next);
+
+        if (!extend(*next)) {
+          break;
+        }
+
+        auto next_links = next->m_links.load(std::memory_order_seq_cst);
+
+        if (next_links == node_type::NULL_LINK) [[unlikely]] {
+          break;
+        }
+
+        const auto next_data = unpack_links<layout_type>(next_links);
+
+        /* Claimed, or an insert between last and next is half done */
+        if (is_claimed(next_links) || next_data.prev != to_link(*run.m_last)) [[unlikely]] {
+          break;
+        }
+
+        deleting_links = pack_links<layout_type>(node_type::DELETING_MARK, next_data.prev,
+                                                 (next_data.next_version + 1) & node_type::VERSION_MASK,
+                                                 next_data.prev_version);
+
+        if (!next->m_links.compare_exchange_strong(next_links, deleting_links, std::memory_order_seq_cst)) [[unlikely]] {
+          m_stats.add(List_stat::CLAIM_CAS_FAILURES);
+          break;
+        }
+
+        run.m_last = next;
+        run.m_next = next_data.next;
+        ++run.m_count;
+      }
+
+      if (!claim_stands(first, *run.m_last, first_data.prev, run.m_next)) [[unlikely]] {
+        continue;
+      }
+
+      unlink(first, *run.m_last, first_data.prev, run.m_next, run.m_count);
+
+      return run;
+    }
+
+    m_stats.add(List_stat::RETRY_EXHAUSTED);
+    return {};
+  }
+
+  /**
+   * claim_run() without a limit, then step 6 for each node of the run.
+   */
+  template <typename Extend>
+  [[nodiscard]] Run remove_run(node_type& first, const node_type* stop, Extend&& extend) noexcept(noexcept(extend(first))) {
+    [[maybe_unused]] const auto guard = m_reclaim.guard();
+    const Write_section section{*m_state};
+
+    m_stats.add(List_stat::ATTEMPTS);
+
+    const auto run = claim_run(first, stop, std::numeric_limits<size_t>::max(), false, extend);
+
+    if (run.m_count > 0) [[likely]] {
+      for (auto node = run.m_last;;) {
+        const auto prev = unpack_links<layout_type>(node->m_links.load(std::memory_order_relaxed)).prev;
+
+        node->m_links.store(node_type::NULL_LINK, std::memory_order_release);
+
+        if (node == &first) {
+          break;
+        }
+        node = to_node(prev);
+      }
+    }
+
+    return run;
+  }
+
+  /**
+   * claim_run() from the head, up to n nodes. The run is left claimed,
+   * nothing else can remove it or insert next to it until the caller
+   * finalizes or relinks its nodes back to front.
+   */
+  [[nodiscard]] Run detach_front(size_t n) noexcept {
+    [[maybe_unused]] const auto guard = m_reclaim.guard();
+    uint32_t retries{};
+    Backoff backoff{};
+    const Write_section section{*m_state};
+
+    m_stats.add(List_stat::ATTEMPTS);
+
+    while (n > 0 && retries++ < Backoff::MAX_RETRIES) [[likely]] {
+      if (retries > 1) [[unlikely]] {
+        m_stats.add(List_stat::RETRIES);
+        backoff.pause();
+      }
+
+      const auto head_link = m_state->m_head.load(std::memory_order_acquire);
+
+      if (head_link == node_type::NULL_PTR) [[unlikely]] {
+        return {};
+      }
+
+      const auto run = claim_run(*to_node(head_link), nullptr, n, true, [](const node_type&) { return true; });
+
+      if (run.m_count > 0) [[likely]] {
+        return run;
+      }
+      /* No longer the head */
+    }
+
+    return {};
+  }
+
+  /**
+   * Steps 2 to 5 of remove() for the run first..last, with first already
+   * marked DELETING_MARK by the caller. original_prev and original_next
+   * are the neighbours of the run at the time it was marked. The caller
+   * finalizes the nodes of the run.
+   */
+  void unlink(node_type& first, node_type& last,
+              typename node_type::Link_type original_prev,
+              typename node_type::Link_type original_next,
+              size_t count) noexcept {
+    const auto first_link = to_link(first);
+    const auto last_link = to_link(last);
+    auto prev_node = to_node(original_prev);
+    auto next_node = to_node(original_next);
+
+    /* Decrement size immediately since deletion is committed */
+    m_state->m_size.sub(static_cast<int64_t>(count));
+
+    /* Step 2: Update head if the run was at the head */
+    if (original_prev == node_type::NULL_PTR) {
+      typename node_type::Link_type expected_head = first_link;
+      while (!m_state->m_head.compare_exchange_weak(expected_head, original_next, std::memory_order_acq_rel)) {
+        m_stats.add(List_stat::HEAD_CAS_FAILURES);
+        if (expected_head != first_link) break;  /* Head already updated */
+      }
+    }
+
+    /* Step 3: Update tail if the run was at the tail */
+    if (original_next == node_type::NULL_PTR) {
+      typename node_type::Link_type expected_tail = last_link;
+      while (!m_state->m_tail.compare_exchange_weak(expected_tail, original_prev, std::memory_order_acq_rel)) {
+        m_stats.add(List_stat::TAIL_CAS_FAILURES);
+        if (expected_tail != last_link) break;  /* Tail already updated */
+      }
+    }
+
+    /* Step 4: Update prev_node->next to skip the run */
+    if (prev_node != nullptr) [[likely]] {
+      uint32_t prev_retries{};
+      Backoff prev_backoff{};
+      typename node_type::Link_word prev_links;
+      Basic_link_pack<layout_type> prev_link_data;
+
+      do {
+        if (prev_retries > 0) [[unlikely]] {
+          m_stats.add(List_stat::FIXUP_CAS_FAILURES);
+        }
+
+        if (prev_retries++ >= Backoff::MAX_RETRIES) [[unlikely]] {
+          m_stats.add(List_stat::FIXUP_GIVE_UPS);
+          break;  /* Give up but continue - deletion is committed */
+        } else if (prev_retries > 1) [[unlikely]] {
+          prev_backoff.pause();
+        }
+
+        prev_links = prev_node->m_links.load(std::memory_order_acquire);
+
+        /* A claimed prev_node backs off, see neighbours_linked() */
+        if (is_claimed(prev_links)) [[unlikely]] {
+          (void) await([&] { return !is_claimed(prev_links = prev_node->m_links.load(std::memory_order_acquire)); });
+        }
+
+        prev_link_data = unpack_links<layout_type>(prev_links);
+
+        if (prev_links == node_type::NULL_LINK || is_claimed(prev_links)) [[unlikely]] {
+          m_stats.add(List_stat::FIXUP_GIVE_UPS);
+          break;
+        }
+
+        /* Check if already updated */
+        if (prev_link_data.next != first_link) [[unlikely]] {
+          break;  /* Already updated or something else happened */
+        }
+
+      } while (!prev_node->m_links.compare_exchange_weak(prev_links,
+                live_links(original_next, prev_link_data.prev,
+                          (prev_link_data.next_version + 1) & node_type::VERSION_MASK, prev_link_data.prev_version),
+                std::memory_order_acq_rel));
+    }
+
+    /* Step 5: Update next_node->prev to skip the run */
+    if (next_node != nullptr) [[likely]] {
+      uint32_t next_retries{};
+      Backoff next_backoff{};
+      typename node_type::Link_word next_links;
+      Basic_link_pack<layout_type> next_link_data;
+
+      do {
+        if (next_retries > 0) [[unlikely]] {
+          m_stats.add(List_stat::FIXUP_CAS_FAILURES);
+        }
+
+        if (next_retries++ >= Backoff::MAX_RETRIES) [[unlikely]] {
+          m_stats.add(List_stat::FIXUP_GIVE_UPS);
+          break;  /* Give up but continue - deletion is committed */
+        } else if (next_retries > 1) [[unlikely]] {
+          next_backoff.pause();
+        }
+
+        next_links = next_node->m_links.load(std::memory_order_acquire);
+
+        /* A claimed next_node backs off, see neighbours_linked() */
+        if (is_claimed(next_links)) [[unlikely]] {
+          (void) await([&] { return !is_claimed(next_links = next_node->m_links.load(std::memory_order_acquire)); });
+        }
+
+        next_link_data = unpack_links<layout_type>(next_links);
+
+        if (next_links == node_type::NULL_LINK || is_claimed(next_links)) [[unlikely]] {
+          m_stats.add(List_stat::FIXUP_GIVE_UPS);
+          break;
+        }
+
+        /* Check if already updated */
+        if (next_link_data.prev != last_link) [[unlikely]] {
+          break;  /* Already updated or something else happened */
+        }
+
+      } while (!next_node->m_links.compare_exchange_weak(next_links,
+                live_links(next_link_data.next, original_prev,
+                          next_link_data.next_version, (next_link_data.prev_version + 1) & node_type::VERSION_MASK),
+                std::memory_order_acq_rel));
+    }
+  }
+
+  /**
+   * insert_after(), with before insert_before(), on nodes. If expected_next
+   * is set the successor must still be that link.
+   *
+   * node is pinned while new_node is linked in, see is_claimed(). Once the
+   * pin stands neither node nor its neighbours can be removed, moved or
+   * linked next to by another thread, see neighbours_linked(), so the
+   * links are set with no way back once a neighbour links to new_node.
+   * Walks go on through node meanwhile. new_node is pinned too until both
+   * its neighbours link to it, a walk that reaches it goes on to node.
+   *
+   * Only a claimer that stalls before it backs off can hold up the swing
+   * of the neighbour, see swing_link(). If the swing gives up nothing
+   * links to new_node yet, node gets its word back and the insert retries
+   * within its budget, then fails.
+   */
+  [[nodiscard]] bool insert(node_type& node, node_type& new_node, std::optional<typename node_type::Link_type> expected_next,
+                            bool before) noexcept {
+    [[maybe_unused]] const auto guard = m_reclaim.guard();
+    if (node.is_null()) {
+      return false;
+    }
+
+    uint32_t retries{};
+    Backoff backoff{};
+    const auto node_link = to_link(node);
+    const auto new_node_link = to_link(new_node);
+    const Write_section section{*m_state};
+
+    m_stats.add(List_stat::ATTEMPTS);
+
+    while (retries++ < Backoff::MAX_RETRIES) [[likely]] {
+      if (retries > 1) [[unlikely]] {
+        m_stats.add(List_stat::RETRIES);
+        backoff.pause();
+      }
+
+      auto node_links = node.m_links.load(std::memory_order_seq_cst);
+
+      if (node_links == node_type::NULL_LINK || is_detached(node_links)) [[unlikely]] {
+        /* Node was removed */
+        new_node.invalidate();
+        return false;
+      }
+
+      const auto link_data = unpack_links<layout_type>(node_links);
+
+      if (is_claimed(node_links)) [[unlikely]] {
+        /* Removed, moved, linked next to or backing off, see remove() */
+        await_released(node);
+        continue;
+      }
+
+      if (expected_next.has_value() && link_data.next != *expected_next) [[unlikely]] {
+        /* Successor changed since the caller looked */
+        new_node.invalidate();
+        return false;
+      }
+
+      if (!node.m_links.compare_exchange_strong(node_links, pinned_links(link_data.next, link_data.next_version, PIN_HELD),
+                                                std::memory_order_seq_cst)) [[unlikely]] {
+        m_stats.add(List_stat::INSERT_CAS_FAILURES);
+        continue;
+      }
+
+      if (!pin_stands(node, node_links, link_data.prev, link_data.next)) [[unlikely]] {
+        continue;
+      }
+
+      if (before) {
+        new_node.m_links.store(pinned_links(node_link, 0, PIN_NEW), std::memory_order_relaxed);
+
+        if (link_data.prev == node_type::NULL_PTR) {
+          swing_end(m_state->m_head, node_link, new_node_link);
+        } else if (!swing_link(*to_node(link_data.prev), new_node_link, true)) [[unlikely]] {
+          /* Nothing links to new_node yet, node gets its word back */
+          node.m_links.store(node_links, std::memory_order_seq_cst);
+          continue;
+        }
+
+        /* The insert is done once new_node has its prev link, then the pin
+         * on node is released */
+        new_node.m_links.store(pack_links<layout_type>(node_link, link_data.prev, 0, 0), std::memory_order_release);
+        node.m_links.store(pack_links<layout_type>(link_data.next, new_node_link, link_data.next_version,
+                                                   (link_data.prev_version + 1) & node_type::VERSION_MASK),
+                           std::memory_order_release);
+      } else {
+        new_node.m_links.store(pack_links<layout_type>(link_data.next, node_link, 0, 0), std::memory_order_relaxed);
+
+        /* The insert is done once the successor, or the tail, is swung */
+        if (link_data.next == node_type::NULL_PTR) {
+          swing_end(m_state->m_tail, node_link, new_node_link);
+        } else if (!swing_link(*to_node(link_data.next), new_node_link, false)) [[unlikely]] {
+          node.m_links.store(node_links, std::memory_order_seq_cst);
+          continue;
+        }
+
+        node.m_links.store(pack_links<layout_type>(new_node_link, link_data.prev,
+                                                   (link_data.next_version + 1) & node_type::VERSION_MASK,
+                                                   link_data.prev_version),
+                           std::memory_order_release);
+      }
+
+      m_state->m_size.add(1);
+      return true;
+    }
+
+    new_node.invalidate();
+    m_stats.add(List_stat::RETRY_EXHAUSTED);
+    return false;
+  }
+
+  /** Point the head or tail end, which is link, at new_link. Only the
+   * caller, which holds the pin on the end node, swings it. */
+  static void swing_end(std::atomic<typename node_type::Link_type>& end, typename node_type::Link_type link,
+                        typename node_type::Link_type new_link) noexcept {
+    [[maybe_unused]] const auto swung = end.compare_exchange_strong(link, new_link, std::memory_order_acq_rel);
+
+    assert(swung);
+  }
+
+  /**
+   * Point the next link, without next the prev link, of a pinned node's
+   * neighbour at new_link. The pin keeps the link itself as is, only
+   * fix-ups of the neighbour's other link and claims that back off get in
+   * the way. A claimer that stalls before it backs off holds the swing up
+   * for as long as it stalls, so the swing gives up after the retry budget
+   * like any other step.
+   *
+   * @return false if the budget was exhausted, the neighbour is unchanged.
+   */
+  [[nodiscard]] bool swing_link(node_type& neighbour, typename node_type::Link_type new_link, bool next) noexcept {
+    auto links = neighbour.m_links.load(std::memory_order_acquire);
+
+    for (uint32_t retries{}; retries < Backoff::MAX_RETRIES; ++retries) {
+      if (is_claimed(links)) [[unlikely]] {
+        (void) await([&] { return !is_claimed(links = neighbour.m_links.load(std::memory_order_acquire)); });
+        continue;
+      }
+
+      const auto link_data = unpack_links<layout_type>(links);
+      const auto new_links = next
+        ? pack_links<layout_type>(new_link, link_data.prev, (link_data.next_version + 1) & node_type::VERSION_MASK,
+                                  link_data.prev_version)
+        : pack_links<layout_type>(link_data.next, new_link, link_data.next_version,
+                                  (link_data.prev_version + 1) & node_type::VERSION_MASK);
+
+      if (neighbour.m_links.compare_exchange_weak(links, new_links, std::memory_order_acq_rel,
+                                                  std::memory_order_acquire)) [[likely]] {
+        return true;
+      }
+      m_stats.add(List_stat::FIXUP_CAS_FAILURES);
+    }
+
+    m_stats.add(List_stat::FIXUP_GIVE_UPS);
+    return false;
+  }
+
+  /**
+   * pack_links() for a node that stays in the list. With both links
+   * NULL_PTR, the only element, the versions must not both wrap to their
+   * maximum, that word is NULL_LINK.
+   */
+  [[nodiscard]] static typename node_type::Link_word live_links(typename node_type::Link_type next, typename node_type::Link_type prev,
+                                                                typename layout_type::Version_type next_version,
+                                                                typename layout_type::Version_type prev_version) noexcept {
+    const auto links = pack_links<layout_type>(next, prev, next_version, prev_version);
+
+    return links != node_type::NULL_LINK ? links : pack_links<layout_type>(next, prev, 0, 0);
+  }
+
+  /**
+   * @return true if links carry a claim or a pin, see neighbours_linked().
+   *
+   * A node is claimed for its removal, remove() step 1, with DELETING_MARK
+   * in its next link. An insert next to a node, or a move of it, pins the
+   * node instead, with DELETING_MARK in its prev link. The pin keeps the
+   * next link, walks, iterators and find() go through a pinned node as
+   * through any live one. Writers treat a pin as a claim.
+   */
+  [[nodiscard]] static bool is_claimed(typename node_type::Link_word links) noexcept {
+    return links != node_type::NULL_LINK &&
+           (node_type::next_link(links) == node_type::DELETING_MARK || unpack_links<layout_type>(links).is_pinned());
+  }
+
+  /** Roles of a pin, kept in the prev version of the pinned word: the
+   * anchor of an insert or a node that is being moved, and the new node
+   * of insert_before() until both of its neighbours link to it. recover()
+   * tells them apart. */
+  static constexpr typename layout_type::Version_type PIN_HELD = 0;
+  static constexpr typename layout_type::Version_type PIN_NEW = 1;
+
+  /** The word of a node pinned in role, with next as its next link. */
+  [[nodiscard]] static typename node_type::Link_word pinned_links(typename node_type::Link_type next,
+                                                                  typename layout_type::Version_type next_version,
+                                                                  typename layout_type::Version_type role) noexcept {
+    return pack_links<layout_type>(next, node_type::DELETING_MARK, next_version, role);
+  }
+
+  /**
+   * The word of a node of a chain that take_all() detached, with next as
+   * its next link: a pin in role PIN_NEW with next version 1, the new node
+   * of an insert_before() always has next version 0. Readers go through
+   * it as through that new node, scans and recover() don't count it as an
+   * element. remove(), the inserts and move() fail on it at once instead
+   * of waiting for the pin to go, see is_detached().
+   */
+  [[nodiscard]] static typename node_type::Link_word detached_links(typename node_type::Link_type next) noexcept {
+    return pinned_links(next, 1, PIN_NEW);
+  }
+
+  /** @return true if links are those of a detached node, see detached_links(). */
+  [[nodiscard]] static bool is_detached(typename node_type::Link_word links) noexcept {
+    return links == detached_links(node_type::next_link(links));
+  }
+
+  /** Wait until node is not claimed, or is detached, see remove(). */
+  void await_released(const node_type& node) const noexcept {
+    (void) await([&node] {
+      const auto links = node.m_links.load(std::memory_order_seq_cst);
+
+      return !is_claimed(links) || is_detached(links);
+    });
+  }
+
+  /** Wait until the node at link, if there is one, is not claimed. */
+  void await_unclaimed(typename node_type::Link_type link) const noexcept {
+    if (link != node_type::NULL_PTR) {
+      const auto node = to_node(link);
+
+      (void) await([node] { return !is_claimed(node->m_links.load(std::memory_order_seq_cst)); });
+    }
+  }
+
+  /**
+   * Second half of a claim. A node is claimed with the DELETING_MARK CAS,
+   * remove() step 1, or pinned, see is_claimed(), a run by claiming its
+   * nodes in order. The claim only
+   * stands if the run's neighbours, or the head and the tail in their
+   * place, are live and still point at the run: two adjacent claimed
+   * nodes that were unlinked at once would each skip the other's
+   * fix-ups.
+   *
+   * Claims and these checks are sequentially consistent, so of two
+   * adjacent claimers at least one sees the other, puts its links back
+   * and waits for the other to finish, see claim_stands(). unlink() in
+   * turn waits for a claimed neighbour to resolve instead of skipping it,
+   * which is what makes putting the links back safe.
+   *
+   * @return true if the claim of first..last stands.
+   */
+  [[nodiscard]] bool neighbours_linked(typename node_type::Link_type first, typename node_type::Link_type last,
+                                       typename node_type::Link_type prev, typename node_type::Link_type next) const noexcept {
+    if (prev == node_type::NULL_PTR) {
+      if (m_state->m_head.load(std::memory_order_seq_cst) != first) {
+        return false;
+      }
+    } else {
+      const auto prev_links = to_node(prev)->m_links.load(std::memory_order_seq_cst);
+
+      if (prev_links == node_type::NULL_LINK || is_claimed(prev_links) || node_type::next_link(prev_links) != first) {
+        return false;
+      }
+
+      /* A node with no prev link is the head, or it's still being
+       * published in front of first */
+      if (unpack_links<layout_type>(prev_links).prev == node_type::NULL_PTR &&
+          m_state->m_head.load(std::memory_order_seq_cst) != prev) [[unlikely]] {
+        return false;
+      }
+
+      /* A publish in front of the head is in flight, it swings the head
+       * away from first, see link_front() */
+      if (m_state->m_head.load(std::memory_order_seq_cst) == first) [[unlikely]] {
+        return false;
+      }
+    }
+
+    if (next == node_type::NULL_PTR) {
+      if (m_state->m_tail.load(std::memory_order_seq_cst) != last) {
+        return false;
+      }
+    } else {
+      const auto next_links = to_node(next)->m_links.load(std::memory_order_seq_cst);
+
+      const auto next_data = unpack_links<layout_type>(next_links);
+
+      if (next_links == node_type::NULL_LINK || is_claimed(next_links) || next_data.prev != last) {
+        return false;
+      }
+
+      if (next_data.next == node_type::NULL_PTR && m_state->m_tail.load(std::memory_order_seq_cst) != next) [[unlikely]] {
+        return false;
+      }
+
+      if (m_state->m_tail.load(std::memory_order_seq_cst) == last) [[unlikely]] {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  /**
+   * Check the claim of the run first..last, whose neighbours were prev and
+   * next when first was claimed. If it doesn't stand, put back the next
+   * link of each node of the run, nobody else writes a claimed node, and
+   * wait for the neighbours before the caller retries.
+   *
+   * @return true if the claim stands.
+   */
+  [[nodiscard]] bool claim_stands(node_type& first, node_type& last,
+                                  typename node_type::Link_type prev, typename node_type::Link_type next) noexcept {
+    if (neighbours_linked(to_link(first), to_link(last), prev, next)) [[likely]] {
+      return true;
+    }
+
+    m_stats.add(List_stat::CLAIM_BACKOFFS);
+
+    /* Back to front, the claims kept the prev links. Each node gets back
+     * the word it had before its claim. */
+    for (auto node = &last, successor = next;;) {
+      const auto link_data = unpack_links<layout_type>(node->m_links.load(std::memory_order_relaxed));
+
+      node->m_links.store(pack_links<layout_type>(successor, link_data.prev,
+                                                  (link_data.next_version - 1) & node_type::VERSION_MASK,
+                                                  link_data.prev_version),
+                          std::memory_order_seq_cst);
+
+      if (node == &first) {
+        break;
+      }
+      successor = to_link(*node);
+      node = to_node(link_data.prev);
+    }
+
+    await_unclaimed(prev);
+    await_unclaimed(next);
+
+    return false;
+  }
+
+  /**
+   * claim_stands() for the pin of node, whose word was links before the
+   * pin. If it doesn't stand node gets links back.
+   *
+   * @return true if the pin stands.
+   */
+  [[nodiscard]] bool pin_stands(node_type& node, typename node_type::Link_word links,
+                                typename node_type::Link_type prev, typename node_type::Link_type next) noexcept {
+    if (neighbours_linked(to_link(node), to_link(node), prev, next)) [[likely]] {
+      return true;
+    }
+
+    m_stats.add(List_stat::CLAIM_BACKOFFS);
+
+    node.m_links.store(links, std::memory_order_seq_cst);
+
+    await_unclaimed(prev);
+    await_unclaimed(next);
+
+    return false;
+  }
+
+  /** Where remove() expects the node, see pop_front(). */
+  enum class End { ANY, FRONT, BACK };
+
+  /**
+   * remove() of node. With FRONT or BACK it fails unless node is still at
+   * that end: a pop read the head or the tail and the node may have been
+   * moved into the middle of this list or into another one over the same
+   * array since. Only at an end does the claim check tie the node to this
+   * list, through its head or tail, see neighbours_linked().
+   */
+  [[nodiscard]] item_pointer remove(node_type& node, End end) noexcept {
+    [[maybe_unused]] const auto guard = m_reclaim.guard();
+    uint32_t retries{};
+    Backoff backoff{};
+    const Write_section section{*m_state};
+
+    m_stats.add(List_stat::ATTEMPTS);
+
+    while (retries++ < Backoff::MAX_RETRIES) [[likely]] {
+      if (retries > 1) [[unlikely]] {
+        m_stats.add(List_stat::RETRIES);
+        backoff.pause();
+      }
+
+      auto node_links = node.m_links.load(std::memory_order_seq_cst);
+
+      /* Check if already removed or being deleted */
+      if (node_links == node_type::NULL_LINK || is_detached(node_links)) [[unlikely]] {
+        return nullptr;  /* Already removed */
+      }
+
+      auto link_data = unpack_links<layout_type>(node_links);
+
+      /* Claimed by another thread, it's removed, moved, linked next to or
+       * the claim backs off, see neighbours_linked(). Find out which. */
+      if (is_claimed(node_links)) [[unlikely]] {
+        await_released(node);
+        continue;
+      }
+
+      if ((end == End::FRONT && link_data.prev != node_type::NULL_PTR) ||
+          (end == End::BACK && link_data.next != node_type::NULL_PTR)) [[unlikely]] {
+        return nullptr;
+      }
+
+      /* Save original values before any modifications */
+      auto original_prev = link_data.prev;
+      auto original_next = link_data.next;
+
+      /* Step 1: Mark node as "deleting" - this is the commit point */
+      /* Use DELETING_MARK as next to indicate deletion, keep prev as-is */
+      typename node_type::Link_word deleting_links = pack_links<layout_type>(node_type::DELETING_MARK, original_prev,
+                                           (link_data.next_version + 1) & node_type::VERSION_MASK,
+                                           link_data.prev_version);
+
+      if (!node.m_links.compare_exchange_strong(node_links, deleting_links, std::memory_order_seq_cst)) [[unlikely]] {
+        m_stats.add(List_stat::CLAIM_CAS_FAILURES);
+        continue;  /* Node was modified, retry */
+      }
+
+      if (!claim_stands(node, node, original_prev, original_next)) [[unlikely]] {
+        continue;
+      }
+
+      /* Node is now marked as deleting - we own this deletion */
+      unlink(node, node, original_prev, original_next, 1);
+
+      /* Step 6: Finalize - mark node as fully removed */
+      node.m_links.store(node_type::NULL_LINK, std::memory_order_release);
+
+      return to_item(node);
+    }
+
+    /* Failed to remove after max retries */
+    m_stats.add(List_stat::RETRY_EXHAUSTED);
+    return nullptr;
+  }
+
+  /** See move_to_front(), to_front selects the end of to the node moves
+   * to. */
+  [[nodiscard]] Move_result move(node_type& node, List& to, bool to_front) noexcept {
+    [[maybe_unused]] const auto guard = m_reclaim.guard();
+    uint32_t retries{};
+    Backoff backoff{};
+    const Write_section section{*m_state};
+
+    m_stats.add(List_stat::ATTEMPTS);
+
+    while (retries++ < Backoff::MAX_RETRIES) [[likely]] {
+      if (retries > 1) [[unlikely]] {
+        m_stats.add(List_stat::RETRIES);
+        backoff.pause();
+      }
+
+      auto node_links = node.m_links.load(std::memory_order_seq_cst);
+
+      if (node_links == node_type::NULL_LINK || is_detached(node_links)) [[unlikely]] {
+        return Move_result::UNCHANGED;
+      }
+
+      const auto link_data = unpack_links<layout_type>(node_links);
+
+      if (is_claimed(node_links)) [[unlikely]] {
+        /* Removed, moved, linked next to or backing off, see remove() */
+        await_released(node);
+        continue;
+      }
+
+      if (&to == this && (to_front ? link_data.prev : link_data.next) == node_type::NULL_PTR) {
+        /* Already there */
+        return Move_result::MOVED;
+      }
+
+      if (!node.m_links.compare_exchange_strong(node_links, pinned_links(link_data.next, link_data.next_version, PIN_HELD),
+                                                std::memory_order_seq_cst)) [[unlikely]] {
+        m_stats.add(List_stat::CLAIM_CAS_FAILURES);
+        continue;
+      }
+
+      if (!pin_stands(node, node_links, link_data.prev, link_data.next)) [[unlikely]] {
+        continue;
+      }
+
+      /* We own the node now, within a list it stays counted in the size */
+      const size_t count = &to == this ? 0 : 1;
+
+      unlink(node, node, link_data.prev, link_data.next, count);
+
+      /* The node is out of the list and can't be given back. It keeps the
+       * pin until it's published, with its old next link for a walk that
+       * is on it, see recover() for a mover that dies meanwhile. */
+      for (uint32_t publish_retries{}; publish_retries < Backoff::MAX_RETRIES; ++publish_retries) {
+        if (to_front ? to.link_front(node, node, count, std::nullopt, true) : to.link_back(node, node, count, true)) [[likely]] {
+          return Move_result::MOVED;
+        }
+        backoff.pause();
+      }
+
+      /* The move became a removal */
+      node.invalidate();
+
+      if (count == 0) {
+        m_state->m_size.sub(1);
+      }
+
+      m_stats.add(List_stat::RETRY_EXHAUSTED);
+      return Move_result::REMOVED;
+    }
+
+    m_stats.add(List_stat::RETRY_EXHAUSTED);
+    return Move_result::UNCHANGED;
+  }
+
+  [[nodiscard]] static item_reference as_item(item_reference item) noexcept {
+    return item;
+  }
+
+  [[nodiscard]] static item_reference as_item(item_pointer item) noexcept {
+    return *item;
+  }
+
+  /** Link the nodes of [first, last) to each other with relaxed stores. The
+   * first node's prev and the last node's next are NULL_PTR, they are set
+   * when the chain is published. */
+  template <typename Iterator>
+  [[nodiscard]] Chain link_chain(Iterator first, Iterator last) noexcept {
+    Chain chain{m_slots};
+    auto prev_prev_link = node_type::NULL_PTR;
+
+    for (; first != last; ++first, ++chain.m_size) {
+      auto& node = m_slots.node(as_item(*first));
+
+      if (chain.m_last == nullptr) [[unlikely]] {
+        chain.m_first = &node;
+      } else {
+        chain.m_last->m_links.store(pack_links<layout_type>(to_link(node), prev_prev_link, 0, 0), std::memory_order_relaxed);
+        prev_prev_link = to_link(*chain.m_last);
+      }
+      chain.m_last = &node;
+    }
+
+    if (chain.m_last != nullptr) [[likely]] {
+      chain.m_last->m_links.store(pack_links<layout_type>(node_type::NULL_PTR, prev_prev_link, 0, 0), std::memory_order_relaxed);
+    }
+
+    return chain;
+  }
+
+  template <typename Iterator>
+  void invalidate(Iterator first, Iterator last) noexcept {
+    for (; first != last; ++first) {
+      m_slots.node(as_item(*first)).invalidate();
+    }
+  }
+
+  /**
+   * Set the links of an end node of a chain that is being published. A
+   * node that move() publishes is visible to remove() while it's out of
+   * the list, a claim on it can't stand but puts the links back when it
+   * backs off, so they are swapped in with a CAS. A detached node that
+   * splice() publishes is the caller's, see take_all(). With pinned the
+   * node has the caller's pin, which nobody else writes, it keeps the pin
+   * with next as its next link and prev is set by unpin().
+   *
+   * @return false if the retry budget was exhausted.
+   */
+  [[nodiscard]] bool relink(node_type& node, typename node_type::Link_type next, typename node_type::Link_type prev,
+                            bool pinned) noexcept {
+    auto links = node.m_links.load(std::memory_order_acquire);
+
+    if (pinned) {
+      assert(unpack_links<layout_type>(links).is_pinned());
+      node.m_links.store(pinned_links(next, 0, PIN_HELD), std::memory_order_release);
+      return true;
+    }
+
+    for (uint32_t retries{}; retries < Backoff::MAX_RETRIES; ++retries) {
+      if (is_claimed(links) && !is_detached(links)) [[unlikely]] {
+        (void) await([&] { return !is_claimed(links = node.m_links.load(std::memory_order_acquire)); });
+        continue;
+      }
+
+      if (node.m_links.compare_exchange_weak(links, pack_links<layout_type>(next, prev, 0, 0), std::memory_order_release,
+                                             std::memory_order_acquire)) [[likely]] {
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  /** Release the pin of a node that relink() published, with its final
+   * links. */
+  static void unpin(node_type& node, typename node_type::Link_type next, typename node_type::Link_type prev, bool pinned) noexcept {
+    if (pinned) {
+      node.m_links.store(pack_links<layout_type>(next, prev, 0, 0), std::memory_order_release);
+    }
+  }
+
+  /**
+   * Give the detached nodes of a published chain, from link on, their
+   * prev links, front to back, prev is the node in front of link. Until a
+   * node gets its links its neighbours' claims and pins can't stand, see
+   * neighbours_linked(), nobody else writes it.
+   */
+  void attach(typename node_type::Link_type prev, typename node_type::Link_type link) noexcept {
+    while (link != node_type::NULL_PTR) {
+      auto& node = *to_node(link);
+      const auto next = node_type::next_link(node.m_links.load(std::memory_order_relaxed));
+
+      node.m_links.store(pack_links<layout_type>(next, prev, 0, 0), std::memory_order_release);
+      prev = link;
+      link = next;
+    }
+  }
+
+  /**
+   * Undo the end node CAS of link_front(), with front false of link_back(),
+   * after the head or tail swing failed: put back NULL_PTR in the link of
+   * node that was set to link, unless it was rewritten already. Claims on
+   * node can't stand meanwhile, see neighbours_linked().
+   */
+  void retract(node_type& node, typename node_type::Link_type link, bool front) noexcept {
+    auto links = node.m_links.load(std::memory_order_acquire);
+
+    for (uint32_t retries{}; retries < Backoff::MAX_RETRIES; ++retries) {
+      if (is_claimed(links)) [[unlikely]] {
+        (void) await([&] { return !is_claimed(links = node.m_links.load(std::memory_order_acquire)); });
+        continue;
+      }
+
+      const auto link_data = unpack_links<layout_type>(links);
+
+      if (links == node_type::NULL_LINK || (front ? link_data.prev : link_data.next) != link) {
+        return;
+      }
+
+      const auto restored = front
+        ? live_links(link_data.next, node_type::NULL_PTR, link_data.next_version,
+                     (link_data.prev_version + 1) & node_type::VERSION_MASK)
+        : live_links(node_type::NULL_PTR, link_data.prev, (link_data.next_version + 1) & node_type::VERSION_MASK,
+                     link_data.prev_version);
+
+      if (node.m_links.compare_exchange_weak(links, restored, std::memory_order_acq_rel, std::memory_order_acquire)) [[likely]] {
+        return;
+      }
+      m_stats.add(List_stat::FIXUP_CAS_FAILURES);
+    }
+
+    m_stats.add(List_stat::FIXUP_GIVE_UPS);
+  }
+
+  /**
+   * Publish the chain first..last at the front of the list. The chain must
+   * be linked internally, last's next link is (re)written on every attempt.
+   *
+   * The old head's prev link is set first, with a CAS on its links that
+   * fails if it's claimed, then the head is swung to first. A claimed old
+   * head is waited for, its removal then finds the chain linked in front
+   * of it or not at all. A head whose prev link is set belongs to a
+   * publish that is in flight, that is waited for too. On an empty list
+   * the head is set first, then the tail.
+   *
+   * If expected_head is set the chain is only published while the head is
+   * that link. With pinned the chain is a single node that move() pinned,
+   * it keeps the pin until the head is swung, see relink().
+   *
+   * @return false if the retry budget was exhausted or the head is not
+   *         expected_head, nothing was published then.
+   */
+  [[nodiscard]] bool link_front(node_type& first, node_type& last, size_t count,
+                                std::optional<typename node_type::Link_type> expected_head = std::nullopt,
+                                bool pinned = false) noexcept {
+    [[maybe_unused]] const auto guard = m_reclaim.guard();
+    uint32_t retries{};
+    Backoff backoff{};
+    const auto first_link = to_link(first);
+    const auto last_link = to_link(last);
+    const auto last_prev = pinned ? node_type::NULL_PTR : unpack_links<layout_type>(last.m_links.load(std::memory_order_relaxed)).prev;
+    const Write_section section{*m_state};
+
+    m_stats.add(List_stat::ATTEMPTS);
+
+    while (retries++ < Backoff::MAX_RETRIES) [[likely]] {
+      if (retries > 1) [[unlikely]] {
+        m_stats.add(List_stat::RETRIES);
+        backoff.pause();
+      }
+
+      auto old_head_link = m_state->m_head.load(std::memory_order_acquire);
+
+      if (expected_head.has_value() && old_head_link != *expected_head) [[unlikely]] {
+        return false;
+      }
+
+      if (!relink(last, old_head_link, last_prev, pinned)) [[unlikely]] {
+        break;
+      }
+
+      if (old_head_link == node_type::NULL_PTR) [[unlikely]] {
+        /* The last node's removal may not have cleared the tail yet */
+        if (m_state->m_tail.load(std::memory_order_acquire) != node_type::NULL_PTR) {
+          (void) await([this] {
+            return m_state->m_tail.load(std::memory_order_acquire) == node_type::NULL_PTR ||
+                   m_state->m_head.load(std::memory_order_acquire) != node_type::NULL_PTR;
+          });
+          continue;
+        }
+
+        if (!m_state->m_head.compare_exchange_strong(old_head_link, first_link, std::memory_order_acq_rel)) [[unlikely]] {
+          m_stats.add(List_stat::HEAD_CAS_FAILURES);
+          continue;
+        }
+
+        auto expected_tail = node_type::NULL_PTR;
+
+        if (!m_state->m_tail.compare_exchange_strong(expected_tail, last_link, std::memory_order_acq_rel)) [[unlikely]] {
+          m_stats.add(List_stat::TAIL_CAS_FAILURES);
+        }
+
+        unpin(last, node_type::NULL_PTR, last_prev, pinned);
+        m_state->m_size.add(static_cast<int64_t>(count));
+        return true;
+      }
+
+      auto old_head = to_node(old_head_link);
+      auto old_head_links = old_head->m_links.load(std::memory_order_acquire);
+
+      if (old_head_links == node_type::NULL_LINK) [[unlikely]] {
+        continue;  /* Removed, the head moves on */
+      }
+
+      const auto old_head_data = unpack_links<layout_type>(old_head_links);
+
+      if (is_claimed(old_head_links)) [[unlikely]] {
+        m_stats.add(List_stat::END_NODE_REMOVED);
+        await_unclaimed(old_head_link);
+        continue;
+      }
+
+      if (old_head_data.prev != node_type::NULL_PTR) [[unlikely]] {
+        /* Another publish at the front is in flight, let it swing the head */
+        (void) await([this, old_head_link] { return m_state->m_head.load(std::memory_order_acquire) != old_head_link; });
+        continue;
+      }
+
+      if (!old_head->m_links.compare_exchange_strong(old_head_links,
+            pack_links<layout_type>(old_head_data.next, last_link,
+                      old_head_data.next_version, (old_head_data.prev_version + 1) & node_type::VERSION_MASK),
+            std::memory_order_acq_rel)) [[unlikely]] {
+        m_stats.add(List_stat::FIXUP_CAS_FAILURES);
+        continue;
+      }
+
+      /* Nobody else swings the head away from a node whose prev link is
+       * set. If it's no longer the head its links had come back to the
+       * ones we read, e.g. while it was moved to the front again. */
+      if (!m_state->m_head.compare_exchange_strong(old_head_link, first_link, std::memory_order_acq_rel)) [[unlikely]] {
+        m_stats.add(List_stat::HEAD_CAS_FAILURES);
+        retract(*old_head, last_link, true);
+        continue;
+      }
+
+      unpin(last, old_head_link, last_prev, pinned);
+      m_state->m_size.add(static_cast<int64_t>(count));
+      return true;
+    }
+
+    m_stats.add(List_stat::RETRY_EXHAUSTED);
+    return false;
+  }
+
+  /** Mirror image of link_front(), publish first..last at the back: set
+   * the old tail's next link, then swing the tail. */
+  [[nodiscard]] bool link_back(node_type& first, node_type& last, size_t count, bool pinned = false) noexcept {
+    [[maybe_unused]] const auto guard = m_reclaim.guard();
+    uint32_t retries{};
+    Backoff backoff{};
+    const auto first_link = to_link(first);
+    const auto last_link = to_link(last);
+    const auto first_next = pinned ? node_type::NULL_PTR : unpack_links<layout_type>(first.m_links.load(std::memory_order_relaxed)).next;
+    const Write_section section{*m_state};
+
+    m_stats.add(List_stat::ATTEMPTS);
+
+    while (retries++ < Backoff::MAX_RETRIES) [[likely]] {
+      if (retries > 1) [[unlikely]] {
+        m_stats.add(List_stat::RETRIES);
+        backoff.pause();
+      }
+
+      auto old_tail_link = m_state->m_tail.load(std::memory_order_acquire);
+
+      if (!relink(first, first_next, old_tail_link, pinned)) [[unlikely]] {
+        break;
+      }
+
+      if (old_tail_link == node_type::NULL_PTR) [[unlikely]] {
+        auto expected_head = node_type::NULL_PTR;
+
+        /* As in link_front(), the head first, then the tail */
+        if (m_state->m_head.load(std::memory_order_acquire) != node_type::NULL_PTR) {
+          (void) await([this] {
+            return m_state->m_head.load(std::memory_order_acquire) == node_type::NULL_PTR ||
+                   m_state->m_tail.load(std::memory_order_acquire) != node_type::NULL_PTR;
+          });
+          continue;
+        }
+
+        if (!m_state->m_head.compare_exchange_strong(expected_head, first_link, std::memory_order_acq_rel)) [[unlikely]] {
+          m_stats.add(List_stat::HEAD_CAS_FAILURES);
+          continue;
+        }
+
+        if (!m_state->m_tail.compare_exchange_strong(old_tail_link, last_link, std::memory_order_acq_rel)) [[unlikely]] {
+          m_stats.add(List_stat::TAIL_CAS_FAILURES);
+        }
+
+        unpin(first, first_next, node_type::NULL_PTR, pinned);
+        m_state->m_size.add(static_cast<int64_t>(count));
+        return true;
+      }
+
+      auto old_tail = to_node(old_tail_link);
+      auto old_tail_links = old_tail->m_links.load(std::memory_order_acquire);
+
+      if (old_tail_links == node_type::NULL_LINK) [[unlikely]] {
+        continue;
+      }
+
+      const auto old_tail_data = unpack_links<layout_type>(old_tail_links);
+
+      if (is_claimed(old_tail_links)) [[unlikely]] {
+        m_stats.add(List_stat::END_NODE_REMOVED);
+        await_unclaimed(old_tail_link);
+        continue;
+      }
+
+      if (old_tail_data.next != node_type::NULL_PTR) [[unlikely]] {
+        (void) await([this, old_tail_link] { return m_state->m_tail.load(std::memory_order_acquire) != old_tail_link; });
+        continue;
+      }
+
+      if (!old_tail->m_links.compare_exchange_strong(old_tail_links,
+            pack_links<layout_type>(first_link, old_tail_data.prev,
+                      (old_tail_data.next_version + 1) & node_type::VERSION_MASK, old_tail_data.prev_version),
+            std::memory_order_acq_rel)) [[unlikely]] {
+        m_stats.add(List_stat::FIXUP_CAS_FAILURES);
+        continue;
+      }
+
+      if (!m_state->m_tail.compare_exchange_strong(old_tail_link, last_link, std::memory_order_acq_rel)) [[unlikely]] {
+        m_stats.add(List_stat::TAIL_CAS_FAILURES);
+        retract(*old_tail, first_link, false);
+        continue;
+      }
+
+      unpin(first, first_next, old_tail_link, pinned);
+      m_state->m_size.add(static_cast<int64_t>(count));
+      return true;
+    }
+
+    m_stats.add(List_stat::RETRY_EXHAUSTED);
+    return false;
+  }
+
+  /**
+   * Point a list that was moved to another address, together with its
+   * array, at base and set its own state. No other thread may use the list.
+   */
+  void reattach(item_pointer base, typename node_type::Link_type head, typename node_type::Link_type tail, size_t size) noexcept {
+    m_slots.m_base = base;
+    m_state = &m_local_state;
+    m_state->m_head.store(head, std::memory_order_relaxed);
+    m_state->m_tail.store(tail, std::memory_order_relaxed);
+    m_state->m_size.store(size);
+    std::atomic_thread_fence(std::memory_order_release);
+  }
+
+  /* Sorted_list walks the links itself to resume from a predecessor. */
+  template <typename, auto, typename, typename, typename, typename, typename>
+  friend struct Sorted_list;
+
+  /* Persistent_list re-attaches a list that lives in a file. */
+  template <typename, auto, typename>
+  friend struct Persistent_list;
+
+  [[nodiscard]] typename iterator::stats_ref stats_ref() const noexcept {
+    if constexpr (Stats::ENABLED) {
+      return &m_stats;
+    } else {
+      return {};
+    }
+  }
+
+  /* m_slots, m_capacity and m_state are read-only, see List_state for the
+   * rest. */
+  slot_map m_slots{};
+
+  /** Number of slots in the array, see for_each_unordered(). */
+  size_t m_capacity{};
+
+  state_type* m_state{&m_local_state};
+  state_type m_local_state{};
+
+  /* Updated from const walks too */
+  [[no_unique_address]] mutable Stats m_stats{};
+
+  [[no_unique_address]] Reclaim m_reclaim;
 };
 
 } // namespace ut
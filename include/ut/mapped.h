@@ -0,0 +1,196 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "ut/lock_free_list.h"
+
+namespace ut {
+
+/** How Mapped_array maps its memory, flags can be or'ed together. */
+enum class Map_flags : unsigned {
+  NONE = 0,
+
+  /** Explicit huge pages (MAP_HUGETLB) from the kernel's reserved pool.
+   * Falls back to normal pages with TRANSPARENT_HUGE_PAGES if the pool
+   * can't satisfy the mapping. */
+  HUGE_PAGES = 1 << 0,
+
+  /** Ask for transparent huge pages with madvise(MADV_HUGEPAGE). */
+  TRANSPARENT_HUGE_PAGES = 1 << 1,
+
+  /** Fault the whole mapping in up front (MAP_POPULATE). */
+  POPULATE = 1 << 2,
+};
+
+[[nodiscard]] constexpr Map_flags operator|(Map_flags lhs, Map_flags rhs) noexcept {
+  return static_cast<Map_flags>(static_cast<unsigned>(lhs) | static_cast<unsigned>(rhs));
+}
+
+[[nodiscard]] constexpr bool operator&(Map_flags lhs, Map_flags rhs) noexcept {
+  return (static_cast<unsigned>(lhs) & static_cast<unsigned>(rhs)) != 0;
+}
+
+/**
+ * Array of capacity default constructed elements in its own anonymous
+ * mapping, unmapped on destruction. Huge pages cut the TLB misses of link
+ * chasing over large arrays, a 1M element list of 64 byte items spans 16K
+ * base pages but only 32 huge pages.
+ */
+template <typename T>
+struct Mapped_array {
+  /** Size of an explicit huge page, the mapping is rounded up to it. */
+  static constexpr size_t HUGE_PAGE_SIZE = size_t{2} << 20;
+
+  /** @throws std::bad_alloc if the memory can't be mapped. */
+  Mapped_array(size_t capacity, Map_flags flags)
+    : m_capacity(capacity) {
+
+    const auto populate = flags & Map_flags::POPULATE ? MAP_POPULATE : 0;
+    const auto bytes = std::max<size_t>(capacity * sizeof(T), 1);
+    void* addr{MAP_FAILED};
+
+#if defined(MAP_HUGETLB)
+    if (flags & Map_flags::HUGE_PAGES) {
+      m_bytes = round_up(bytes, HUGE_PAGE_SIZE);
+      addr = mmap(nullptr, m_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | populate, -1, 0);
+      m_huge_pages = addr != MAP_FAILED;
+    }
+#endif
+
+    if (addr == MAP_FAILED) {
+      const auto thp = flags & (Map_flags::HUGE_PAGES | Map_flags::TRANSPARENT_HUGE_PAGES);
+
+      /* Give THP a chance to back the whole range. MAP_POPULATE would
+       * fault in base pages before madvise(), populate afterwards then. */
+      m_bytes = round_up(bytes, thp ? HUGE_PAGE_SIZE : static_cast<size_t>(sysconf(_SC_PAGESIZE)));
+      addr = mmap(nullptr, m_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | (thp ? 0 : populate), -1, 0);
+
+      if (addr == MAP_FAILED) {
+        throw std::bad_alloc();
+      }
+
+      if (thp) {
+        /* Advisory only, THP may be disabled. Without MADV_POPULATE_WRITE
+         * the pages are faulted in by the construction below. */
+#if defined(MADV_HUGEPAGE)
+        (void) madvise(addr, m_bytes, MADV_HUGEPAGE);
+#endif
+#if defined(MADV_POPULATE_WRITE)
+        if (populate != 0) {
+          (void) madvise(addr, m_bytes, MADV_POPULATE_WRITE);
+        }
+#endif
+      }
+    }
+
+    m_addr = static_cast<T*>(addr);
+
+    for (size_t i = 0; i < capacity; ++i) {
+      new (&m_addr[i]) T();
+    }
+  }
+
+  ~Mapped_array() noexcept {
+    std::destroy_n(m_addr, m_capacity);
+    munmap(m_addr, m_bytes);
+  }
+
+  Mapped_array(const Mapped_array&) = delete;
+  Mapped_array& operator=(const Mapped_array&) = delete;
+
+  [[nodiscard]] T* base() noexcept {
+    return m_addr;
+  }
+
+  [[nodiscard]] T* end() noexcept {
+    return m_addr + m_capacity;
+  }
+
+  [[nodiscard]] size_t capacity() const noexcept {
+    return m_capacity;
+  }
+
+  /** @return true if the array is backed by explicit huge pages. */
+  [[nodiscard]] bool huge_pages() const noexcept {
+    return m_huge_pages;
+  }
+
+private:
+  [[nodiscard]] static constexpr size_t round_up(size_t n, size_t align) noexcept {
+    return (n + align - 1) / align * align;
+  }
+
+  T* m_addr{};
+  size_t m_bytes{};
+  size_t m_capacity{};
+  bool m_huge_pages{};
+};
+
+/** Arrays of a Mapped_list, a base so that they're mapped before the List
+ * is constructed over them. */
+template <typename T, typename Node_type, bool SideLinks>
+struct Mapped_list_storage {
+  Mapped_list_storage(size_t capacity, Map_flags flags)
+    : m_items(capacity, flags) {}
+
+  Mapped_array<T> m_items;
+};
+
+template <typename T, typename Node_type>
+struct Mapped_list_storage<T, Node_type, true> {
+  Mapped_list_storage(size_t capacity, Map_flags flags)
+    : m_items(capacity, flags),
+      m_nodes(capacity, flags) {}
+
+  [[nodiscard]] Node_type* nodes() noexcept {
+    return m_nodes.base();
+  }
+
+  Mapped_array<T> m_items;
+  Mapped_array<Node_type> m_nodes;
+};
+
+/**
+ * A List that owns its backing array, created by List::create_mapped().
+ * With side links the node array is mapped the same way.
+ *
+ *   auto list = ut::List<Page, &Page::node>::create_mapped(n, ut::Map_flags::HUGE_PAGES | ut::Map_flags::POPULATE);
+ *
+ *   list->push_back(list->items()[0]);
+ */
+template <typename T, auto N, typename Backoff, typename Stats, typename Reclaim>
+struct Mapped_list
+  : private Mapped_list_storage<T, typename Slot_map<T, N>::node_type, Slot_map<T, N>::SIDE_LINKS>,
+    public List<T, N, Backoff, Stats, Reclaim> {
+
+  using list_type = List<T, N, Backoff, Stats, Reclaim>;
+  using storage_type = Mapped_list_storage<T, typename list_type::node_type, list_type::slot_map::SIDE_LINKS>;
+
+  Mapped_list(size_t capacity, Map_flags flags) requires (!list_type::slot_map::SIDE_LINKS)
+    : storage_type(capacity, flags),
+      list_type(storage_type::m_items.base(), storage_type::m_items.end()) {}
+
+  Mapped_list(size_t capacity, Map_flags flags) requires (list_type::slot_map::SIDE_LINKS)
+    : storage_type(capacity, flags),
+      list_type(storage_type::m_items.base(), storage_type::m_items.end(), storage_type::nodes()) {}
+
+  /** The backing array, the list's items are taken from it. */
+  [[nodiscard]] Mapped_array<T>& items() noexcept {
+    return storage_type::m_items;
+  }
+};
+
+template <typename T, auto N, typename Backoff, typename Stats, typename Reclaim>
+std::unique_ptr<Mapped_list<T, N, Backoff, Stats, Reclaim>> List<T, N, Backoff, Stats, Reclaim>::create_mapped(size_t capacity, Map_flags flags) {
+  return std::make_unique<Mapped_list<T, N, Backoff, Stats, Reclaim>>(capacity, flags);
+}
+
+} // namespace ut
@@ -0,0 +1,344 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <new>
+#include <vector>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <linux/mempolicy.h>
+#include <sys/syscall.h>
+#endif
+
+#include "ut/fixed_pool.h"
+
+namespace ut {
+
+/** Number of NUMA nodes, 1 if the system doesn't say. */
+[[nodiscard]] inline size_t numa_nodes() noexcept {
+  static const size_t nodes = []() -> size_t {
+#if defined(__linux__)
+    /* "0" or "0-1", nodes are numbered densely on the machines we care about */
+    if (auto file = std::fopen("/sys/devices/system/node/online", "r"); file != nullptr) {
+      unsigned first{};
+      unsigned last{};
+      const auto n = std::fscanf(file, "%u-%u", &first, &last);
+
+      std::fclose(file);
+
+      if (n == 2 && last >= first) {
+        return last + 1;
+      }
+    }
+#endif
+    return 1;
+  }();
+
+  return nodes;
+}
+
+/** NUMA node of the CPU the caller is running on, 0 if unknown. */
+[[nodiscard]] inline size_t current_numa_node() noexcept {
+#if defined(__linux__)
+  unsigned cpu{};
+  unsigned node{};
+
+  if (syscall(SYS_getcpu, &cpu, &node, nullptr) == 0) {
+    return node;
+  }
+#endif
+  return 0;
+}
+
+/** How Numa_storage spreads its pages over the nodes. */
+enum class Numa_placement {
+  /** Pages round robin over all nodes, even bandwidth for shared data. */
+  INTERLEAVE,
+
+  /** numa_nodes() consecutive parts, part i prefers node i. */
+  PARTITION,
+};
+
+/**
+ * Backing array for a ut::List in anonymous memory with an explicit NUMA
+ * placement, applied with mbind(2) before the pages are first touched.
+ * Placement is best effort: on a single node system, without the syscall
+ * or if the kernel refuses the policy the memory is used as is, see
+ * placed(). The array is contiguous, a page that straddles two parts goes
+ * to the earlier part's node.
+ *
+ * The elements are default constructed on construction and destroyed
+ * with the storage.
+ */
+template <typename T>
+struct Numa_storage {
+  Numa_storage(size_t capacity, Numa_placement placement)
+    : m_capacity(capacity),
+      m_parts(placement == Numa_placement::PARTITION ? numa_nodes() : 1) {
+
+    m_page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    m_part_size = (capacity + m_parts - 1) / m_parts;
+    m_bytes = (capacity * sizeof(T) + m_page - 1) / m_page * m_page;
+
+    auto addr = mmap(nullptr, m_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if (addr == MAP_FAILED) {
+      throw std::bad_alloc();
+    }
+
+    m_addr = static_cast<std::byte*>(addr);
+
+    if (numa_nodes() > 1) {
+      m_placed = placement == Numa_placement::INTERLEAVE ? interleave() : partition();
+    }
+
+    /* First touch, after the policy is in place */
+    for (size_t i = 0; i < capacity; ++i) {
+      new (&base()[i]) T();
+    }
+  }
+
+  ~Numa_storage() noexcept {
+    std::destroy_n(base(), m_capacity);
+    munmap(m_addr, m_bytes);
+  }
+
+  Numa_storage(const Numa_storage&) = delete;
+  Numa_storage& operator=(const Numa_storage&) = delete;
+
+  [[nodiscard]] T* base() noexcept {
+    return reinterpret_cast<T*>(m_addr);
+  }
+
+  [[nodiscard]] T* end() noexcept {
+    return base() + m_capacity;
+  }
+
+  [[nodiscard]] size_t capacity() const noexcept {
+    return m_capacity;
+  }
+
+  [[nodiscard]] size_t parts() const noexcept {
+    return m_parts;
+  }
+
+  /** First element of part, the part's memory prefers NUMA node part. */
+  [[nodiscard]] T* part_begin(size_t part) noexcept {
+    return base() + std::min(part * m_part_size, m_capacity);
+  }
+
+  [[nodiscard]] T* part_end(size_t part) noexcept {
+    return part_begin(part + 1);
+  }
+
+  /** @return true if the requested placement was applied. */
+  [[nodiscard]] bool placed() const noexcept {
+    return m_placed;
+  }
+
+private:
+  [[nodiscard]] static bool bind(void* addr, size_t len, int mode, const std::vector<unsigned long>& mask) noexcept {
+#if defined(__linux__)
+    const auto max_node = mask.size() * 8 * sizeof(unsigned long);
+
+    return syscall(SYS_mbind, addr, len, mode, mask.data(), max_node, 0) == 0;
+#else
+    (void) addr; (void) len; (void) mode; (void) mask;
+    return false;
+#endif
+  }
+
+  [[nodiscard]] size_t page_floor(std::ptrdiff_t offset) const noexcept {
+    return static_cast<size_t>(offset) / m_page * m_page;
+  }
+
+  [[nodiscard]] static std::vector<unsigned long> node_mask(size_t first, size_t last) {
+    constexpr size_t BITS = 8 * sizeof(unsigned long);
+    std::vector<unsigned long> mask(last / BITS + 1);
+
+    for (auto node = first; node <= last; ++node) {
+      mask[node / BITS] |= 1ul << (node % BITS);
+    }
+    return mask;
+  }
+
+  [[nodiscard]] bool interleave() {
+#if defined(__linux__)
+    return bind(m_addr, m_bytes, MPOL_INTERLEAVE, node_mask(0, numa_nodes() - 1));
+#else
+    return false;
+#endif
+  }
+
+  [[nodiscard]] bool partition() {
+#if defined(__linux__)
+    bool placed{true};
+
+    for (size_t part = 0; part < m_parts; ++part) {
+      /* Page range that starts in this part */
+      const auto first = page_floor(reinterpret_cast<std::byte*>(part_begin(part)) - m_addr);
+      const auto last = part + 1 == m_parts ? m_bytes : page_floor(reinterpret_cast<std::byte*>(part_end(part)) - m_addr);
+
+      if (last > first) {
+        placed = bind(m_addr + first, last - first, MPOL_PREFERRED, node_mask(part, part)) && placed;
+      }
+    }
+    return placed;
+#else
+    return false;
+#endif
+  }
+
+  std::byte* m_addr{};
+  size_t m_bytes{};
+  size_t m_page{};
+  size_t m_capacity{};
+  size_t m_parts{};
+  size_t m_part_size{};
+  bool m_placed{};
+};
+
+/**
+ * Slot allocator that prefers slots on the caller's NUMA node. The
+ * backing array is a PARTITION Numa_storage with one Fixed_pool per part.
+ * allocate() tries the pool of the node the caller runs on first, then
+ * the others in order. release() returns a slot to the pool of its part,
+ * so slots never migrate between nodes.
+ *
+ * Combined with a Sharded_list whose threads are pinned per node, most
+ * link traffic stays on the local socket.
+ *
+ *   ut::Numa_pool<Page, &Page::node> pool(capacity);
+ *   ut::List<Page, &Page::node> list(pool.base(), pool.end());
+ *
+ *   decltype(pool)::Cache cache(pool);   // One per thread, not migrated
+ *
+ * @tparam T       Item type.
+ * @tparam N       Node accessor, embedded nodes only.
+ * @tparam Backoff Contention policy of the pools.
+ */
+template <typename T, auto N, typename Backoff = No_backoff<>>
+struct Numa_pool {
+  using pool_type = Fixed_pool<T, N, Backoff>;
+  using item_pointer = typename pool_type::item_pointer;
+
+  static_assert(!pool_type::slot_map::SIDE_LINKS, "Numa_pool needs embedded nodes");
+
+  explicit Numa_pool(size_t capacity)
+    : m_storage(capacity, Numa_placement::PARTITION) {
+
+    for (size_t part = 0; part < m_storage.parts(); ++part) {
+      if (m_storage.part_begin(part) != m_storage.part_end(part)) {
+        m_pools.push_back(std::make_unique<pool_type>(m_storage.part_begin(part), m_storage.part_end(part)));
+      }
+    }
+  }
+
+  [[nodiscard]] item_pointer base() noexcept {
+    return m_storage.base();
+  }
+
+  [[nodiscard]] item_pointer end() noexcept {
+    return m_storage.end();
+  }
+
+  [[nodiscard]] size_t capacity() const noexcept {
+    return m_storage.capacity();
+  }
+
+  /** Pool of the i-th non-empty part, pools() of them. */
+  [[nodiscard]] pool_type& pool(size_t node) noexcept {
+    assert(node < m_pools.size());
+    return *m_pools[node];
+  }
+
+  [[nodiscard]] size_t pools() const noexcept {
+    return m_pools.size();
+  }
+
+  /**
+   * Take a slot, from the pool of the caller's node if it has one.
+   *
+   * @return nullptr if all pools are empty.
+   */
+  [[nodiscard]] item_pointer allocate() noexcept {
+    const auto local = current_numa_node() % m_pools.size();
+
+    for (size_t i = 0; i < m_pools.size(); ++i) {
+      if (auto item = m_pools[(local + i) % m_pools.size()]->allocate(); item != nullptr) [[likely]] {
+        return item;
+      }
+    }
+
+    return nullptr;
+  }
+
+  /** Return a slot to the pool of its node, nullptr is ignored. */
+  void release(item_pointer item) noexcept {
+    if (item == nullptr) [[unlikely]] {
+      return;
+    }
+    pool_of(item).release(item);
+  }
+
+  /**
+   * Per-thread cache over the pool of the node the thread runs on when the
+   * cache is created. Slots of other nodes that are released into it are
+   * passed straight back to their pool.
+   */
+  struct Cache {
+    explicit Cache(Numa_pool& pool) noexcept
+      : m_pool(pool),
+        m_local(pool.pool(current_numa_node() % pool.pools())),
+        m_cache(m_local) {}
+
+    /** @return a local slot, another node's if the local pool is empty,
+     *          nullptr if all are. */
+    [[nodiscard]] item_pointer allocate() noexcept {
+      if (auto item = m_cache.allocate(); item != nullptr) [[likely]] {
+        return item;
+      }
+      return m_pool.allocate();
+    }
+
+    void release(item_pointer item) noexcept {
+      if (item == nullptr) [[unlikely]] {
+        return;
+      }
+
+      if (&m_pool.pool_of(item) == &m_local) [[likely]] {
+        m_cache.release(item);
+      } else {
+        m_pool.release(item);
+      }
+    }
+
+    Numa_pool& m_pool;
+    pool_type& m_local;
+    typename pool_type::Cache m_cache;
+  };
+
+private:
+  [[nodiscard]] pool_type& pool_of(item_pointer item) noexcept {
+    for (auto& pool : m_pools) {
+      if (item >= pool->base() && item < pool->end()) {
+        return *pool;
+      }
+    }
+
+    assert(false);
+    return *m_pools.front();
+  }
+
+  Numa_storage<T> m_storage;
+  std::vector<std::unique_ptr<pool_type>> m_pools;
+};
+
+} // namespace ut
@@ -0,0 +1,252 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "ut/lock_free_list.h"
+
+namespace ut {
+
+/**
+ * A List whose backing array and list object live in a memory mapped
+ * file, so that a restarted process re-attaches to it instead of
+ * rebuilding it.
+ *
+ * The links are slot indices, so the list doesn't care where the file is
+ * mapped. The only pointer, the list's base, is set again on attach. The
+ * file starts with a header that records the layout (item and node size,
+ * link width, capacity). A file that was written with another layout is
+ * refused.
+ *
+ * A clean close marks the file as such and the next open() is O(1). If the
+ * process died while attached, open() runs List::recover() over the array
+ * first, which completes the removals and rolls back the inserts that
+ * were in flight.
+ *
+ * All of that assumes that the stores of the dead process reached the
+ * file's page cache, which a MAP_SHARED mapping guarantees for a process
+ * crash. Surviving a machine crash needs sync() at the points that must be
+ * durable.
+ *
+ *   auto list = ut::Persistent_list<Page, &Page::node>::open("/var/lib/pages", capacity);
+ *
+ *   if (list == nullptr) {
+ *     // Can't map the file, or it has a different layout
+ *   }
+ *
+ *   list->list().push_back(list->items()[0]);
+ *
+ * @tparam T       Item type. It's stored in the file as is, so it must be
+ *                 trivially destructible and must not hold pointers.
+ * @tparam N       Member function of T returning the embedded node.
+ * @tparam Backoff Contention policy of the list.
+ */
+template <typename T, auto N, typename Backoff = No_backoff<>>
+struct Persistent_list {
+  using list_type = List<T, N, Backoff>;
+  using node_type = typename list_type::node_type;
+  using layout_type = typename node_type::layout_type;
+  using item_pointer = typename list_type::item_pointer;
+  using Link_type = typename node_type::Link_type;
+
+  static_assert(!list_type::slot_map::SIDE_LINKS, "Persistent_list needs embedded nodes");
+  static_assert(std::is_trivially_destructible_v<T>, "Items are left in the file as is");
+
+  /** "UTLISTv1" */
+  static constexpr uint64_t MAGIC = 0x55544c4953547631;
+
+  /** Bumped when the file layout changes. */
+  static constexpr uint32_t FORMAT_VERSION = 2;
+
+  /**
+   * Open the list in path, create it with capacity empty slots if the file
+   * doesn't exist or is empty. The file is locked while it's open.
+   *
+   * @return nullptr if the file can't be opened, mapped or locked, or if
+   *         it was written with another layout or capacity.
+   */
+  [[nodiscard]] static std::unique_ptr<Persistent_list> open(const char* path, size_t capacity) {
+    const auto fd = ::open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+
+    if (fd == -1) {
+      return nullptr;
+    }
+
+    struct stat st{};
+
+    if (flock(fd, LOCK_EX | LOCK_NB) != 0 || fstat(fd, &st) != 0) {
+      ::close(fd);
+      return nullptr;
+    }
+
+    const auto bytes = file_size(capacity);
+    const auto create = st.st_size == 0;
+
+    if ((create && ftruncate(fd, static_cast<off_t>(bytes)) != 0) ||
+        (!create && static_cast<size_t>(st.st_size) != bytes)) {
+      ::close(fd);
+      return nullptr;
+    }
+
+    auto addr = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+    if (addr == MAP_FAILED) {
+      ::close(fd);
+      return nullptr;
+    }
+
+    std::unique_ptr<Persistent_list> list(new Persistent_list(fd, static_cast<std::byte*>(addr), bytes, capacity));
+
+    if (create) {
+      list->format();
+    } else if (!list->attach()) {
+      return nullptr;
+    }
+
+    return list;
+  }
+
+  /** Mark the file clean and unmap it. No other thread may use the list. */
+  ~Persistent_list() noexcept {
+    if (m_attached) {
+      header().m_clean = 1;
+      (void) msync(m_addr, m_bytes, MS_SYNC);
+    }
+    munmap(m_addr, m_bytes);
+    ::close(m_fd);
+  }
+
+  Persistent_list(const Persistent_list&) = delete;
+  Persistent_list& operator=(const Persistent_list&) = delete;
+
+  [[nodiscard]] list_type& list() noexcept {
+    return *m_list;
+  }
+
+  /** The backing array, capacity() items. */
+  [[nodiscard]] item_pointer items() noexcept {
+    return reinterpret_cast<item_pointer>(m_addr + ITEMS_OFFSET);
+  }
+
+  [[nodiscard]] size_t capacity() const noexcept {
+    return m_capacity;
+  }
+
+  /** @return true if open() found the file unclean and recovered it. */
+  [[nodiscard]] bool recovered() const noexcept {
+    return m_recovered;
+  }
+
+  /** Write the file back to storage. @return false if msync(2) failed. */
+  [[nodiscard]] bool sync() noexcept {
+    return msync(m_addr, m_bytes, MS_SYNC) == 0;
+  }
+
+private:
+  /** Start of the file, the list object follows it. */
+  struct Header {
+    uint64_t m_magic;
+    uint32_t m_format_version;
+    uint32_t m_link_bits;
+    uint64_t m_item_size;
+    uint64_t m_node_size;
+    uint64_t m_list_size;
+    uint64_t m_capacity;
+
+    /** 1 after a clean close, 0 while the file is attached. */
+    uint64_t m_clean;
+  };
+
+  static constexpr size_t LIST_OFFSET = (sizeof(Header) + alignof(list_type) - 1) / alignof(list_type) * alignof(list_type);
+
+  /** The items start on a page boundary of any page size up to 64K. */
+  static constexpr size_t ITEMS_OFFSET = (LIST_OFFSET + sizeof(list_type) + 65535) / 65536 * 65536;
+
+  static_assert(alignof(T) <= 65536);
+
+  Persistent_list(int fd, std::byte* addr, size_t bytes, size_t capacity) noexcept
+    : m_fd(fd),
+      m_addr(addr),
+      m_bytes(bytes),
+      m_capacity(capacity) {}
+
+  [[nodiscard]] static constexpr size_t file_size(size_t capacity) noexcept {
+    return ITEMS_OFFSET + capacity * sizeof(T);
+  }
+
+  [[nodiscard]] Header& header() noexcept {
+    return *reinterpret_cast<Header*>(m_addr);
+  }
+
+  [[nodiscard]] Header expected_header() const noexcept {
+    return {MAGIC, FORMAT_VERSION, layout_type::LINK_BITS, sizeof(T), sizeof(node_type), sizeof(list_type), m_capacity, 0};
+  }
+
+  /** Set up a new file: construct the items and the list, then write the
+   * header last, a file without a valid header is refused. */
+  void format() {
+    auto base = items();
+
+    for (size_t i = 0; i < m_capacity; ++i) {
+      new (&base[i]) T();
+    }
+
+    m_list = new (m_addr + LIST_OFFSET) list_type(base, base + m_capacity);
+
+    header() = expected_header();
+    m_attached = true;
+  }
+
+  /** Attach to the list in an existing file. @return false if the header
+   * doesn't match. */
+  [[nodiscard]] bool attach() noexcept {
+    auto& header = this->header();
+    const auto expected = expected_header();
+
+    if (header.m_magic != expected.m_magic || header.m_format_version != expected.m_format_version ||
+        header.m_link_bits != expected.m_link_bits || header.m_item_size != expected.m_item_size ||
+        header.m_node_size != expected.m_node_size || header.m_list_size != expected.m_list_size ||
+        header.m_capacity != expected.m_capacity) {
+      return false;
+    }
+
+    /* The list object was constructed by the process that formatted the
+     * file, its bytes are all we need. */
+    m_list = std::launder(reinterpret_cast<list_type*>(m_addr + LIST_OFFSET));
+
+    /* The list's state pointer is the old process's, use its own state */
+    auto& state = m_list->m_local_state;
+
+    m_list->reattach(items(), state.m_head.load(std::memory_order_relaxed),
+                     state.m_tail.load(std::memory_order_relaxed), state.m_size.load());
+
+    if (header.m_clean != 1) [[unlikely]] {
+      (void) m_list->recover(m_capacity);
+      m_recovered = true;
+    }
+
+    header.m_clean = 0;
+    m_attached = true;
+    return true;
+  }
+
+  int m_fd{-1};
+  std::byte* m_addr{};
+  size_t m_bytes{};
+  size_t m_capacity{};
+  list_type* m_list{};
+  bool m_attached{};
+  bool m_recovered{};
+};
+
+} // namespace ut
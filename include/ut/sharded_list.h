@@ -0,0 +1,130 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <utility>
+
+#include "ut/lock_free_list.h"
+
+namespace ut {
+
+/**
+ * One ut::List per thread shard over a shared backing array, a scalable
+ * work stealing pool for task schedulers.
+ *
+ * A thread pushes and pops at the front of its own shard, so the hot
+ * path only contends with thieves. A thread whose shard is empty steals
+ * from the back of the other shards, the oldest elements, in round robin
+ * order starting after its own. Every shard has its own head and tail
+ * cache lines.
+ *
+ * Threads are mapped to shards with this_thread_shard(), round robin in
+ * the order threads first touch a shard. With more threads than Shards
+ * some threads share a shard, which is correct but contended.
+ *
+ * An element must be in at most one shard at a time, they share the
+ * nodes of the backing array. The shards share a Reclaim policy too, each
+ * gets a copy of the one passed in, so a popped element can be retired
+ * through any of them, see retire().
+ *
+ * @tparam T       Item type.
+ * @tparam N       Node accessor, as for ut::List.
+ * @tparam Shards  Number of shards, a power of two.
+ * @tparam Backoff Contention policy of the shards.
+ * @tparam Stats   Statistics policy of the shards, each counts its own.
+ * @tparam Reclaim Reclaim policy of the shards, see ut::List.
+ */
+template <typename T, auto N, size_t Shards = 16, typename Backoff = No_backoff<>, typename Stats = No_stats,
+          typename Reclaim = No_reclaim>
+struct Sharded_list {
+  static_assert((Shards & (Shards - 1)) == 0, "Shards must be a power of two");
+
+  using list_type = List<T, N, Backoff, Stats, Reclaim>;
+  using slot_map = typename list_type::slot_map;
+  using node_pointer = typename list_type::node_pointer;
+  using item_pointer = typename list_type::item_pointer;
+  using item_reference = typename list_type::item_reference;
+
+  static constexpr size_t SHARDS = Shards;
+
+  Sharded_list(item_pointer base, item_pointer end, Reclaim reclaim = {}) requires (!slot_map::SIDE_LINKS)
+    : m_shards(make_shards(std::make_index_sequence<Shards>{}, base, end, reclaim)) {}
+
+  Sharded_list(item_pointer base, item_pointer end, node_pointer nodes, Reclaim reclaim = {}) requires (slot_map::SIDE_LINKS)
+    : m_shards(make_shards(std::make_index_sequence<Shards>{}, base, end, nodes, reclaim)) {}
+
+  Sharded_list(const Sharded_list&) = delete;
+  Sharded_list& operator=(const Sharded_list&) = delete;
+
+  /** Index of the calling thread's shard. */
+  [[nodiscard]] static size_t local_shard() noexcept {
+    return this_thread_shard() & (Shards - 1);
+  }
+
+  [[nodiscard]] list_type& shard(size_t i) noexcept {
+    assert(i < Shards);
+    return m_shards[i].m_list;
+  }
+
+  /** Push item at the front of the calling thread's shard. */
+  [[nodiscard]] bool push(item_reference item) noexcept {
+    return shard(local_shard()).push_front(item);
+  }
+
+  /** Pop from the front of the calling thread's shard, steal if it's
+   * empty. @return nullptr if no element was found. */
+  [[nodiscard]] item_pointer pop() noexcept {
+    const auto local = local_shard();
+
+    if (auto item = shard(local).pop_front(); item != nullptr) [[likely]] {
+      return item;
+    }
+
+    return steal_from(local);
+  }
+
+  /** Pop from the back of another shard than the caller's.
+   * @return nullptr if all of them were empty. */
+  [[nodiscard]] item_pointer steal() noexcept {
+    return steal_from(local_shard());
+  }
+
+  /** Hand a popped element to the Reclaim policy, see List::retire(). */
+  void retire(item_pointer item) noexcept requires (Reclaim::ENABLED) {
+    m_shards[0].m_list.retire(item);
+  }
+
+  /** Sum of the shard sizes, approximate while the shards change. */
+  [[nodiscard]] size_t size() const noexcept {
+    size_t size{};
+
+    for (const auto& shard : m_shards) {
+      size += shard.m_list.size();
+    }
+    return size;
+  }
+
+private:
+  struct alignas(CACHE_LINE_SIZE) Shard {
+    list_type m_list;
+  };
+
+  template <size_t... I, typename... Args>
+  [[nodiscard]] static std::array<Shard, Shards> make_shards(std::index_sequence<I...>, Args... args) {
+    return {{((void) I, Shard{list_type(args...)})...}};
+  }
+
+  [[nodiscard]] item_pointer steal_from(size_t local) noexcept {
+    for (size_t i = 1; i < Shards; ++i) {
+      if (auto item = shard((local + i) & (Shards - 1)).pop_back(); item != nullptr) {
+        return item;
+      }
+    }
+
+    return nullptr;
+  }
+
+  std::array<Shard, Shards> m_shards;
+};
+
+} // namespace ut
@@ -0,0 +1,239 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "ut/lock_free_list.h"
+
+namespace ut {
+
+/**
+ * A List in a POSIX shared memory segment, shared by processes that map
+ * the segment at different addresses.
+ *
+ * The segment holds a header, the List_state (head, tail and size) and
+ * the backing array. Links are slot indices and the state holds no
+ * pointers, so each process builds its own List object over them with the
+ * base address it mapped the segment at. Items are passed between
+ * processes without copying, e.g. a producer fills a slot and
+ * push_back()s it, a consumer pop_front()s it.
+ *
+ *   // Producer
+ *   auto shared = ut::Shared_list<Msg, &Msg::node>::create("/msgs", capacity);
+ *
+ *   // Consumers
+ *   auto shared = ut::Shared_list<Msg, &Msg::node>::attach("/msgs");
+ *   auto msg = shared->list().pop_front();
+ *
+ * A process that dies in the middle of an operation can leave a node
+ * claimed for removal, an insert anchor or a moved node pinned, or an
+ * insert half done, the other processes' retry budget then runs out
+ * around it. Once the survivors are quiescent, one of
+ * them calls recover() to complete or roll back what the dead process left.
+ *
+ * @tparam T       Item type. It's shared as is, so it must be trivially
+ *                 destructible and must not hold pointers.
+ * @tparam N       Member function of T returning the embedded node.
+ * @tparam Backoff Contention policy of the list.
+ */
+template <typename T, auto N, typename Backoff = No_backoff<>>
+struct Shared_list {
+  using list_type = List<T, N, Backoff>;
+  using node_type = typename list_type::node_type;
+  using layout_type = typename node_type::layout_type;
+  using state_type = typename list_type::state_type;
+  using item_pointer = typename list_type::item_pointer;
+
+  static_assert(!list_type::slot_map::SIDE_LINKS, "Shared_list needs embedded nodes");
+  static_assert(std::is_trivially_destructible_v<T>, "Items are shared as is");
+
+  /* A lock based atomic would take a process local lock */
+  static_assert(std::atomic<typename node_type::Link_word>::is_always_lock_free, "Shared_list needs lock-free links");
+
+  /** "UTSHMv01" */
+  static constexpr uint64_t MAGIC = 0x555453484d763031;
+
+  /** Bumped when the segment layout changes. */
+  static constexpr uint32_t FORMAT_VERSION = 1;
+
+  /**
+   * Create the segment name with capacity empty slots.
+   *
+   * @return nullptr if the segment exists or can't be created.
+   */
+  [[nodiscard]] static std::unique_ptr<Shared_list> create(const char* name, size_t capacity) {
+    const auto fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+
+    if (fd == -1) {
+      return nullptr;
+    }
+
+    const auto bytes = segment_size(capacity);
+    void* addr{MAP_FAILED};
+
+    if (ftruncate(fd, static_cast<off_t>(bytes)) == 0) {
+      addr = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+
+    if (addr == MAP_FAILED) {
+      ::close(fd);
+      shm_unlink(name);
+      return nullptr;
+    }
+
+    auto segment = static_cast<std::byte*>(addr);
+    auto base = items_of(segment);
+
+    for (size_t i = 0; i < capacity; ++i) {
+      new (&base[i]) T();
+    }
+
+    new (segment + STATE_OFFSET) state_type();
+
+    /* Attach waits for the header, it's published last */
+    auto header = new (segment) Header{MAGIC, FORMAT_VERSION, layout_type::LINK_BITS, sizeof(T),
+                                       sizeof(node_type), sizeof(state_type), capacity, {}};
+
+    header->m_ready.store(1, std::memory_order_release);
+
+    return std::unique_ptr<Shared_list>(new Shared_list(fd, segment, bytes, capacity));
+  }
+
+  /**
+   * Map the existing segment name.
+   *
+   * @return nullptr if it doesn't exist, isn't initialized yet or was
+   *         created with another layout.
+   */
+  [[nodiscard]] static std::unique_ptr<Shared_list> attach(const char* name) {
+    const auto fd = shm_open(name, O_RDWR | O_CLOEXEC, 0);
+
+    if (fd == -1) {
+      return nullptr;
+    }
+
+    struct stat st{};
+
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < segment_size(0)) {
+      ::close(fd);
+      return nullptr;
+    }
+
+    const auto bytes = static_cast<size_t>(st.st_size);
+    auto addr = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+    if (addr == MAP_FAILED) {
+      ::close(fd);
+      return nullptr;
+    }
+
+    auto segment = static_cast<std::byte*>(addr);
+    const auto& header = *std::launder(reinterpret_cast<Header*>(segment));
+
+    if (header.m_ready.load(std::memory_order_acquire) != 1 || header.m_magic != MAGIC ||
+        header.m_format_version != FORMAT_VERSION || header.m_link_bits != layout_type::LINK_BITS ||
+        header.m_item_size != sizeof(T) || header.m_node_size != sizeof(node_type) ||
+        header.m_state_size != sizeof(state_type) || segment_size(header.m_capacity) != bytes) {
+      munmap(addr, bytes);
+      ::close(fd);
+      return nullptr;
+    }
+
+    return std::unique_ptr<Shared_list>(new Shared_list(fd, segment, bytes, header.m_capacity));
+  }
+
+  /** Remove the segment name, mappings stay valid until they're closed.
+   * @return false if it doesn't exist. */
+  static bool unlink(const char* name) noexcept {
+    return shm_unlink(name) == 0;
+  }
+
+  /** Unmap this process's view, the list is left as is. */
+  ~Shared_list() noexcept {
+    munmap(m_addr, m_bytes);
+    ::close(m_fd);
+  }
+
+  Shared_list(const Shared_list&) = delete;
+  Shared_list& operator=(const Shared_list&) = delete;
+
+  /** This process's view of the list. */
+  [[nodiscard]] list_type& list() noexcept {
+    return m_list;
+  }
+
+  /** The backing array as mapped in this process. */
+  [[nodiscard]] item_pointer items() noexcept {
+    return items_of(m_addr);
+  }
+
+  [[nodiscard]] size_t capacity() const noexcept {
+    return m_capacity;
+  }
+
+  /**
+   * Complete or roll back the operations of a process that died while it
+   * was using the list, see List::recover(). No other process or thread
+   * may use the list meanwhile.
+   *
+   * @return the number of elements in the list.
+   */
+  size_t recover() {
+    return m_list.recover(m_capacity);
+  }
+
+private:
+  /** Start of the segment. */
+  struct Header {
+    uint64_t m_magic;
+    uint32_t m_format_version;
+    uint32_t m_link_bits;
+    uint64_t m_item_size;
+    uint64_t m_node_size;
+    uint64_t m_state_size;
+    uint64_t m_capacity;
+
+    /** Set to 1 by create() when the segment is initialized. */
+    std::atomic<uint32_t> m_ready;
+  };
+
+  static constexpr size_t STATE_OFFSET = (sizeof(Header) + alignof(state_type) - 1) / alignof(state_type) * alignof(state_type);
+
+  /** The items start on a page boundary of any page size up to 64K. */
+  static constexpr size_t ITEMS_OFFSET = (STATE_OFFSET + sizeof(state_type) + 65535) / 65536 * 65536;
+
+  static_assert(alignof(T) <= 65536);
+
+  Shared_list(int fd, std::byte* addr, size_t bytes, size_t capacity) noexcept
+    : m_fd(fd),
+      m_addr(addr),
+      m_bytes(bytes),
+      m_capacity(capacity),
+      m_list(items_of(addr), items_of(addr) + capacity, *std::launder(reinterpret_cast<state_type*>(addr + STATE_OFFSET))) {}
+
+  [[nodiscard]] static constexpr size_t segment_size(size_t capacity) noexcept {
+    return ITEMS_OFFSET + capacity * sizeof(T);
+  }
+
+  [[nodiscard]] static item_pointer items_of(std::byte* segment) noexcept {
+    return reinterpret_cast<item_pointer>(segment + ITEMS_OFFSET);
+  }
+
+  int m_fd{-1};
+  std::byte* m_addr{};
+  size_t m_bytes{};
+  size_t m_capacity{};
+  list_type m_list;
+};
+
+} // namespace ut
@@ -0,0 +1,232 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+
+#include "ut/backoff.h"
+
+namespace ut {
+
+/**
+ * Skip list index for ut::Sorted_list, lookups start close to the target
+ * instead of at the head, O(log n) hops on average.
+ *
+ * The list itself stays the bottom level. Above it there are Levels
+ * singly linked express lanes, each slot's tower of forward links lives in
+ * a side array indexed by the slot's link, so the list's nodes are
+ * unchanged. After insert_sorted() links an item it is given a random
+ * height, 1/4 of the items reach each next level.
+ *
+ * The index only produces hints. A search moves right at a level only to
+ * a node that is still linked, compares greater than the one it is on
+ * and less than the target, so wherever it ends up the bottom level walk
+ * can resume from there: every node in front of it compares less. This is
+ * what lets the lanes be maintained without marking:
+ *
+ *  - The removals of Sorted_list, erase_key(), remove() and the pops,
+ *    unlink the tower of the element they removed. Elements removed
+ *    through list() are dropped from a lane by the first search that
+ *    runs into one. Only removals count, an element pinned as an insert
+ *    anchor keeps its place.
+ *  - A tower whose lane CAS loses a race is left shorter.
+ *  - Concurrent unlinks of neighbours can resurrect a lane link to a
+ *    removed node, searches drop it again.
+ *
+ * @tparam Levels  Number of lanes above the list.
+ * @tparam Link    Type of the stored links, must hold any slot index + 1.
+ */
+template <size_t Levels = 12, typename Link = uint32_t>
+struct Skip_index {
+  static_assert(Levels > 0 && Levels <= 16);
+
+  static constexpr size_t LEVELS = Levels;
+
+  /** Hops over elements equivalent to the one being unlinked before
+   * unlink() gives up on a lane and leaves it to the searches. */
+  static constexpr size_t MAX_EQUAL_HOPS = 64;
+
+  explicit Skip_index(size_t capacity)
+    : m_towers(std::make_unique<Tower[]>(capacity)),
+      m_capacity(capacity) {
+    assert(capacity < std::numeric_limits<Link>::max());
+  }
+
+  Skip_index(const Skip_index&) = delete;
+  Skip_index& operator=(const Skip_index&) = delete;
+
+  /** @return the last node before() accepts that the lanes lead to,
+   *          nullptr to start at the head. */
+  template <typename Sorted, typename Before>
+  [[nodiscard]] typename Sorted::node_pointer seek_hint(Sorted& sorted, const Before& before) noexcept {
+    Path path;
+
+    search(sorted, before, path);
+
+    return path[0] == HEAD ? nullptr : sorted.list().to_node(decode(path[0]));
+  }
+
+  /** Give node, just linked into the list, a tower. */
+  template <typename Sorted>
+  void link(Sorted& sorted, typename Sorted::node_pointer node) noexcept {
+    const auto height = random_height();
+
+    if (height == 0) {
+      return;
+    }
+
+    const auto& item = *sorted.list().to_item(*node);
+    const auto self = encode(sorted.list().to_link(*node));
+    auto& tower = m_towers[decode(self)];
+    Path path;
+
+    search(sorted, [&](const auto& element) { return !sorted.compare()(item, element); }, path);
+
+    tower.m_height.store(static_cast<uint8_t>(height), std::memory_order_relaxed);
+
+    for (size_t level = 0; level < height; ++level) {
+      if (path[level] == self) [[unlikely]] {
+        /* Still in this lane from an earlier life of the slot */
+        return;
+      }
+
+      auto& prev = lane(path[level], level);
+      auto next = prev.load(std::memory_order_acquire);
+
+      tower.m_next[level].store(next, std::memory_order_relaxed);
+
+      if (!prev.compare_exchange_strong(next, self, std::memory_order_release, std::memory_order_relaxed)) [[unlikely]] {
+        return;
+      }
+    }
+  }
+
+  /** Remove the tower of node, which was just removed from the list. */
+  template <typename Sorted>
+  void unlink(Sorted& sorted, typename Sorted::node_pointer node) noexcept {
+    const auto self = encode(sorted.list().to_link(*node));
+    auto& tower = m_towers[decode(self)];
+    const auto height = tower.m_height.exchange(0, std::memory_order_relaxed);
+
+    if (height == 0) {
+      return;
+    }
+
+    const auto& item = *sorted.list().to_item(*node);
+    Path path;
+
+    /* The predecessors in front of all elements equivalent to item */
+    search(sorted, [&](const auto& element) { return sorted.compare()(element, item); }, path);
+
+    for (size_t level = 0; level < height; ++level) {
+      auto at = path[level];
+
+      for (size_t hops = 0; hops < MAX_EQUAL_HOPS; ++hops) {
+        auto& prev = lane(at, level);
+        auto next = prev.load(std::memory_order_acquire);
+
+        if (next == self) {
+          (void) prev.compare_exchange_strong(next, tower.m_next[level].load(std::memory_order_acquire), std::memory_order_release, std::memory_order_relaxed);
+          break;
+        }
+
+        if (next == HEAD || sorted.compare()(item, *sorted.list().to_item(decode(next)))) {
+          break;
+        }
+        at = next;
+      }
+    }
+  }
+
+private:
+  /** Lane links are stored as slot link + 1, 0 ends a lane and, as a
+   * position, stands for the head. */
+  static constexpr Link HEAD = 0;
+
+  using Path = std::array<Link, Levels>;
+
+  struct Tower {
+    std::array<std::atomic<Link>, Levels> m_next{};
+    std::atomic<uint8_t> m_height{};
+  };
+
+  template <typename Link_type>
+  [[nodiscard]] static Link encode(Link_type link) noexcept {
+    return static_cast<Link>(link + 1);
+  }
+
+  [[nodiscard]] static uint64_t decode(Link link) noexcept {
+    assert(link != HEAD);
+    return static_cast<uint64_t>(link) - 1;
+  }
+
+  /** Levels above the list a new tower reaches, 0 to Levels. */
+  [[nodiscard]] static size_t random_height() noexcept {
+    const auto bits = uint64_t{backoff_random()} | (uint64_t{1} << (2 * Levels));
+
+    return static_cast<size_t>(std::countr_zero(bits)) / 2;
+  }
+
+  [[nodiscard]] std::atomic<Link>& lane(Link at, size_t level) noexcept {
+    assert(at == HEAD || decode(at) < m_capacity);
+    return at == HEAD ? m_head.m_next[level] : m_towers[decode(at)].m_next[level];
+  }
+
+  /**
+   * From the top lane down, move right while the next node is linked,
+   * compares greater than the current one and before() accepts it. A node
+   * that is removed or claimed for removal is dropped from the lane on the
+   * way. A pinned node is still in the list and stays, see
+   * Basic_node::is_removed_or_deleting().
+   *
+   * @param[out] path  Where the search left each lane.
+   */
+  template <typename Sorted, typename Before>
+  void search(Sorted& sorted, const Before& before, Path& path) noexcept {
+    auto& list = sorted.list();
+    Link at = HEAD;
+
+    for (size_t level = Levels; level-- > 0;) {
+      for (;;) {
+        auto& prev = lane(at, level);
+        auto next = prev.load(std::memory_order_acquire);
+
+        if (next == HEAD) {
+          break;
+        }
+
+        const auto node = list.to_node(decode(next));
+
+        if (node->is_removed_or_deleting()) [[unlikely]] {
+          /* One attempt only, a reused slot's tower can point anywhere */
+          const auto after = m_towers[decode(next)].m_next[level].load(std::memory_order_acquire);
+
+          (void) prev.compare_exchange_strong(next, after, std::memory_order_release, std::memory_order_relaxed);
+          break;
+        }
+
+        const auto& item = *list.to_item(*node);
+
+        if (!before(item) || (at != HEAD && !sorted.compare()(*list.to_item(decode(at)), item))) {
+          break;
+        }
+        at = next;
+      }
+
+      path[level] = at;
+    }
+  }
+
+  std::unique_ptr<Tower[]> m_towers;
+  size_t m_capacity{};
+
+  /** The head's tower, the start of every lane. */
+  Tower m_head{};
+};
+
+} // namespace ut
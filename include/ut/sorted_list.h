@@ -0,0 +1,381 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <utility>
+
+#include "ut/lock_free_list.h"
+
+namespace ut {
+
+/** Sorted_list without an index, every walk starts at the head. */
+struct No_index {
+  explicit No_index(size_t) noexcept {}
+
+  template <typename Sorted, typename Before>
+  [[nodiscard]] typename Sorted::node_pointer seek_hint(Sorted&, const Before&) noexcept {
+    return nullptr;
+  }
+
+  template <typename Sorted>
+  void link(Sorted&, typename Sorted::node_pointer) noexcept {}
+
+  template <typename Sorted>
+  void unlink(Sorted&, typename Sorted::node_pointer) noexcept {}
+};
+
+/**
+ * A ut::List kept in order by a comparator, for ordered timers and
+ * priority buckets.
+ *
+ * Lookups walk from the head, but a walk that runs into a node being
+ * removed doesn't start over. It backs up to the most recently visited
+ * node that is still linked, every node before that one already compared
+ * less, and continues from there. The walk remembers the last HISTORY
+ * nodes, it only goes back to the head when all of them were removed.
+ *
+ * Positions are chosen by looking at both neighbours and published with
+ * List::insert_between() / List::push_front_if(), which fail instead of
+ * linking the item elsewhere if a neighbour changed. The insert then
+ * resumes from the predecessor it had found.
+ *
+ * The list must only be modified through insert_sorted(), the removals
+ * of Sorted_list and those of the underlying list, list().push_back()
+ * etc. would break the order. Removed slots must not be reused while a walk may still hold
+ * them: with ut::Epoch_reclaim as the Reclaim policy every lookup, insert
+ * and removal holds a guard of the Epoch_domain and removed slots go to
+ * list().retire(), otherwise the caller keeps the walks out of reused
+ * slots.
+ *
+ * An Index can supply the walk with a starting point closer to the
+ * target, see ut::Skip_index. It is told about every insert_sorted() and
+ * every removal of Sorted_list: erase_key(), remove() and the pops.
+ * Removals through list(), e.g. remove_if(), keep the order but leave the
+ * index stale. The start it returns is checked like any other resume
+ * point, so an index can be stale without breaking lookups.
+ *
+ *   struct Timer_order {
+ *     bool operator()(const Timer& lhs, const Timer& rhs) const { return lhs.m_deadline < rhs.m_deadline; }
+ *     bool operator()(const Timer& lhs, uint64_t rhs) const { return lhs.m_deadline < rhs; }
+ *     bool operator()(uint64_t lhs, const Timer& rhs) const { return lhs < rhs.m_deadline; }
+ *   };
+ *
+ *   ut::Sorted_list<Timer, &Timer::node, Timer_order> timers(base, end);
+ *
+ *   timers.insert_sorted(timer);
+ *   auto next = timers.lower_bound(now);
+ *
+ * @tparam T       Item type.
+ * @tparam N       Node accessor, as for ut::List.
+ * @tparam Compare Strict weak ordering on items. lower_bound() needs
+ *                 compare(item, key), erase_key() compare(key, item) too.
+ * @tparam Backoff Contention policy, also bounds the number of restarts.
+ * @tparam Index   Lookup accelerator, No_index or ut::Skip_index.
+ * @tparam Stats   Statistics policy of the list, see ut::List.
+ * @tparam Reclaim Reclaim policy of the list, see ut::List.
+ */
+template <typename T, auto N, typename Compare = std::less<>, typename Backoff = No_backoff<>, typename Index = No_index,
+          typename Stats = No_stats, typename Reclaim = No_reclaim>
+struct Sorted_list {
+  using list_type = List<T, N, Backoff, Stats, Reclaim>;
+  using slot_map = typename list_type::slot_map;
+  using node_type = typename list_type::node_type;
+  using node_pointer = typename list_type::node_pointer;
+  using item_pointer = typename list_type::item_pointer;
+  using item_reference = typename list_type::item_reference;
+  using Link_type = typename node_type::Link_type;
+
+  /** Number of visited nodes a walk can back up to. */
+  static constexpr size_t HISTORY = 8;
+
+  Sorted_list(item_pointer base, item_pointer end, Compare compare = Compare{}, Reclaim reclaim = {}) requires (!slot_map::SIDE_LINKS)
+    : m_list(base, end, std::move(reclaim)),
+      m_compare(compare),
+      m_index(static_cast<size_t>(end - base)) {}
+
+  Sorted_list(item_pointer base, item_pointer end, node_pointer nodes, Compare compare = Compare{}, Reclaim reclaim = {})
+      requires (slot_map::SIDE_LINKS)
+    : m_list(base, end, nodes, std::move(reclaim)),
+      m_compare(compare),
+      m_index(static_cast<size_t>(end - base)) {}
+
+  /** The underlying list, for iteration, for_each() and the bulk removals. */
+  [[nodiscard]] list_type& list() noexcept {
+    return m_list;
+  }
+
+  [[nodiscard]] size_t size() const noexcept {
+    return m_list.size();
+  }
+
+  [[nodiscard]] const Compare& compare() const noexcept {
+    return m_compare;
+  }
+
+  /**
+   * Insert item after all elements that don't compare greater, elements
+   * that compare equal keep their insertion order.
+   *
+   * @return false if the retry budget was exhausted, item is not in the
+   *         list then.
+   */
+  [[nodiscard]] bool insert_sorted(item_reference item) noexcept {
+    [[maybe_unused]] const auto guard = m_list.m_reclaim.guard();
+    Backoff backoff{};
+    node_pointer from{};
+    const auto before = [&](const T& element) { return !m_compare(item, element); };
+
+    for (uint32_t retries{}; retries < Backoff::MAX_RETRIES; ++retries) {
+      if (retries > 0) [[unlikely]] {
+        backoff.pause();
+      }
+
+      const auto position = seek(before, from);
+
+      if (!position.has_value()) [[unlikely]] {
+        return false;
+      }
+
+      const auto next = position->m_next == node_type::NULL_PTR ? nullptr : m_list.to_item(position->m_next);
+
+      const auto inserted = position->m_prev == nullptr
+        ? m_list.push_front_if(next, item)
+        : m_list.insert_between(*m_list.to_item(*position->m_prev), next, item);
+
+      if (inserted) [[likely]] {
+        m_index.link(*this, &m_list.m_slots.node(item));
+        return true;
+      }
+
+      /* A neighbour changed, look again from the predecessor */
+      from = position->m_prev;
+    }
+
+    return false;
+  }
+
+  /**
+   * @return the first element that doesn't compare less than key, nullptr
+   *         if there is none or the retry budget was exhausted.
+   */
+  template <typename Key>
+  [[nodiscard]] item_pointer lower_bound(const Key& key) noexcept {
+    [[maybe_unused]] const auto guard = m_list.m_reclaim.guard();
+    const auto position = seek([&](const T& element) { return m_compare(element, key); });
+
+    if (!position.has_value() || position->m_next == node_type::NULL_PTR) {
+      return nullptr;
+    }
+    return m_list.to_item(position->m_next);
+  }
+
+  /**
+   * @return the first element equivalent to key, nullptr if there is none
+   *         or the retry budget was exhausted.
+   */
+  template <typename Key>
+  [[nodiscard]] item_pointer find_key(const Key& key) noexcept {
+    auto item = lower_bound(key);
+
+    if (item == nullptr || m_compare(key, *item)) {
+      return nullptr;
+    }
+    return item;
+  }
+
+  /**
+   * Remove the first element equivalent to key.
+   *
+   * @return the removed element, nullptr if there is none or the retry
+   *         budget was exhausted.
+   */
+  template <typename Key>
+  [[nodiscard]] item_pointer erase_key(const Key& key) noexcept {
+    [[maybe_unused]] const auto guard = m_list.m_reclaim.guard();
+    Backoff backoff{};
+    node_pointer from{};
+    const auto before = [&](const T& element) { return m_compare(element, key); };
+
+    for (uint32_t retries{}; retries < Backoff::MAX_RETRIES; ++retries) {
+      if (retries > 0) [[unlikely]] {
+        backoff.pause();
+      }
+
+      const auto position = seek(before, from);
+
+      if (!position.has_value()) [[unlikely]] {
+        return nullptr;
+      }
+
+      if (position->m_next == node_type::NULL_PTR || m_compare(key, *m_list.to_item(position->m_next))) {
+        return nullptr;
+      }
+
+      if (auto item = m_list.remove(*m_list.to_item(position->m_next)); item != nullptr) [[likely]] {
+        m_index.unlink(*this, m_list.to_node(position->m_next));
+        return item;
+      }
+
+      /* Lost the race for it, an equivalent element may follow */
+      from = position->m_prev;
+    }
+
+    return nullptr;
+  }
+
+  /**
+   * Remove item, see List::remove().
+   *
+   * @return item, nullptr if it was not in the list.
+   */
+  [[nodiscard]] item_pointer remove(item_reference item) noexcept {
+    [[maybe_unused]] const auto guard = m_list.m_reclaim.guard();
+
+    return unlinked(m_list.remove(item));
+  }
+
+  /** Remove the first element, the least, nullptr if there is none. */
+  [[nodiscard]] item_pointer pop_front() noexcept {
+    [[maybe_unused]] const auto guard = m_list.m_reclaim.guard();
+
+    return unlinked(m_list.pop_front());
+  }
+
+  /** Remove the last element, the greatest, nullptr if there is none. */
+  [[nodiscard]] item_pointer pop_back() noexcept {
+    [[maybe_unused]] const auto guard = m_list.m_reclaim.guard();
+
+    return unlinked(m_list.pop_back());
+  }
+
+  /** Remove up to n elements from the front, see List::pop_front_n(). */
+  [[nodiscard]] size_t pop_front_n(item_pointer* out, size_t n) noexcept {
+    [[maybe_unused]] const auto guard = m_list.m_reclaim.guard();
+    const auto count = m_list.pop_front_n(out, n);
+
+    for (size_t i = 0; i < count; ++i) {
+      (void) unlinked(out[i]);
+    }
+    return count;
+  }
+
+private:
+  /** Tell the index that item, if there is one, was removed. */
+  item_pointer unlinked(item_pointer item) noexcept {
+    if (item != nullptr) [[likely]] {
+      m_index.unlink(*this, &m_list.m_slots.node(*item));
+    }
+    return item;
+  }
+
+  /** m_prev is the last element before() accepted, nullptr if there is none.
+   * m_next, its successor, is the first element before() rejects. */
+  struct Position {
+    node_pointer m_prev{};
+    Link_type m_next{node_type::NULL_PTR};
+  };
+
+  /** The last HISTORY nodes a walk visited, most recent on top. */
+  struct History {
+    void push(node_pointer node) noexcept {
+      m_nodes[m_top] = node;
+      m_top = (m_top + 1) % HISTORY;
+      m_size += m_size < HISTORY;
+    }
+
+    [[nodiscard]] node_pointer pop() noexcept {
+      m_top = (m_top + HISTORY - 1) % HISTORY;
+      --m_size;
+      return m_nodes[m_top];
+    }
+
+    [[nodiscard]] bool empty() const noexcept {
+      return m_size == 0;
+    }
+
+    std::array<node_pointer, HISTORY> m_nodes{};
+    size_t m_top{};
+    size_t m_size{};
+  };
+
+  [[nodiscard]] static bool is_linked(typename node_type::Link_word links) noexcept {
+    return links != node_type::NULL_LINK && node_type::next_link(links) != node_type::DELETING_MARK;
+  }
+
+  /**
+   * Walk to the first element that before() rejects, starting after from
+   * if it's still linked, or else the index's hint. before() must hold for
+   * a prefix of the list.
+   *
+   * @return std::nullopt if the retry budget was exhausted.
+   */
+  template <typename Before>
+  [[nodiscard]] std::optional<Position> seek(const Before& before, node_pointer from = nullptr) noexcept {
+    Backoff backoff{};
+    History history{};
+
+    if (from == nullptr) {
+      from = m_index.seek_hint(*this, before);
+    }
+
+    if (from != nullptr) {
+      history.push(from);
+    }
+
+    for (uint32_t retries{}; retries < Backoff::MAX_RETRIES; ++retries) {
+      if (retries > 0) [[unlikely]] {
+        backoff.pause();
+      }
+
+      Position position{};
+
+      /* Resume after the most recent predecessor that is still linked */
+      while (!history.empty()) {
+        const auto node = history.pop();
+        const auto links = node->m_links.load(std::memory_order_acquire);
+
+        if (is_linked(links)) [[likely]] {
+          history.push(node);
+          position = {node, node_type::next_link(links)};
+          break;
+        }
+      }
+
+      if (position.m_prev == nullptr) {
+        position.m_next = m_list.m_state->m_head.load(std::memory_order_acquire);
+      }
+
+      for (;;) {
+        if (position.m_next == node_type::NULL_PTR) {
+          return position;
+        }
+
+        const auto node = m_list.to_node(position.m_next);
+        const auto links = node->m_links.load(std::memory_order_acquire);
+
+        if (!is_linked(links)) [[unlikely]] {
+          break;
+        }
+
+        if (!before(*m_list.to_item(*node))) {
+          return position;
+        }
+
+        history.push(node);
+        position = {node, node_type::next_link(links)};
+      }
+    }
+
+    return std::nullopt;
+  }
+
+  list_type m_list;
+  [[no_unique_address]] Compare m_compare{};
+  [[no_unique_address]] Index m_index;
+};
+
+} // namespace ut
@@ -0,0 +1,119 @@
+#include <benchmark/benchmark.h>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "ut/lock_free_list.h"
+#include "ut/persistent_list.h"
+
+/* Restart cost of a list of n elements: rebuilding it with push_back()
+ * vs re-attaching to a Persistent_list after a clean close and after a
+ * crash, which runs the recovery pass. */
+
+namespace {
+
+struct Record {
+  ut::Node& node() noexcept { return m_node; }
+
+  ut::Node m_node{};
+  int m_value{};
+};
+
+using Persistent = ut::Persistent_list<Record, &Record::node>;
+
+std::string file_path(size_t n) {
+  return "/tmp/ut_benchmark_10_" + std::to_string(n);
+}
+
+/* A file holding a full list of n elements */
+void create_file(size_t n) {
+  const auto path = file_path(n);
+
+  std::remove(path.c_str());
+
+  auto list = Persistent::open(path.c_str(), n);
+
+  for (size_t i = 0; i < n; ++i) {
+    list->items()[i].m_value = static_cast<int>(i);
+    (void) list->list().push_back(list->items()[i]);
+  }
+}
+
+/* Attach in a child that exits without closing the file */
+void crash(size_t n) {
+  if (const auto pid = fork(); pid == 0) {
+    auto list = Persistent::open(file_path(n).c_str(), n);
+    _exit(list == nullptr ? 1 : 0);
+  } else {
+    int status{};
+    (void) waitpid(pid, &status, 0);
+  }
+}
+
+} // anonymous namespace
+
+static void Rebuild(benchmark::State& state) {
+  const auto n = static_cast<size_t>(state.range(0));
+  auto items = std::make_unique<Record[]>(n);
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    for (size_t i = 0; i < n; ++i) {
+      items[i].m_node.invalidate();
+    }
+    state.ResumeTiming();
+
+    ut::List<Record, &Record::node> list(items.get(), items.get() + n);
+
+    for (size_t i = 0; i < n; ++i) {
+      (void) list.push_back(items[i]);
+    }
+    benchmark::DoNotOptimize(list.size());
+  }
+}
+
+static void Attach_clean(benchmark::State& state) {
+  const auto n = static_cast<size_t>(state.range(0));
+
+  create_file(n);
+
+  for (auto _ : state) {
+    auto list = Persistent::open(file_path(n).c_str(), n);
+    benchmark::DoNotOptimize(list->list().size());
+
+    /* Exclude the msync() of the close */
+    state.PauseTiming();
+    list.reset();
+    state.ResumeTiming();
+  }
+
+  std::remove(file_path(n).c_str());
+}
+
+static void Attach_recover(benchmark::State& state) {
+  const auto n = static_cast<size_t>(state.range(0));
+
+  create_file(n);
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    crash(n);
+    state.ResumeTiming();
+
+    auto list = Persistent::open(file_path(n).c_str(), n);
+    benchmark::DoNotOptimize(list->list().size());
+
+    state.PauseTiming();
+    list.reset();
+    state.ResumeTiming();
+  }
+
+  std::remove(file_path(n).c_str());
+}
+
+BENCHMARK(Rebuild)->Arg(1 << 20)->Unit(benchmark::kMillisecond);
+BENCHMARK(Attach_clean)->Arg(1 << 20)->Unit(benchmark::kMillisecond);
+BENCHMARK(Attach_recover)->Arg(1 << 20)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,147 @@
+#include <benchmark/benchmark.h>
+#include <cstring>
+#include <string>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "ut/lock_free_list.h"
+#include "ut/shared_list.h"
+
+/* Moving messages from a producer process to a consumer process, through a
+ * Unix socket vs a Shared_list. The socket copies each message twice, the
+ * list passes the slot. The argument is the number of messages. */
+
+namespace {
+
+struct Message {
+  ut::Node& node() noexcept { return m_node; }
+
+  ut::Node m_node{};
+  uint64_t m_seq{};
+  char m_payload[48]{};
+};
+
+using Shared = ut::Shared_list<Message, &Message::node>;
+
+} // anonymous namespace
+
+static void Socket(benchmark::State& state) {
+  const auto n = static_cast<size_t>(state.range(0));
+
+  for (auto _ : state) {
+    int fds[2];
+
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+      state.SkipWithError("socketpair() failed");
+      break;
+    }
+
+    if (const auto pid = fork(); pid == 0) {
+      ::close(fds[0]);
+
+      Message message{};
+
+      for (size_t i = 0; i < n; ++i) {
+        message.m_seq = i;
+        std::memset(message.m_payload, static_cast<int>(i), sizeof(message.m_payload));
+        if (write(fds[1], &message, sizeof(message)) != static_cast<ssize_t>(sizeof(message))) {
+          _exit(1);
+        }
+      }
+      _exit(0);
+    } else {
+      ::close(fds[1]);
+
+      Message message{};
+      uint64_t sum{};
+      size_t received{};
+
+      for (size_t offset = 0; received < n;) {
+        const auto r = read(fds[0], reinterpret_cast<char*>(&message) + offset, sizeof(message) - offset);
+
+        if (r <= 0) {
+          break;
+        }
+
+        offset += static_cast<size_t>(r);
+        if (offset == sizeof(message)) {
+          sum += message.m_seq;
+          offset = 0;
+          ++received;
+        }
+      }
+
+      benchmark::DoNotOptimize(sum);
+      ::close(fds[0]);
+
+      int status{};
+      (void) waitpid(pid, &status, 0);
+    }
+  }
+
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+static void Shared_list(benchmark::State& state) {
+  const auto n = static_cast<size_t>(state.range(0));
+  const auto name = "/ut_benchmark_11_" + std::to_string(getpid());
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    (void) Shared::unlink(name.c_str());
+    auto shared = Shared::create(name.c_str(), n);
+    state.ResumeTiming();
+
+    if (shared == nullptr) {
+      state.SkipWithError("Shared_list::create() failed");
+      break;
+    }
+
+    if (const auto pid = fork(); pid == 0) {
+      auto producer = Shared::attach(name.c_str());
+
+      for (size_t i = 0; producer != nullptr && i < n; ++i) {
+        auto& message = producer->items()[i];
+
+        message.m_seq = i;
+        std::memset(message.m_payload, static_cast<int>(i), sizeof(message.m_payload));
+        (void) producer->list().push_back(message);
+      }
+      _exit(0);
+    } else {
+      uint64_t sum{};
+      size_t received{};
+      bool done{};
+
+      /* A message whose push failed never arrives, stop once the
+       * producer exited and the list is empty */
+      while (received < n) {
+        if (auto message = shared->list().pop_front(); message != nullptr) {
+          sum += message->m_seq;
+          ++received;
+        } else if (!done) {
+          int status{};
+          done = waitpid(pid, &status, WNOHANG) == pid;
+        } else if (shared->list().size() == 0) {
+          break;
+        }
+      }
+
+      benchmark::DoNotOptimize(sum);
+
+      if (!done) {
+        int status{};
+        (void) waitpid(pid, &status, 0);
+      }
+    }
+  }
+
+  (void) Shared::unlink(name.c_str());
+
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+BENCHMARK(Socket)->Arg(100000)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(Shared_list)->Arg(100000)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,85 @@
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ut/lock_free_list.h"
+
+/* Cost of the stats policy: push_back/pop_front pairs on a shared list
+ * without stats and with Sharded_stats. The counters of the instrumented
+ * list are exported as benchmark counters, per operation. The argument is
+ * the number of threads. */
+
+namespace {
+
+struct Item {
+  ut::Node& node() noexcept { return m_node; }
+
+  ut::Node m_node{};
+  int m_value{};
+};
+
+constexpr size_t ITEMS_PER_THREAD = 64;
+constexpr size_t ROUNDS = 2000;
+
+template <typename Stats>
+void push_pop(benchmark::State& state) {
+  using List = ut::List<Item, &Item::node, ut::No_backoff<>, Stats>;
+
+  const auto num_threads = static_cast<size_t>(state.range(0));
+  auto items = std::make_unique<Item[]>(num_threads * ITEMS_PER_THREAD);
+  List list(items.get(), items.get() + num_threads * ITEMS_PER_THREAD);
+
+  for (auto _ : state) {
+    std::vector<std::thread> threads;
+
+    for (size_t t = 0; t < num_threads; ++t) {
+      threads.emplace_back([&, t]() {
+        for (size_t round = 0; round < ROUNDS; ++round) {
+          for (size_t i = t * ITEMS_PER_THREAD; i < (t + 1) * ITEMS_PER_THREAD; ++i) {
+            if (items[i].node().is_null()) {
+              (void) list.push_back(items[i]);
+            }
+          }
+          for (size_t i = 0; i < ITEMS_PER_THREAD; ++i) {
+            benchmark::DoNotOptimize(list.pop_front());
+          }
+        }
+      });
+    }
+
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    while (list.pop_front() != nullptr) {
+    }
+  }
+
+  const auto ops = static_cast<double>(state.iterations() * num_threads * ROUNDS * ITEMS_PER_THREAD * 2);
+
+  if constexpr (Stats::ENABLED) {
+    list.stats().for_each([&](ut::List_stat stat, uint64_t value) {
+      if (value > 0) {
+        state.counters[ut::to_string(stat)] = benchmark::Counter(static_cast<double>(value) / ops);
+      }
+    });
+  }
+
+  state.SetItemsProcessed(static_cast<int64_t>(ops));
+}
+
+} // anonymous namespace
+
+static void No_stats(benchmark::State& state) {
+  push_pop<ut::No_stats>(state);
+}
+
+static void Sharded_stats(benchmark::State& state) {
+  push_pop<ut::Sharded_stats<>>(state);
+}
+
+BENCHMARK(No_stats)->Arg(1)->Arg(4)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(Sharded_stats)->Arg(1)->Arg(4)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
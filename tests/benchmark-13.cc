@@ -0,0 +1,603 @@
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstring>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <pthread.h>
+#include <sched.h>
+#include "ut/lock_free_list.h"
+
+/* Per operation latency percentiles for realistic workload mixes, from 1 to
+ * 128 threads, pinned and unpinned:
+ *
+ *  - Queue:        push_back() and pop_front() in turns.
+ *  - Lru:          move_to_front() of a random element.
+ *  - Scan:         95% find() of a random key, 5% remove() and push_back().
+ *  - Insert_heavy: 75% push_front(), 25% pop_back().
+ *
+ * Each mix runs on a ut::List and on a std::list behind a std::mutex, the
+ * queue also on a Michael-Scott queue. Every operation is timed, p50, p99,
+ * p99.9 and max are reported in ns over all threads.
+ *
+ * Results go to benchmark-13.json unless --benchmark_out is given, for
+ * regression tracking. */
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int MAX_THREADS = 128;
+
+/* Keys in a shared list for Lru and Scan */
+constexpr size_t SHARED_KEYS = 1024;
+
+/* Keys a thread owns initially for Queue and Insert_heavy */
+constexpr size_t KEYS_PER_THREAD = 64;
+
+constexpr size_t KEYS = std::max(SHARED_KEYS, MAX_THREADS * KEYS_PER_THREAD);
+
+constexpr int NO_KEY = -1;
+
+enum class Workload { QUEUE, LRU, SCAN, INSERT_HEAVY };
+
+/** Log-linear histogram, 8 buckets per power of two, +-6% resolution. */
+struct Histogram {
+  static constexpr size_t SUB_BITS = 3;
+  static constexpr size_t SUB_BUCKETS = size_t{1} << SUB_BITS;
+  static constexpr size_t BUCKETS = 64 * SUB_BUCKETS;
+
+  [[nodiscard]] static size_t bucket(uint64_t ns) noexcept {
+    if (ns < SUB_BUCKETS) {
+      return ns;
+    }
+
+    const auto shift = static_cast<size_t>(std::bit_width(ns)) - 1 - SUB_BITS;
+
+    return (shift + 1) * SUB_BUCKETS + ((ns >> shift) - SUB_BUCKETS);
+  }
+
+  /** Largest value that falls into bucket b. */
+  [[nodiscard]] static uint64_t upper(size_t b) noexcept {
+    if (b < SUB_BUCKETS) {
+      return b;
+    }
+
+    const auto shift = b / SUB_BUCKETS - 1;
+    const auto mantissa = SUB_BUCKETS + b % SUB_BUCKETS;
+
+    return ((mantissa + 1) << shift) - 1;
+  }
+
+  void record(uint64_t ns) noexcept {
+    ++m_counts[bucket(ns)];
+    m_max = std::max(m_max, ns);
+  }
+
+  std::array<uint64_t, BUCKETS> m_counts{};
+  uint64_t m_max{};
+};
+
+/** The threads' histograms of one run, merged as they finish. */
+struct Merged_histogram {
+  void reset() noexcept {
+    for (auto& count : m_counts) {
+      count.store(0, std::memory_order_relaxed);
+    }
+    m_max.store(0, std::memory_order_relaxed);
+    m_finished.store(0, std::memory_order_relaxed);
+  }
+
+  /** @return true for the last of threads threads. */
+  [[nodiscard]] bool merge(const Histogram& histogram, int threads) noexcept {
+    for (size_t b = 0; b < Histogram::BUCKETS; ++b) {
+      if (histogram.m_counts[b] > 0) {
+        m_counts[b].fetch_add(histogram.m_counts[b], std::memory_order_relaxed);
+      }
+    }
+
+    auto max = m_max.load(std::memory_order_relaxed);
+
+    while (histogram.m_max > max && !m_max.compare_exchange_weak(max, histogram.m_max, std::memory_order_relaxed)) {
+    }
+
+    return m_finished.fetch_add(1, std::memory_order_acq_rel) + 1 == threads;
+  }
+
+  [[nodiscard]] uint64_t percentile(double p) const noexcept {
+    uint64_t total{};
+
+    for (const auto& count : m_counts) {
+      total += count.load(std::memory_order_relaxed);
+    }
+
+    const auto rank = static_cast<uint64_t>(p * static_cast<double>(total));
+    uint64_t seen{};
+
+    for (size_t b = 0; b < Histogram::BUCKETS; ++b) {
+      seen += m_counts[b].load(std::memory_order_relaxed);
+      if (seen > rank) {
+        return std::min(Histogram::upper(b), max());
+      }
+    }
+    return max();
+  }
+
+  [[nodiscard]] uint64_t max() const noexcept {
+    return m_max.load(std::memory_order_relaxed);
+  }
+
+  std::array<std::atomic<uint64_t>, Histogram::BUCKETS> m_counts{};
+  std::atomic<uint64_t> m_max{};
+  std::atomic<int> m_finished{};
+};
+
+struct Xorshift {
+  [[nodiscard]] uint32_t operator()() noexcept {
+    m_state ^= m_state << 13;
+    m_state ^= m_state >> 17;
+    m_state ^= m_state << 5;
+    return m_state;
+  }
+
+  uint32_t m_state;
+};
+
+struct Item {
+  ut::Node& node() noexcept { return m_node; }
+
+  ut::Node m_node{};
+  int m_key{};
+};
+
+/* The implementations share one interface, keys are indices into a fixed
+ * array. push_*() and pop_*() move ownership of a key between the list and
+ * the calling thread, touch() and find() don't. */
+
+struct Lock_free {
+  Lock_free()
+    : m_items(std::make_unique<Item[]>(KEYS)),
+      m_list(m_items.get(), m_items.get() + KEYS) {
+    for (size_t i = 0; i < KEYS; ++i) {
+      m_items[i].m_key = static_cast<int>(i);
+    }
+  }
+
+  [[nodiscard]] bool push_back(int key) noexcept {
+    return m_list.push_back(m_items[key]);
+  }
+
+  [[nodiscard]] bool push_front(int key) noexcept {
+    return m_list.push_front(m_items[key]);
+  }
+
+  [[nodiscard]] int pop_front() noexcept {
+    auto item = m_list.pop_front();
+    return item == nullptr ? NO_KEY : item->m_key;
+  }
+
+  [[nodiscard]] int pop_back() noexcept {
+    auto item = m_list.pop_back();
+    return item == nullptr ? NO_KEY : item->m_key;
+  }
+
+  bool touch(int key) noexcept {
+    return m_list.move_to_front(m_items[key]) == ut::Move_result::MOVED;
+  }
+
+  [[nodiscard]] bool find(int key) noexcept {
+    return m_list.find([key](const Item* item) { return item->m_key == key; }) != nullptr;
+  }
+
+  /** Remove key and append it again, if it's in the list. */
+  void requeue(int key) noexcept {
+    if (m_list.remove(m_items[key]) != nullptr) {
+      /* We own it now, don't let a failed push lose it */
+      while (!m_list.push_back(m_items[key])) {
+      }
+    }
+  }
+
+  std::unique_ptr<Item[]> m_items;
+  ut::List<Item, &Item::node> m_list;
+};
+
+struct Locked {
+  Locked()
+    : m_positions(KEYS),
+      m_linked(KEYS) {}
+
+  [[nodiscard]] bool push_back(int key) {
+    std::lock_guard lock(m_mutex);
+    m_positions[key] = m_list.insert(m_list.end(), key);
+    m_linked[key] = true;
+    return true;
+  }
+
+  [[nodiscard]] bool push_front(int key) {
+    std::lock_guard lock(m_mutex);
+    m_positions[key] = m_list.insert(m_list.begin(), key);
+    m_linked[key] = true;
+    return true;
+  }
+
+  [[nodiscard]] int pop_front() {
+    std::lock_guard lock(m_mutex);
+    return pop(m_list.begin());
+  }
+
+  [[nodiscard]] int pop_back() {
+    std::lock_guard lock(m_mutex);
+    return m_list.empty() ? NO_KEY : pop(std::prev(m_list.end()));
+  }
+
+  bool touch(int key) {
+    std::lock_guard lock(m_mutex);
+
+    if (!m_linked[key]) {
+      return false;
+    }
+    m_list.splice(m_list.begin(), m_list, m_positions[key]);
+    return true;
+  }
+
+  [[nodiscard]] bool find(int key) {
+    std::lock_guard lock(m_mutex);
+    return std::find(m_list.begin(), m_list.end(), key) != m_list.end();
+  }
+
+  void requeue(int key) {
+    std::lock_guard lock(m_mutex);
+
+    if (m_linked[key]) {
+      m_list.splice(m_list.end(), m_list, m_positions[key]);
+    }
+  }
+
+  [[nodiscard]] int pop(std::list<int>::iterator it) {
+    if (it == m_list.end()) {
+      return NO_KEY;
+    }
+
+    const auto key = *it;
+
+    m_list.erase(it);
+    m_linked[key] = false;
+    return key;
+  }
+
+  std::mutex m_mutex;
+  std::list<int> m_list;
+  std::vector<std::list<int>::iterator> m_positions;
+  std::vector<bool> m_linked;
+};
+
+/**
+ * Michael-Scott queue over a fixed node pool. Links are 32 bit indices
+ * tagged with a 32 bit counter against ABA, freed nodes go to a Treiber
+ * stack with the same tagging. Queue workload only.
+ */
+struct Ms_queue {
+  static constexpr uint32_t NIL = ~uint32_t{0};
+
+  struct Node {
+    std::atomic<uint64_t> m_next{};
+    std::atomic<uint32_t> m_free_next{};
+    std::atomic<int> m_key{};
+  };
+
+  /* One node per key plus the dummy */
+  Ms_queue()
+    : m_nodes(std::make_unique<Node[]>(KEYS + 1)) {
+    for (uint32_t i = 1; i <= KEYS; ++i) {
+      m_nodes[i].m_free_next.store(i < KEYS ? i + 1 : NIL, std::memory_order_relaxed);
+    }
+    m_nodes[0].m_next.store(pack(NIL, 0), std::memory_order_relaxed);
+    m_free.store(pack(1, 0), std::memory_order_relaxed);
+    m_head.store(pack(0, 0), std::memory_order_relaxed);
+    m_tail.store(pack(0, 0), std::memory_order_relaxed);
+  }
+
+  [[nodiscard]] static uint64_t pack(uint32_t index, uint32_t tag) noexcept {
+    return uint64_t{tag} << 32 | index;
+  }
+
+  [[nodiscard]] static uint32_t index(uint64_t link) noexcept {
+    return static_cast<uint32_t>(link);
+  }
+
+  [[nodiscard]] static uint32_t tag(uint64_t link) noexcept {
+    return static_cast<uint32_t>(link >> 32);
+  }
+
+  [[nodiscard]] bool push_back(int key) noexcept {
+    const auto node = allocate();
+
+    if (node == NIL) {
+      return false;
+    }
+
+    m_nodes[node].m_key.store(key, std::memory_order_relaxed);
+
+    const auto old_next = m_nodes[node].m_next.load(std::memory_order_relaxed);
+    m_nodes[node].m_next.store(pack(NIL, tag(old_next) + 1), std::memory_order_relaxed);
+
+    for (;;) {
+      auto tail = m_tail.load(std::memory_order_acquire);
+      auto next = m_nodes[index(tail)].m_next.load(std::memory_order_acquire);
+
+      if (tail != m_tail.load(std::memory_order_acquire)) {
+        continue;
+      }
+
+      if (index(next) == NIL) {
+        if (m_nodes[index(tail)].m_next.compare_exchange_weak(next, pack(node, tag(next) + 1), std::memory_order_release)) {
+          m_tail.compare_exchange_strong(tail, pack(node, tag(tail) + 1), std::memory_order_release);
+          return true;
+        }
+      } else {
+        m_tail.compare_exchange_weak(tail, pack(index(next), tag(tail) + 1), std::memory_order_release);
+      }
+    }
+  }
+
+  [[nodiscard]] int pop_front() noexcept {
+    for (;;) {
+      auto head = m_head.load(std::memory_order_acquire);
+      auto tail = m_tail.load(std::memory_order_acquire);
+      const auto next = m_nodes[index(head)].m_next.load(std::memory_order_acquire);
+
+      if (head != m_head.load(std::memory_order_acquire)) {
+        continue;
+      }
+
+      if (index(head) == index(tail)) {
+        if (index(next) == NIL) {
+          return NO_KEY;
+        }
+        m_tail.compare_exchange_weak(tail, pack(index(next), tag(tail) + 1), std::memory_order_release);
+      } else {
+        /* Read before the CAS, the node may be recycled after it */
+        const auto key = m_nodes[index(next)].m_key.load(std::memory_order_relaxed);
+
+        if (m_head.compare_exchange_weak(head, pack(index(next), tag(head) + 1), std::memory_order_acq_rel)) {
+          release(index(head));
+          return key;
+        }
+      }
+    }
+  }
+
+  [[nodiscard]] uint32_t allocate() noexcept {
+    auto top = m_free.load(std::memory_order_acquire);
+
+    while (index(top) != NIL) {
+      const auto next = m_nodes[index(top)].m_free_next.load(std::memory_order_relaxed);
+
+      if (m_free.compare_exchange_weak(top, pack(next, tag(top) + 1), std::memory_order_acq_rel)) {
+        return index(top);
+      }
+    }
+    return NIL;
+  }
+
+  void release(uint32_t node) noexcept {
+    auto top = m_free.load(std::memory_order_relaxed);
+
+    do {
+      m_nodes[node].m_free_next.store(index(top), std::memory_order_relaxed);
+    } while (!m_free.compare_exchange_weak(top, pack(node, tag(top) + 1), std::memory_order_release));
+  }
+
+  std::unique_ptr<Node[]> m_nodes;
+  alignas(ut::CACHE_LINE_SIZE) std::atomic<uint64_t> m_head{};
+  alignas(ut::CACHE_LINE_SIZE) std::atomic<uint64_t> m_tail{};
+  alignas(ut::CACHE_LINE_SIZE) std::atomic<uint64_t> m_free{};
+};
+
+/** Pin the calling thread to a CPU, restore its affinity on destruction. */
+struct Pin {
+  Pin(bool pin, int thread) noexcept {
+    if (!pin || pthread_getaffinity_np(pthread_self(), sizeof(m_saved), &m_saved) != 0) {
+      return;
+    }
+
+    const auto cpus = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    cpu_set_t set;
+
+    CPU_ZERO(&set);
+    CPU_SET(thread % cpus, &set);
+    m_pinned = pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+  }
+
+  ~Pin() noexcept {
+    if (m_pinned) {
+      (void) pthread_setaffinity_np(pthread_self(), sizeof(m_saved), &m_saved);
+    }
+  }
+
+  cpu_set_t m_saved{};
+  bool m_pinned{};
+};
+
+template <typename Impl, Workload W>
+void latency(benchmark::State& state) {
+  /* Shared by the threads of a run, set up by thread 0 before the start
+   * barrier of the loop and torn down after the end barrier */
+  static std::unique_ptr<Impl> impl;
+  static Merged_histogram merged;
+
+  const auto thread = state.thread_index();
+
+  if (thread == 0) {
+    impl = std::make_unique<Impl>();
+    merged.reset();
+
+    if constexpr (W == Workload::LRU || W == Workload::SCAN) {
+      for (size_t key = 0; key < SHARED_KEYS; ++key) {
+        (void) impl->push_back(static_cast<int>(key));
+      }
+    }
+  }
+
+  Pin pin(state.range(0) != 0, thread);
+  Histogram histogram;
+  Xorshift random{static_cast<uint32_t>(thread) * 2654435761u | 1};
+  uint64_t empty{};
+
+  /* Keys this thread owns, Queue and Insert_heavy */
+  std::vector<int> stash;
+
+  for (size_t i = 0; i < KEYS_PER_THREAD; ++i) {
+    stash.push_back(static_cast<int>(static_cast<size_t>(thread) * KEYS_PER_THREAD + i));
+  }
+
+  bool push{true};
+
+  for (auto _ : state) {
+    const auto r = random();
+    const auto key = static_cast<int>(r % SHARED_KEYS);
+    const auto start = Clock::now();
+
+    if constexpr (W == Workload::QUEUE || W == Workload::INSERT_HEAVY) {
+      const auto insert = W == Workload::QUEUE ? push : r % 4 != 0;
+
+      if (insert && !stash.empty()) {
+        bool pushed;
+
+        if constexpr (W == Workload::QUEUE) {
+          pushed = impl->push_back(stash.back());
+        } else {
+          pushed = impl->push_front(stash.back());
+        }
+
+        if (pushed) {
+          stash.pop_back();
+        }
+      } else {
+        int popped;
+
+        if constexpr (W == Workload::QUEUE) {
+          popped = impl->pop_front();
+        } else {
+          popped = impl->pop_back();
+        }
+
+        if (popped == NO_KEY) {
+          ++empty;
+        } else {
+          stash.push_back(popped);
+        }
+      }
+      push = !push;
+    } else if constexpr (W == Workload::LRU) {
+      benchmark::DoNotOptimize(impl->touch(key));
+    } else {
+      if (r % 100 < 95) {
+        benchmark::DoNotOptimize(impl->find(key));
+      } else {
+        impl->requeue(key);
+      }
+    }
+
+    histogram.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count()));
+  }
+
+  /* Only the last thread to merge reports, the counters of all threads are
+   * summed */
+  if (merged.merge(histogram, state.threads())) {
+    state.counters["p50_ns"] = static_cast<double>(merged.percentile(0.5));
+    state.counters["p99_ns"] = static_cast<double>(merged.percentile(0.99));
+    state.counters["p99.9_ns"] = static_cast<double>(merged.percentile(0.999));
+    state.counters["max_ns"] = static_cast<double>(merged.max());
+  }
+
+  /* Pops that found the list empty */
+  state.counters["Empty/Op"] = benchmark::Counter(static_cast<double>(empty), benchmark::Counter::kAvgIterations);
+
+  if (thread == 0) {
+    state.SetItemsProcessed(state.iterations() * state.threads());
+  }
+}
+
+} // anonymous namespace
+
+static void Queue_lock_free(benchmark::State& state) {
+  latency<Lock_free, Workload::QUEUE>(state);
+}
+
+static void Queue_locked(benchmark::State& state) {
+  latency<Locked, Workload::QUEUE>(state);
+}
+
+static void Queue_michael_scott(benchmark::State& state) {
+  latency<Ms_queue, Workload::QUEUE>(state);
+}
+
+static void Lru_lock_free(benchmark::State& state) {
+  latency<Lock_free, Workload::LRU>(state);
+}
+
+static void Lru_locked(benchmark::State& state) {
+  latency<Locked, Workload::LRU>(state);
+}
+
+static void Scan_lock_free(benchmark::State& state) {
+  latency<Lock_free, Workload::SCAN>(state);
+}
+
+static void Scan_locked(benchmark::State& state) {
+  latency<Locked, Workload::SCAN>(state);
+}
+
+static void Insert_heavy_lock_free(benchmark::State& state) {
+  latency<Lock_free, Workload::INSERT_HEAVY>(state);
+}
+
+static void Insert_heavy_locked(benchmark::State& state) {
+  latency<Locked, Workload::INSERT_HEAVY>(state);
+}
+
+#define LATENCY_BENCHMARK(name) \
+  BENCHMARK(name)->ArgName("pinned")->Arg(0)->Arg(1)->ThreadRange(1, MAX_THREADS)->UseRealTime()
+
+LATENCY_BENCHMARK(Queue_lock_free);
+LATENCY_BENCHMARK(Queue_locked);
+LATENCY_BENCHMARK(Queue_michael_scott);
+LATENCY_BENCHMARK(Lru_lock_free);
+LATENCY_BENCHMARK(Lru_locked);
+LATENCY_BENCHMARK(Scan_lock_free);
+LATENCY_BENCHMARK(Scan_locked);
+LATENCY_BENCHMARK(Insert_heavy_lock_free);
+LATENCY_BENCHMARK(Insert_heavy_locked);
+
+/* BENCHMARK_MAIN() with a JSON file report by default */
+int main(int argc, char** argv) {
+  std::vector<char*> args(argv, argv + argc);
+  std::string out("--benchmark_out=benchmark-13.json");
+  std::string format("--benchmark_out_format=json");
+
+  if (std::none_of(args.begin(), args.end(), [](const char* arg) { return std::strncmp(arg, "--benchmark_out=", 16) == 0; })) {
+    args.push_back(out.data());
+    args.push_back(format.data());
+  }
+
+  auto count = static_cast<int>(args.size());
+
+  benchmark::Initialize(&count, args.data());
+
+  if (benchmark::ReportUnrecognizedArguments(count, args.data())) {
+    return 1;
+  }
+
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
@@ -0,0 +1,83 @@
+#include <benchmark/benchmark.h>
+#include <memory>
+#include "ut/lock_free_list.h"
+
+/* Expiry sweep: remove a run of adjacent elements from the middle of a
+ * list, element by element with remove(), with erase_range() and with
+ * remove_if(). The argument is the length of the run, the list holds four
+ * times as many elements. */
+
+namespace {
+
+struct Item {
+  ut::Node& node() noexcept { return m_node; }
+
+  ut::Node m_node{};
+  int m_value{};
+};
+
+using List = ut::List<Item, &Item::node>;
+
+enum class Sweep { REMOVE, ERASE_RANGE, REMOVE_IF };
+
+template <Sweep S>
+void sweep(benchmark::State& state) {
+  const auto run = static_cast<size_t>(state.range(0));
+  const auto total = run * 4;
+  auto items = std::make_unique<Item[]>(total);
+  List list(items.get(), items.get() + total);
+
+  for (size_t i = 0; i < total; ++i) {
+    items[i].m_value = static_cast<int>(i);
+    (void) list.push_back(items[i]);
+  }
+
+  const auto first = run;
+  const auto last = run * 2 - 1;
+
+  for (auto _ : state) {
+    size_t removed{};
+
+    if constexpr (S == Sweep::REMOVE) {
+      for (auto i = first; i <= last; ++i) {
+        removed += list.remove(items[i]) != nullptr;
+      }
+    } else if constexpr (S == Sweep::ERASE_RANGE) {
+      removed = list.erase_range(items[first], items[last]);
+    } else {
+      removed = list.remove_if([&](const Item& item) {
+        return static_cast<size_t>(item.m_value) >= first && static_cast<size_t>(item.m_value) <= last;
+      });
+    }
+
+    benchmark::DoNotOptimize(removed);
+
+    state.PauseTiming();
+    for (auto i = first; i <= last; ++i) {
+      (void) list.insert_before(items[last + 1], items[i]);
+    }
+    state.ResumeTiming();
+  }
+
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * run));
+}
+
+} // anonymous namespace
+
+static void Remove(benchmark::State& state) {
+  sweep<Sweep::REMOVE>(state);
+}
+
+static void Erase_range(benchmark::State& state) {
+  sweep<Sweep::ERASE_RANGE>(state);
+}
+
+static void Remove_if(benchmark::State& state) {
+  sweep<Sweep::REMOVE_IF>(state);
+}
+
+BENCHMARK(Remove)->Arg(1000)->Arg(10000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(Erase_range)->Arg(1000)->Arg(10000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(Remove_if)->Arg(1000)->Arg(10000)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
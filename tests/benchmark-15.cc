@@ -0,0 +1,103 @@
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "ut/lock_free_list.h"
+
+/* snapshot() while writers churn the list: one reader takes snapshots of
+ * a list of the argument's length while the writer threads insert and
+ * remove elements in it. Reports snapshots taken and failed per second
+ * and the writers' throughput. Built twice, benchmark-15-epoch measures
+ * the cost of UT_LIST_SNAPSHOT_EPOCH. */
+
+namespace {
+
+struct Item {
+  ut::Node& node() noexcept { return m_node; }
+
+  ut::Node m_node{};
+  int m_value{};
+};
+
+using List = ut::List<Item, &Item::node>;
+
+constexpr size_t NUM_WRITERS = 2;
+
+void snapshot_under_writes(benchmark::State& state) {
+  const auto length = static_cast<size_t>(state.range(0));
+  const auto writers = static_cast<size_t>(state.range(1));
+  const auto capacity = length * 2;
+  auto items = std::make_unique<Item[]>(capacity);
+  List list(items.get(), items.get() + capacity);
+  std::vector<Item*> out(capacity);
+
+  /* The first half stays, writers insert the second half after it */
+  for (size_t i = 0; i < length; ++i) {
+    (void) list.push_back(items[i]);
+  }
+
+  std::atomic<bool> stop{false};
+  std::atomic<size_t> writes{0};
+  std::vector<std::thread> threads;
+
+  for (size_t t = 0; t < writers; ++t) {
+    threads.emplace_back([&, t]() {
+      size_t local{};
+
+      for (auto i = length + t; !stop.load(std::memory_order_relaxed); i += writers) {
+        if (i >= capacity) {
+          i = length + t;
+        }
+
+        auto& item = items[i];
+
+        if (item.node().is_null()) {
+          (void) list.insert_after(items[i - length], item);
+        } else {
+          (void) list.remove(item);
+        }
+        ++local;
+      }
+      writes.fetch_add(local, std::memory_order_relaxed);
+    });
+  }
+
+  size_t taken{};
+  size_t failed{};
+
+  for (auto _ : state) {
+    if (list.snapshot(out.data(), capacity).has_value()) {
+      ++taken;
+    } else {
+      ++failed;
+    }
+  }
+
+  stop.store(true, std::memory_order_relaxed);
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  state.counters["Snapshots"] = benchmark::Counter(static_cast<double>(taken), benchmark::Counter::kIsRate);
+  state.counters["Failed"] = benchmark::Counter(static_cast<double>(failed), benchmark::Counter::kIsRate);
+  state.counters["Writes"] = benchmark::Counter(static_cast<double>(writes.load()), benchmark::Counter::kIsRate);
+}
+
+} // anonymous namespace
+
+static void Snapshot(benchmark::State& state) {
+  snapshot_under_writes(state);
+}
+
+BENCHMARK(Snapshot)
+  ->ArgNames({"length", "writers"})
+  ->Args({64, 0})
+  ->Args({64, NUM_WRITERS})
+  ->Args({4096, 0})
+  ->Args({4096, NUM_WRITERS})
+  ->UseRealTime()
+  ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
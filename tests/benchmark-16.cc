@@ -0,0 +1,111 @@
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <vector>
+#include "ut/lock_free_list.h"
+
+/* Statistics pass: sum a field over every element, in list order with
+ * for_each() and in array order with for_each_unordered(), for embedded
+ * nodes and side links. Elements are linked in random order, as a list
+ * that has seen churn is. The arguments are the number of slots and how
+ * many of every 16 are in the list, a sparse array is where the vector
+ * test of side links skips the most. */
+
+namespace {
+
+struct Item {
+  ut::Node& node() noexcept { return m_node; }
+
+  ut::Node m_node{};
+  int64_t m_value{};
+};
+
+/* Same payload without the node */
+struct Payload {
+  int64_t m_value{};
+};
+
+using Embedded_list = ut::List<Item, &Item::node>;
+using Side_list = ut::List<Payload, ut::SIDE_LINKS<>>;
+
+enum class Scan { LIST_ORDER, ARRAY_ORDER };
+
+template <typename List_type, typename Item_type>
+void populate(List_type& list, Item_type* items, size_t slots, size_t live) {
+  std::vector<size_t> order(slots);
+  std::iota(order.begin(), order.end(), size_t{0});
+  std::shuffle(order.begin(), order.end(), std::mt19937_64(42));
+
+  for (auto i : order) {
+    items[i].m_value = static_cast<int64_t>(i);
+
+    if (i % 16 < live) {
+      (void) list.push_back(items[i]);
+    }
+  }
+}
+
+template <Scan S, typename List_type, typename Item_type>
+void scan(benchmark::State& state, List_type& list) {
+  for (auto _ : state) {
+    int64_t sum{};
+
+    if constexpr (S == Scan::LIST_ORDER) {
+      (void) list.for_each([&sum](Item_type& item) { sum += item.m_value; });
+    } else {
+      list.for_each_unordered([&sum](Item_type& item) { sum += item.m_value; });
+    }
+
+    benchmark::DoNotOptimize(sum);
+  }
+
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * list.size()));
+}
+
+template <Scan S>
+void embedded(benchmark::State& state) {
+  const auto slots = static_cast<size_t>(state.range(0));
+  auto items = std::make_unique<Item[]>(slots);
+  Embedded_list list(items.get(), items.get() + slots);
+
+  populate(list, items.get(), slots, static_cast<size_t>(state.range(1)));
+  scan<S, Embedded_list, Item>(state, list);
+}
+
+template <Scan S>
+void side_links(benchmark::State& state) {
+  const auto slots = static_cast<size_t>(state.range(0));
+  auto items = std::make_unique<Payload[]>(slots);
+  auto nodes = std::make_unique<ut::Node[]>(slots);
+  Side_list list(items.get(), items.get() + slots, nodes.get());
+
+  populate(list, items.get(), slots, static_cast<size_t>(state.range(1)));
+  scan<S, Side_list, Payload>(state, list);
+}
+
+} // anonymous namespace
+
+static void Embedded_for_each(benchmark::State& state) {
+  embedded<Scan::LIST_ORDER>(state);
+}
+
+static void Embedded_for_each_unordered(benchmark::State& state) {
+  embedded<Scan::ARRAY_ORDER>(state);
+}
+
+static void Side_links_for_each(benchmark::State& state) {
+  side_links<Scan::LIST_ORDER>(state);
+}
+
+static void Side_links_for_each_unordered(benchmark::State& state) {
+  side_links<Scan::ARRAY_ORDER>(state);
+}
+
+BENCHMARK(Embedded_for_each)->ArgsProduct({{1 << 12, 1 << 20}, {12, 1}})->Unit(benchmark::kMicrosecond);
+BENCHMARK(Embedded_for_each_unordered)->ArgsProduct({{1 << 12, 1 << 20}, {12, 1}})->Unit(benchmark::kMicrosecond);
+BENCHMARK(Side_links_for_each)->ArgsProduct({{1 << 12, 1 << 20}, {12, 1}})->Unit(benchmark::kMicrosecond);
+BENCHMARK(Side_links_for_each_unordered)->ArgsProduct({{1 << 12, 1 << 20}, {12, 1}})->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,125 @@
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <vector>
+#include "ut/async_find.h"
+
+/* Lookup service: one thread probes many independent lists, each lookup
+ * walks a list whose nodes are spread at random over an array much larger
+ * than the cache. A loop of find() calls takes one miss after the other,
+ * find_interleaved() runs Width async_find() lookups at once so their
+ * misses overlap. The argument is the length of each list. */
+
+namespace {
+
+struct Item {
+  ut::Node& node() noexcept { return m_node; }
+
+  ut::Node m_node{};
+  size_t m_key{};
+};
+
+using List = ut::List<Item, &Item::node>;
+
+constexpr size_t ITEMS = size_t{1} << 21;
+constexpr size_t LOOKUPS = size_t{1} << 16;
+constexpr size_t BATCH = 1024;
+
+struct Lookup {
+  List* m_list;
+  size_t m_key;
+};
+
+struct Lists {
+  explicit Lists(size_t length) : m_items(std::make_unique<Item[]>(ITEMS)) {
+    std::vector<size_t> order(ITEMS);
+    std::iota(order.begin(), order.end(), size_t{0});
+    std::mt19937_64 gen(42);
+    std::shuffle(order.begin(), order.end(), gen);
+
+    std::vector<List*> owner(ITEMS);
+
+    for (size_t i = 0; i < ITEMS; ++i) {
+      if (i % length == 0) {
+        m_lists.push_back(std::make_unique<List>(m_items.get(), m_items.get() + ITEMS));
+      }
+
+      auto& item = m_items[order[i]];
+
+      item.m_key = order[i];
+      owner[order[i]] = m_lists.back().get();
+      (void) m_lists.back()->push_back(item);
+    }
+
+    std::uniform_int_distribution<size_t> dis(0, ITEMS - 1);
+
+    for (size_t i = 0; i < LOOKUPS; ++i) {
+      const auto key = dis(gen);
+      m_lookups.push_back({owner[key], key});
+    }
+  }
+
+  std::unique_ptr<Item[]> m_items;
+  std::vector<std::unique_ptr<List>> m_lists;
+  std::vector<Lookup> m_lookups;
+};
+
+template <size_t Width>
+void lookups(benchmark::State& state) {
+  Lists lists(static_cast<size_t>(state.range(0)));
+  Item* out[BATCH];
+  size_t first{};
+  size_t found{};
+
+  for (auto _ : state) {
+    const auto batch = &lists.m_lookups[first];
+
+    if constexpr (Width == 0) {
+      for (size_t i = 0; i < BATCH; ++i) {
+        const auto key = batch[i].m_key;
+        out[i] = batch[i].m_list->find([key](const Item* item) { return item->m_key == key; });
+        found += out[i] != nullptr;
+      }
+    } else {
+      found += ut::find_interleaved<Width>(BATCH, [batch](size_t i) {
+        return batch[i].m_list->async_find([key = batch[i].m_key](const Item* item) { return item->m_key == key; });
+      }, out);
+    }
+
+    benchmark::DoNotOptimize(out);
+    first = (first + BATCH) % LOOKUPS;
+  }
+
+  if (found != state.iterations() * BATCH) {
+    state.SkipWithError("a lookup missed");
+  }
+
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * BATCH));
+}
+
+} // anonymous namespace
+
+static void Find(benchmark::State& state) {
+  lookups<0>(state);
+}
+
+static void Interleaved_4(benchmark::State& state) {
+  lookups<4>(state);
+}
+
+static void Interleaved_16(benchmark::State& state) {
+  lookups<16>(state);
+}
+
+static void Interleaved_32(benchmark::State& state) {
+  lookups<32>(state);
+}
+
+BENCHMARK(Find)->Arg(8)->Arg(64)->Unit(benchmark::kMicrosecond);
+BENCHMARK(Interleaved_4)->Arg(8)->Arg(64)->Unit(benchmark::kMicrosecond);
+BENCHMARK(Interleaved_16)->Arg(8)->Arg(64)->Unit(benchmark::kMicrosecond);
+BENCHMARK(Interleaved_32)->Arg(8)->Arg(64)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
@@ -1,12 +1,9 @@
 #include <benchmark/benchmark.h>
-#include <linux/perf_event.h>
-#include <sys/ioctl.h>
-#include <asm/unistd.h>
-#include <sys/mman.h>
 #include <thread>
 #include <vector>
 #include <random>
 #include "ut/lock_free_list.h"
+#include "perf_counters.h"
 
 namespace benchmark_utils {
 
@@ -20,91 +17,50 @@ struct Test_item {
   ut::Node m_node{};
 };
 
-class Perf_counter {
-public:
-  explicit Perf_counter(uint64_t config) {
-    perf_event_attr attr{};
-    attr.type = PERF_TYPE_HARDWARE;
-    attr.size = sizeof(perf_event_attr);
-    attr.config = config;
-    attr.disabled = 1;
-    attr.exclude_kernel = 1;
-    attr.exclude_hv = 1;
-
-    m_fd = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
-    if (m_fd < 0) {
-      throw std::runtime_error("Failed to create perf counter");
-    }
-  }
-
-  ~Perf_counter() {
-    if (m_fd >= 0) {
-      close(m_fd);
-    }
-  }
-
-  void start() {
-    ioctl(m_fd, PERF_EVENT_IOC_RESET, 0);
-    ioctl(m_fd, PERF_EVENT_IOC_ENABLE, 0);
-  }
-
-  void stop() {
-    ioctl(m_fd, PERF_EVENT_IOC_DISABLE, 0);
-  }
-
-  uint64_t read() {
-    uint64_t count{};
-    if (::read(m_fd, &count, sizeof(count)) != sizeof(count)) {
-      return 0;
-    }
-    return count;
-  }
-
-private:
-  int m_fd;
-};
-
 } // namespace benchmark_utils
 
 using namespace benchmark_utils;
 
-// Benchmark fixture
+// Benchmark fixture, parameterized on the contention backoff policy
+template <typename Backoff>
 class List_benchmark : public benchmark::Fixture {
 protected:
+  using List_type = ut::List<Test_item, &Test_item::node, Backoff>;
+
   static constexpr size_t BUFFER_SIZE = 1000000;
 
   void SetUp(const benchmark::State&) override {
     m_buffer = std::make_unique<Test_item[]>(BUFFER_SIZE);
-    m_list = std::make_unique<ut::List<Test_item, &Test_item::node>>(
+    m_list = std::make_unique<List_type>(
       m_buffer.get(),
       m_buffer.get() + BUFFER_SIZE
     );
 
-    m_cache_misses = std::make_unique<Perf_counter>(PERF_COUNT_HW_CACHE_MISSES);
-    m_branch_misses = std::make_unique<Perf_counter>(PERF_COUNT_HW_BRANCH_MISSES);
+    /* Inherited by the worker threads, they're created after it's opened */
+    m_perf = std::make_unique<Perf_counters>();
   }
 
   void TearDown(const benchmark::State&) override {
     m_buffer.reset();
     m_list.reset();
-    m_cache_misses.reset();
-    m_branch_misses.reset();
+    m_perf.reset();
   }
 
   std::unique_ptr<Test_item[]> m_buffer;
-  std::unique_ptr<ut::List<Test_item, &Test_item::node>> m_list;
-  std::unique_ptr<Perf_counter> m_cache_misses;
-  std::unique_ptr<Perf_counter> m_branch_misses;
+  std::unique_ptr<List_type> m_list;
+  std::unique_ptr<Perf_counters> m_perf;
+
+  void high_contention(benchmark::State& state);
 };
 
-BENCHMARK_DEFINE_F(List_benchmark, Mixed_workload)(benchmark::State& state) {
+BENCHMARK_TEMPLATE_DEFINE_F(List_benchmark, Mixed_workload, ut::No_backoff<>)(benchmark::State& state) {
   const int num_threads = static_cast<int>(state.range(0));
   const size_t ops_per_thread = 10000 / num_threads;
 
   for (auto _ : state) {
     state.PauseTiming();
     // Reset list
-    m_list = std::make_unique<ut::List<Test_item, &Test_item::node>>(
+    m_list = std::make_unique<List_type>(
       m_buffer.get(),
       m_buffer.get() + BUFFER_SIZE
     );
@@ -112,8 +68,7 @@ BENCHMARK_DEFINE_F(List_benchmark, Mixed_workload)(benchmark::State& state) {
     std::vector<std::thread> threads;
     state.ResumeTiming();
 
-    m_cache_misses->start();
-    m_branch_misses->start();
+    m_perf->start();
 
     // Launch worker threads
     for (int t = 0; t < num_threads; ++t) {
@@ -174,29 +129,24 @@ BENCHMARK_DEFINE_F(List_benchmark, Mixed_workload)(benchmark::State& state) {
       thread.join();
     }
 
-    m_cache_misses->stop();
-    m_branch_misses->stop();
+    m_perf->stop();
   }
 
-  state.counters["CacheMisses/Thread"] = 
-    benchmark::Counter(m_cache_misses->read() / num_threads,
-                      benchmark::Counter::kAvgIterations);
-  
-  state.counters["BranchMisses/Thread"] = 
-    benchmark::Counter(m_branch_misses->read() / num_threads,
-                      benchmark::Counter::kAvgIterations);
+  m_perf->report(state, static_cast<double>(state.iterations() * num_threads * ops_per_thread));
 
   state.SetItemsProcessed(state.iterations() * num_threads * ops_per_thread);
 }
 
-BENCHMARK_DEFINE_F(List_benchmark, High_contention)(benchmark::State& state) {
+template <typename Backoff>
+void List_benchmark<Backoff>::high_contention(benchmark::State& state) {
   const int num_threads = static_cast<int>(state.range(0));
   const size_t ops_per_thread = 10000 / num_threads;
+  std::atomic<size_t> failures{0};
 
   for (auto _ : state) {
     state.PauseTiming();
     // Reset list and initialize with contended data
-    m_list = std::make_unique<ut::List<Test_item, &Test_item::node>>(
+    m_list = std::make_unique<List_type>(
       m_buffer.get(),
       m_buffer.get() + BUFFER_SIZE
     );
@@ -214,8 +164,7 @@ BENCHMARK_DEFINE_F(List_benchmark, High_contention)(benchmark::State& state) {
     std::vector<std::thread> threads;
     state.ResumeTiming();
 
-    m_cache_misses->start();
-    m_branch_misses->start();
+    m_perf->start();
 
     // Launch worker threads
     for (int t = 0; t < num_threads; ++t) {
@@ -223,6 +172,7 @@ BENCHMARK_DEFINE_F(List_benchmark, High_contention)(benchmark::State& state) {
         std::mt19937 gen(t);
         std::uniform_int_distribution<> op_dis(0, 2);
         std::uniform_int_distribution<> pos_dis(0, 9); // Target initial elements
+        size_t local_failures{};
 
         for (size_t i = 0; i < ops_per_thread; ++i) {
           size_t index = next_index.fetch_add(1, std::memory_order_relaxed);
@@ -238,17 +188,18 @@ BENCHMARK_DEFINE_F(List_benchmark, High_contention)(benchmark::State& state) {
           if (target) {
             switch (op_dis(gen)) {
               case 0:
-                if (!m_list->insert_after(*target, m_buffer[index])) { /* contention failure */ }
+                if (!m_list->insert_after(*target, m_buffer[index])) { ++local_failures; }
                 break;
               case 1:
-                if (!m_list->insert_before(*target, m_buffer[index])) { /* contention failure */ }
+                if (!m_list->insert_before(*target, m_buffer[index])) { ++local_failures; }
                 break;
               case 2:
-                if (m_list->remove(*target) == nullptr) { /* contention failure */ }
+                if (m_list->remove(*target) == nullptr) { ++local_failures; }
                 break;
             }
           }
         }
+        failures.fetch_add(local_failures, std::memory_order_relaxed);
       });
     }
 
@@ -256,21 +207,35 @@ BENCHMARK_DEFINE_F(List_benchmark, High_contention)(benchmark::State& state) {
       thread.join();
     }
 
-    m_cache_misses->stop();
-    m_branch_misses->stop();
+    m_perf->stop();
   }
 
-  state.counters["CacheMisses/Thread"] = 
-    benchmark::Counter(m_cache_misses->read() / num_threads,
-                      benchmark::Counter::kAvgIterations);
-  
-  state.counters["BranchMisses/Thread"] = 
-    benchmark::Counter(m_branch_misses->read() / num_threads,
+  m_perf->report(state, static_cast<double>(state.iterations() * num_threads * ops_per_thread));
+
+  /* Failed insert/remove calls, a remove of an already removed target counts too */
+  state.counters["Failures/Op"] =
+    benchmark::Counter(static_cast<double>(failures.load()) / (num_threads * ops_per_thread),
                       benchmark::Counter::kAvgIterations);
 
   state.SetItemsProcessed(state.iterations() * num_threads * ops_per_thread);
 }
 
+BENCHMARK_TEMPLATE_DEFINE_F(List_benchmark, High_contention, ut::No_backoff<>)(benchmark::State& state) {
+  high_contention(state);
+}
+
+BENCHMARK_TEMPLATE_DEFINE_F(List_benchmark, High_contention_spin, ut::Spin_backoff<>)(benchmark::State& state) {
+  high_contention(state);
+}
+
+BENCHMARK_TEMPLATE_DEFINE_F(List_benchmark, High_contention_exponential, ut::Exponential_backoff<1000>)(benchmark::State& state) {
+  high_contention(state);
+}
+
+BENCHMARK_TEMPLATE_DEFINE_F(List_benchmark, High_contention_park, ut::Park_backoff<1000>)(benchmark::State& state) {
+  high_contention(state);
+}
+
 // Register benchmarks
 BENCHMARK_REGISTER_F(List_benchmark, Mixed_workload)
   ->RangeMultiplier(2)
@@ -284,5 +249,23 @@ BENCHMARK_REGISTER_F(List_benchmark, High_contention)
   ->UseRealTime()
   ->Unit(benchmark::kMillisecond);
 
+BENCHMARK_REGISTER_F(List_benchmark, High_contention_spin)
+  ->RangeMultiplier(2)
+  ->Range(1, 32)
+  ->UseRealTime()
+  ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_REGISTER_F(List_benchmark, High_contention_exponential)
+  ->RangeMultiplier(2)
+  ->Range(1, 32)
+  ->UseRealTime()
+  ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_REGISTER_F(List_benchmark, High_contention_park)
+  ->RangeMultiplier(2)
+  ->Range(1, 32)
+  ->UseRealTime()
+  ->Unit(benchmark::kMillisecond);
+
 BENCHMARK_MAIN();
 
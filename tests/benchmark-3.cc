@@ -0,0 +1,177 @@
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "ut/lock_free_list.h"
+
+/* Queue style producer/consumer benchmark, producers push_back and
+ * consumers pop_front. It's built twice, benchmark-3 uses the default
+ * padded layout and benchmark-3-packed is built with UT_LIST_PACKED_LAYOUT
+ * to measure the cost of m_head, m_tail and m_size sharing a cache line. */
+
+namespace {
+
+struct Test_item {
+  Test_item() = default;
+  explicit Test_item(int value) : m_value(value) {}
+
+  ut::Node& node() noexcept { return m_node; }
+
+  int m_value{};
+  ut::Node m_node{};
+};
+
+using List_type = ut::List<Test_item, &Test_item::node>;
+
+class Queue_benchmark : public benchmark::Fixture {
+protected:
+  static constexpr size_t BUFFER_SIZE = 1000000;
+  static constexpr size_t ITEMS_PER_PRODUCER = 20000;
+
+  void SetUp(const benchmark::State&) override {
+    m_buffer = std::make_unique<Test_item[]>(BUFFER_SIZE);
+  }
+
+  void TearDown(const benchmark::State&) override {
+    m_list.reset();
+    m_buffer.reset();
+  }
+
+  std::unique_ptr<Test_item[]> m_buffer;
+  std::unique_ptr<List_type> m_list;
+};
+
+} // anonymous namespace
+
+BENCHMARK_DEFINE_F(Queue_benchmark, Producer_consumer)(benchmark::State& state) {
+  const auto num_producers = static_cast<size_t>(state.range(0));
+  const auto num_consumers = static_cast<size_t>(state.range(1));
+  const size_t total_items = num_producers * ITEMS_PER_PRODUCER;
+
+  size_t failed_pushes{};
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    m_list = std::make_unique<List_type>(m_buffer.get(), m_buffer.get() + BUFFER_SIZE);
+    for (size_t i = 0; i < total_items; ++i) {
+      m_buffer[i] = Test_item(static_cast<int>(i));
+    }
+
+    std::atomic<size_t> consumed{0};
+    std::atomic<size_t> failed{0};
+    std::atomic<size_t> producers_done{0};
+    std::vector<std::thread> threads;
+    state.ResumeTiming();
+
+    for (size_t p = 0; p < num_producers; ++p) {
+      threads.emplace_back([&, p]() {
+        size_t local_failed{};
+
+        for (size_t i = 0; i < ITEMS_PER_PRODUCER; ++i) {
+          if (!m_list->push_back(m_buffer[p * ITEMS_PER_PRODUCER + i])) {
+            ++local_failed;
+          }
+        }
+        failed.fetch_add(local_failed, std::memory_order_relaxed);
+        producers_done.fetch_add(1, std::memory_order_release);
+      });
+    }
+
+    for (size_t c = 0; c < num_consumers; ++c) {
+      threads.emplace_back([&]() {
+        for (;;) {
+          if (m_list->pop_front() != nullptr) {
+            consumed.fetch_add(1, std::memory_order_relaxed);
+          } else if (producers_done.load(std::memory_order_acquire) == num_producers && m_list->size() == 0) {
+            break;
+          }
+        }
+      });
+    }
+
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    failed_pushes += failed.load();
+  }
+
+  state.counters["FailedPush/Op"] =
+    benchmark::Counter(static_cast<double>(failed_pushes) / total_items, benchmark::Counter::kAvgIterations);
+
+  state.SetItemsProcessed(state.iterations() * total_items);
+}
+
+/* Bulk loading, one push_back per item vs. push_back_batch */
+BENCHMARK_DEFINE_F(Queue_benchmark, Bulk_load)(benchmark::State& state) {
+  const auto batch_size = static_cast<size_t>(state.range(0));
+  const auto num_threads = static_cast<size_t>(state.range(1));
+  const size_t items_per_thread = (BUFFER_SIZE / num_threads / batch_size) * batch_size;
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    m_list = std::make_unique<List_type>(m_buffer.get(), m_buffer.get() + BUFFER_SIZE);
+    std::vector<std::thread> threads;
+    state.ResumeTiming();
+
+    for (size_t t = 0; t < num_threads; ++t) {
+      threads.emplace_back([&, t]() {
+        auto base = &m_buffer[t * items_per_thread];
+
+        for (size_t i = 0; i < items_per_thread; i += batch_size) {
+          if (batch_size == 1) {
+            (void) m_list->push_back(base[i]);
+          } else {
+            (void) m_list->push_back_batch(&base[i], &base[i + batch_size]);
+          }
+        }
+      });
+    }
+
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+
+  state.SetItemsProcessed(state.iterations() * num_threads * items_per_thread);
+}
+
+/* Draining a full list, pop_front() per item vs. pop_front_n() */
+BENCHMARK_DEFINE_F(Queue_benchmark, Drain)(benchmark::State& state) {
+  const auto drain_size = static_cast<size_t>(state.range(0));
+  constexpr size_t ITEMS = 100000;
+  std::vector<Test_item*> out(drain_size);
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    m_list = std::make_unique<List_type>(m_buffer.get(), m_buffer.get() + BUFFER_SIZE);
+    (void) m_list->push_back_batch(&m_buffer[0], &m_buffer[ITEMS]);
+    state.ResumeTiming();
+
+    if (drain_size == 1) {
+      while (m_list->pop_front() != nullptr) {
+      }
+    } else {
+      while (m_list->pop_front_n(out.data(), drain_size) > 0) {
+      }
+    }
+  }
+
+  state.SetItemsProcessed(state.iterations() * ITEMS);
+}
+
+BENCHMARK_REGISTER_F(Queue_benchmark, Drain)
+  ->Arg(1)->Arg(16)->Arg(256)
+  ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_REGISTER_F(Queue_benchmark, Bulk_load)
+  ->ArgsProduct({{1, 16, 256}, {1, 4, 16}})
+  ->UseRealTime()
+  ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_REGISTER_F(Queue_benchmark, Producer_consumer)
+  ->ArgsProduct({{1, 2, 4, 8, 16}, {1, 2, 4, 8, 16}})
+  ->UseRealTime()
+  ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
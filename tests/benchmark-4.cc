@@ -0,0 +1,80 @@
+#include <benchmark/benchmark.h>
+#include <thread>
+#include <vector>
+#include "ut/fixed_pool.h"
+
+/* Fixed_pool allocate/release throughput, the shared Treiber stack vs.
+ * per-thread caches. Each thread allocates a burst of slots and then
+ * releases them, like a producer that fills work items in batches. */
+
+namespace {
+
+struct Test_item {
+  ut::Node& node() noexcept { return m_node; }
+
+  int m_value{};
+  ut::Node m_node{};
+};
+
+using Pool_type = ut::Fixed_pool<Test_item, &Test_item::node>;
+
+constexpr size_t CAPACITY = 1 << 20;
+constexpr size_t BURST = 32;
+constexpr size_t BURSTS_PER_THREAD = 10000;
+
+template <typename Allocator>
+void run_bursts(Allocator& allocator) {
+  Test_item* items[BURST];
+
+  for (size_t b = 0; b < BURSTS_PER_THREAD; ++b) {
+    for (auto& item : items) {
+      item = allocator.allocate();
+      benchmark::DoNotOptimize(item);
+    }
+    for (auto item : items) {
+      allocator.release(item);
+    }
+  }
+}
+
+template <bool UseCache>
+void pool_bursts(benchmark::State& state) {
+  const auto num_threads = static_cast<size_t>(state.range(0));
+  Pool_type pool(CAPACITY);
+
+  for (auto _ : state) {
+    std::vector<std::thread> threads;
+
+    for (size_t t = 0; t < num_threads; ++t) {
+      threads.emplace_back([&]() {
+        if constexpr (UseCache) {
+          Pool_type::Cache cache(pool);
+          run_bursts(cache);
+        } else {
+          run_bursts(pool);
+        }
+      });
+    }
+
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+
+  state.SetItemsProcessed(state.iterations() * num_threads * BURSTS_PER_THREAD * BURST);
+}
+
+} // anonymous namespace
+
+static void Shared_stack(benchmark::State& state) {
+  pool_bursts<false>(state);
+}
+
+static void Thread_cache(benchmark::State& state) {
+  pool_bursts<true>(state);
+}
+
+BENCHMARK(Shared_stack)->RangeMultiplier(2)->Range(1, 16)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(Thread_cache)->RangeMultiplier(2)->Range(1, 16)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
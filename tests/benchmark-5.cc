@@ -0,0 +1,85 @@
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <vector>
+#include "ut/lock_free_list.h"
+
+/* Traversal cost of 200 byte records, links embedded in the record vs. a
+ * dense side array of links. The list order is a random permutation of the
+ * array so that each hop is a cache miss. The argument selects the walk,
+ * 0 for the iterators and 1 for for_each(). */
+
+namespace {
+
+constexpr size_t NUM_ITEMS = 1 << 18;
+constexpr size_t PAYLOAD_SIZE = 200;
+
+struct Embedded_record {
+  ut::Node& node() noexcept { return m_node; }
+
+  ut::Node m_node{};
+  int m_key{};
+  char m_payload[PAYLOAD_SIZE - sizeof(ut::Node) - sizeof(int)]{};
+};
+
+struct Record {
+  int m_key{};
+  char m_payload[PAYLOAD_SIZE - sizeof(int)]{};
+};
+
+std::vector<size_t> random_order() {
+  std::vector<size_t> order(NUM_ITEMS);
+  std::iota(order.begin(), order.end(), 0);
+  std::shuffle(order.begin(), order.end(), std::mt19937_64(42));
+  return order;
+}
+
+template <typename List_type, typename Item>
+void traverse(benchmark::State& state, List_type& list, Item* items) {
+  const auto order = random_order();
+
+  for (auto i : order) {
+    items[i].m_key = static_cast<int>(i);
+    (void) list.push_back(items[i]);
+  }
+
+  for (auto _ : state) {
+    /* Link chasing only, the payload is never dereferenced */
+    size_t count{};
+
+    if (state.range(0) == 0) {
+      for (auto it = list.begin(); it != list.end(); ++it) {
+        ++count;
+      }
+    } else {
+      (void) list.for_each([&count](Item&) { ++count; });
+    }
+    benchmark::DoNotOptimize(count);
+  }
+
+  state.SetItemsProcessed(state.iterations() * NUM_ITEMS);
+}
+
+} // anonymous namespace
+
+static void Embedded_links(benchmark::State& state) {
+  auto items = std::make_unique<Embedded_record[]>(NUM_ITEMS);
+  ut::List<Embedded_record, &Embedded_record::node> list(items.get(), items.get() + NUM_ITEMS);
+
+  traverse(state, list, items.get());
+}
+
+static void Side_links(benchmark::State& state) {
+  auto items = std::make_unique<Record[]>(NUM_ITEMS);
+  auto nodes = std::make_unique<ut::Node[]>(NUM_ITEMS);
+  ut::List<Record, ut::SIDE_LINKS<>> list(items.get(), items.get() + NUM_ITEMS, nodes.get());
+
+  traverse(state, list, items.get());
+}
+
+BENCHMARK(Embedded_links)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+BENCHMARK(Side_links)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
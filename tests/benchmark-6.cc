@@ -0,0 +1,89 @@
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <vector>
+#include "ut/lock_free_list.h"
+
+/* find() vs. find_prefetched() on a 1M element list whose order is a
+ * random permutation of the backing array, every hop is a cache miss. The
+ * key the predicate reads is on a different cache line than the node. */
+
+namespace {
+
+constexpr size_t NUM_ITEMS = 1 << 20;
+
+struct Record {
+  ut::Node& node() noexcept { return m_node; }
+
+  ut::Node m_node{};
+  char m_pad[ut::CACHE_LINE_SIZE - sizeof(ut::Node)]{};
+  int m_key{};
+  char m_payload[ut::CACHE_LINE_SIZE - sizeof(int)]{};
+};
+
+using List_type = ut::List<Record, &Record::node>;
+
+class Find_benchmark : public benchmark::Fixture {
+protected:
+  void SetUp(const benchmark::State&) override {
+    if (m_items != nullptr) {
+      return;
+    }
+
+    std::vector<size_t> order(NUM_ITEMS);
+    std::iota(order.begin(), order.end(), 0);
+    std::shuffle(order.begin(), order.end(), std::mt19937_64(42));
+
+    m_items = std::make_unique<Record[]>(NUM_ITEMS);
+    m_list = std::make_unique<List_type>(m_items.get(), m_items.get() + NUM_ITEMS);
+
+    for (auto i : order) {
+      m_items[i].m_key = static_cast<int>(i);
+      (void) m_list->push_back(m_items[i]);
+    }
+  }
+
+  /* Search for a key that isn't there, a full traversal */
+  static bool missing(const Record* record) noexcept {
+    return record->m_key < 0;
+  }
+
+  static inline std::unique_ptr<Record[]> m_items;
+  static inline std::unique_ptr<List_type> m_list;
+};
+
+} // anonymous namespace
+
+BENCHMARK_DEFINE_F(Find_benchmark, Find)(benchmark::State& state) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(m_list->find(missing));
+  }
+  state.SetItemsProcessed(state.iterations() * NUM_ITEMS);
+}
+
+template <size_t Distance>
+void find_prefetched(benchmark::State& state, List_type& list, bool (*predicate)(const Record*)) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(list.find_prefetched<Distance>(predicate));
+  }
+  state.SetItemsProcessed(state.iterations() * NUM_ITEMS);
+}
+
+BENCHMARK_DEFINE_F(Find_benchmark, Find_prefetched)(benchmark::State& state) {
+  switch (state.range(0)) {
+    case 1: find_prefetched<1>(state, *m_list, missing); break;
+    case 2: find_prefetched<2>(state, *m_list, missing); break;
+    case 4: find_prefetched<4>(state, *m_list, missing); break;
+    case 8: find_prefetched<8>(state, *m_list, missing); break;
+    default: find_prefetched<16>(state, *m_list, missing); break;
+  }
+}
+
+BENCHMARK_REGISTER_F(Find_benchmark, Find)->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(Find_benchmark, Find_prefetched)
+  ->Arg(1)->Arg(2)->Arg(4)->Arg(8)->Arg(16)
+  ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
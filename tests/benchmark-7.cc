@@ -0,0 +1,118 @@
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <vector>
+#include "ut/lock_free_list.h"
+#include "ut/skip_index.h"
+#include "ut/sorted_list.h"
+
+/* Point lookups in an ordered list: a linear find(), Sorted_list's
+ * lower_bound() without an index and with a Skip_index. The argument is
+ * the number of elements. Keys are assigned to the slots in a random
+ * order, so that walking the list in key order misses the cache. */
+
+namespace {
+
+struct Record {
+  ut::Node& node() noexcept { return m_node; }
+
+  ut::Node m_node{};
+  int m_key{};
+};
+
+struct Key_order {
+  bool operator()(const Record& lhs, const Record& rhs) const noexcept { return lhs.m_key < rhs.m_key; }
+  bool operator()(const Record& lhs, int rhs) const noexcept { return lhs.m_key < rhs; }
+  bool operator()(int lhs, const Record& rhs) const noexcept { return lhs < rhs.m_key; }
+};
+
+using Sorted_type = ut::Sorted_list<Record, &Record::node, Key_order>;
+using Indexed_type = ut::Sorted_list<Record, &Record::node, Key_order, ut::No_backoff<>, ut::Skip_index<>>;
+
+/* Slot of each key, a random permutation */
+std::vector<size_t> random_slots(size_t n) {
+  std::vector<size_t> slots(n);
+  std::iota(slots.begin(), slots.end(), 0);
+  std::shuffle(slots.begin(), slots.end(), std::mt19937_64(42));
+  return slots;
+}
+
+/* Keys to look up, spread over the whole list */
+std::vector<int> random_keys(size_t n) {
+  std::vector<int> keys(1024);
+  std::mt19937_64 rng(7);
+  std::uniform_int_distribution<int> dist(0, static_cast<int>(n) - 1);
+  std::generate(keys.begin(), keys.end(), [&]() { return dist(rng); });
+  return keys;
+}
+
+template <typename Lookup>
+void lookups(benchmark::State& state, size_t n, Lookup lookup) {
+  const auto keys = random_keys(n);
+  size_t i{};
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(lookup(keys[i++ % keys.size()]));
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+
+} // anonymous namespace
+
+static void Find(benchmark::State& state) {
+  const auto n = static_cast<size_t>(state.range(0));
+  auto items = std::make_unique<Record[]>(n);
+  Sorted_type list(items.get(), items.get() + n);
+  const auto slots = random_slots(n);
+
+  /* Appending in key order keeps the list sorted */
+  for (size_t key = 0; key < n; ++key) {
+    items[slots[key]].m_key = static_cast<int>(key);
+    (void) list.list().push_back(items[slots[key]]);
+  }
+
+  lookups(state, n, [&](int key) {
+    return list.list().find([key](const Record* record) { return record->m_key >= key; });
+  });
+}
+
+static void Lower_bound(benchmark::State& state) {
+  const auto n = static_cast<size_t>(state.range(0));
+  auto items = std::make_unique<Record[]>(n);
+  Sorted_type list(items.get(), items.get() + n);
+  const auto slots = random_slots(n);
+
+  for (size_t key = 0; key < n; ++key) {
+    items[slots[key]].m_key = static_cast<int>(key);
+    (void) list.list().push_back(items[slots[key]]);
+  }
+
+  lookups(state, n, [&](int key) { return list.lower_bound(key); });
+}
+
+static void Skip_index_lower_bound(benchmark::State& state) {
+  const auto n = static_cast<size_t>(state.range(0));
+  auto items = std::make_unique<Record[]>(n);
+  Indexed_type list(items.get(), items.get() + n);
+  const auto slots = random_slots(n);
+
+  for (size_t key = 0; key < n; ++key) {
+    items[slots[key]].m_key = static_cast<int>(key);
+  }
+
+  /* The towers are built by insert_sorted(), slot order is random key order */
+  for (size_t slot = 0; slot < n; ++slot) {
+    (void) list.insert_sorted(items[slot]);
+  }
+
+  lookups(state, n, [&](int key) { return list.lower_bound(key); });
+}
+
+BENCHMARK(Find)->Arg(10000)->Arg(100000)->Arg(1000000);
+BENCHMARK(Lower_bound)->Arg(10000)->Arg(100000)->Arg(1000000);
+BENCHMARK(Skip_index_lower_bound)->Arg(10000)->Arg(100000)->Arg(1000000);
+
+BENCHMARK_MAIN();
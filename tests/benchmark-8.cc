@@ -0,0 +1,110 @@
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "ut/lock_free_list.h"
+#include "ut/sharded_list.h"
+
+/* Task pool style push/pop, every thread pushes a burst of its own items
+ * and pops as many back, possibly other threads' items. Shared_list puts all threads on one ut::List,
+ * Sharded_list gives each thread its own shard and steals when it runs
+ * dry. The argument is the number of threads. */
+
+namespace {
+
+struct Task {
+  ut::Node& node() noexcept { return m_node; }
+
+  ut::Node m_node{};
+  int m_value{};
+};
+
+constexpr size_t BURST = 64;
+constexpr size_t BURSTS_PER_THREAD = 500;
+
+template <typename Pool>
+void push_pop(benchmark::State& state, Pool& pool, Task* tasks) {
+  const auto num_threads = static_cast<size_t>(state.range(0));
+  std::atomic<size_t> pushes{0};
+
+  for (auto _ : state) {
+    std::vector<std::thread> threads;
+
+    for (size_t t = 0; t < num_threads; ++t) {
+      threads.emplace_back([&, t]() {
+        /* The items this thread holds, each item is held or pooled once */
+        std::vector<Task*> held;
+
+        for (size_t j = 0; j < BURST; ++j) {
+          held.push_back(&tasks[t * BURST + j]);
+        }
+
+        for (size_t i = 0; i < BURSTS_PER_THREAD; ++i) {
+          size_t kept{};
+
+          for (auto task : held) {
+            if (!pool.push(*task)) {
+              held[kept++] = task;
+            }
+          }
+          pushes.fetch_add(held.size() - kept, std::memory_order_relaxed);
+          held.resize(kept);
+
+          while (held.size() < BURST) {
+            auto task = pool.pop();
+
+            if (task == nullptr) {
+              break;
+            }
+            held.push_back(task);
+          }
+        }
+      });
+    }
+
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    /* Drain leftovers so that every iteration starts empty */
+    while (pool.pop() != nullptr) {
+    }
+  }
+
+  /* Successful pushes, a failed push under contention doesn't count */
+  state.SetItemsProcessed(static_cast<int64_t>(pushes.load()));
+}
+
+/* A single List with the Sharded_list interface */
+struct Shared_pool {
+  Shared_pool(Task* base, Task* end) : m_list(base, end) {}
+
+  bool push(Task& task) noexcept { return m_list.push_front(task); }
+  Task* pop() noexcept { return m_list.pop_front(); }
+
+  ut::List<Task, &Task::node> m_list;
+};
+
+} // anonymous namespace
+
+static void Shared_list(benchmark::State& state) {
+  const auto n = static_cast<size_t>(state.range(0)) * BURST;
+  auto tasks = std::make_unique<Task[]>(n);
+  Shared_pool pool(tasks.get(), tasks.get() + n);
+
+  push_pop(state, pool, tasks.get());
+}
+
+static void Sharded_list(benchmark::State& state) {
+  const auto n = static_cast<size_t>(state.range(0)) * BURST;
+  auto tasks = std::make_unique<Task[]>(n);
+  ut::Sharded_list<Task, &Task::node> pool(tasks.get(), tasks.get() + n);
+
+  push_pop(state, pool, tasks.get());
+}
+
+BENCHMARK(Shared_list)->RangeMultiplier(2)->Range(1, 16)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(Sharded_list)->RangeMultiplier(2)->Range(1, 16)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,92 @@
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <vector>
+#include "ut/lock_free_list.h"
+#include "ut/mapped.h"
+
+/* Traversal of a list whose links jump around the backing array, over a
+ * heap array and over List::create_mapped() arrays with and without huge
+ * pages. The argument is the number of elements, the arrays are far
+ * larger than the TLB reach with 4K pages. */
+
+namespace {
+
+struct Record {
+  ut::Node& node() noexcept { return m_node; }
+
+  ut::Node m_node{};
+  int m_value{};
+  char m_payload[52]{};
+};
+
+using List_type = ut::List<Record, &Record::node>;
+
+/* Link the slots in a random order */
+void link_shuffled(List_type& list, Record* base, size_t n) {
+  std::vector<size_t> slots(n);
+  std::iota(slots.begin(), slots.end(), 0);
+  std::shuffle(slots.begin(), slots.end(), std::mt19937_64(42));
+
+  for (auto slot : slots) {
+    base[slot].m_value = static_cast<int>(slot);
+    (void) list.push_back(base[slot]);
+  }
+}
+
+void traverse(benchmark::State& state, List_type& list, size_t n) {
+  for (auto _ : state) {
+    int64_t sum{};
+
+    (void) list.for_each([&](const Record& record) { sum += record.m_value; });
+    benchmark::DoNotOptimize(sum);
+  }
+
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+void mapped(benchmark::State& state, ut::Map_flags flags) {
+  const auto n = static_cast<size_t>(state.range(0));
+  auto list = List_type::create_mapped(n, flags);
+
+  link_shuffled(*list, list->items().base(), n);
+  traverse(state, *list, n);
+}
+
+} // anonymous namespace
+
+static void Heap(benchmark::State& state) {
+  const auto n = static_cast<size_t>(state.range(0));
+  auto items = std::make_unique<Record[]>(n);
+  List_type list(items.get(), items.get() + n);
+
+  link_shuffled(list, items.get(), n);
+  traverse(state, list, n);
+}
+
+static void Mapped(benchmark::State& state) {
+  mapped(state, ut::Map_flags::NONE);
+}
+
+static void Mapped_huge_pages(benchmark::State& state) {
+  mapped(state, ut::Map_flags::HUGE_PAGES | ut::Map_flags::POPULATE);
+}
+
+/* Cost of creating the list, page faults included */
+static void Create(benchmark::State& state) {
+  const auto n = static_cast<size_t>(state.range(0));
+  const auto flags = state.range(1) == 0 ? ut::Map_flags::NONE : ut::Map_flags::HUGE_PAGES | ut::Map_flags::POPULATE;
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(List_type::create_mapped(n, flags));
+  }
+}
+
+BENCHMARK(Heap)->Arg(1 << 20)->Arg(1 << 22)->Unit(benchmark::kMillisecond);
+BENCHMARK(Mapped)->Arg(1 << 20)->Arg(1 << 22)->Unit(benchmark::kMillisecond);
+BENCHMARK(Mapped_huge_pages)->Arg(1 << 20)->Arg(1 << 22)->Unit(benchmark::kMillisecond);
+BENCHMARK(Create)->ArgsProduct({{1 << 20, 1 << 22}, {0, 1}})->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -1,11 +1,28 @@
 #include <gtest/gtest.h>
+#include <array>
 #include <thread>
 #include <vector>
 #include <random>
 #include <atomic>
 #include <algorithm>
-
+#include <numeric>
+#include <string>
+#include <chrono>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "ut/async_find.h"
+#include "ut/epoch.h"
+#include "ut/fixed_pool.h"
+#include "ut/indexed_list.h"
+#include "ut/list_group.h"
+#include "ut/list_queue.h"
 #include "ut/lock_free_list.h"
+#include "ut/sharded_list.h"
+#include "ut/shared_list.h"
+#include "ut/skip_index.h"
+#include "ut/sorted_list.h"
 
 struct Test_item {
   Test_item()  {
@@ -779,3 +796,1556 @@ TEST_F(Multi_threaded_list_test, concurrent_remove_and_insert_stress) {
       << "BUG DETECTED: Forward and backward traversals found different nodes!";
 }
 
+
+template <typename Backoff>
+static void concurrent_push_pop_with_backoff() {
+  constexpr size_t NUM_THREADS = 8;
+  constexpr size_t ITEMS_PER_THREAD = 1000;
+  using List_type = ut::List<Test_item, &Test_item::node, Backoff>;
+
+  auto buffer = std::make_unique<Test_item[]>(NUM_THREADS * ITEMS_PER_THREAD);
+  List_type list(buffer.get(), buffer.get() + NUM_THREADS * ITEMS_PER_THREAD);
+
+  std::atomic<size_t> pushed{0};
+  std::atomic<size_t> popped{0};
+  std::vector<std::thread> threads;
+
+  for (size_t t = 0; t < NUM_THREADS; ++t) {
+    threads.emplace_back([&, t]() {
+      for (size_t i = 0; i < ITEMS_PER_THREAD; ++i) {
+        size_t index = t * ITEMS_PER_THREAD + i;
+        buffer[index] = Test_item(static_cast<int>(index));
+
+        if (list.push_back(buffer[index])) {
+          pushed.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (i % 2 == 0 && list.pop_front() != nullptr) {
+          popped.fetch_add(1, std::memory_order_relaxed);
+        }
+      }
+    });
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  size_t count = 0;
+  for (const auto& item : list) {
+    (void)item;
+    count++;
+  }
+
+  EXPECT_EQ(count, pushed.load() - popped.load());
+  EXPECT_EQ(list.size(), count);
+}
+
+TEST(Backoff_policy_test, concurrent_push_pop) {
+  concurrent_push_pop_with_backoff<ut::No_backoff<>>();
+  concurrent_push_pop_with_backoff<ut::Spin_backoff<>>();
+  concurrent_push_pop_with_backoff<ut::Exponential_backoff<1000>>();
+  concurrent_push_pop_with_backoff<ut::Park_backoff<1000, 4, 16>>();
+}
+
+TEST_F(Multi_threaded_list_test, concurrent_push_back_batch) {
+  constexpr size_t NUM_THREADS = 8;
+  constexpr size_t BATCHES_PER_THREAD = 100;
+  constexpr size_t BATCH_SIZE = 16;
+  std::atomic<size_t> pushed{0};
+
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < NUM_THREADS; ++t) {
+    threads.emplace_back([&, t]() {
+      for (size_t b = 0; b < BATCHES_PER_THREAD; ++b) {
+        size_t base = (t * BATCHES_PER_THREAD + b) * BATCH_SIZE;
+        for (size_t i = 0; i < BATCH_SIZE; ++i) {
+          m_buffer[base + i] = Test_item(static_cast<int>(base + i));
+        }
+        if (m_list->push_back_batch(&m_buffer[base], &m_buffer[base + BATCH_SIZE])) {
+          pushed.fetch_add(BATCH_SIZE, std::memory_order_relaxed);
+        }
+      }
+    });
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  /* Every batch must appear contiguously and in order */
+  std::vector<int> values;
+  for (const auto& item : *m_list) {
+    values.push_back(item.m_value);
+  }
+
+  ASSERT_EQ(values.size(), pushed.load());
+  ASSERT_EQ(m_list->size(), pushed.load());
+  for (size_t i = 0; i < values.size(); i += BATCH_SIZE) {
+    ASSERT_EQ(values[i] % BATCH_SIZE, 0);
+    for (size_t j = 1; j < BATCH_SIZE; ++j) {
+      ASSERT_EQ(values[i + j], values[i] + static_cast<int>(j));
+    }
+  }
+}
+
+TEST_F(Multi_threaded_list_test, concurrent_pop_front_n) {
+  constexpr size_t NUM_PRODUCERS = 4;
+  constexpr size_t NUM_CONSUMERS = 4;
+  constexpr size_t ITEMS_PER_PRODUCER = 2000;
+  constexpr size_t DRAIN_SIZE = 32;
+  std::atomic<size_t> pushed{0};
+  std::atomic<size_t> producers_done{0};
+  std::vector<std::vector<int>> consumed(NUM_CONSUMERS);
+
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < NUM_PRODUCERS; ++t) {
+    threads.emplace_back([&, t]() {
+      for (size_t i = 0; i < ITEMS_PER_PRODUCER; ++i) {
+        size_t index = t * ITEMS_PER_PRODUCER + i;
+        m_buffer[index] = Test_item(static_cast<int>(index));
+        if (m_list->push_back(m_buffer[index])) {
+          pushed.fetch_add(1, std::memory_order_relaxed);
+        }
+      }
+      producers_done.fetch_add(1, std::memory_order_release);
+    });
+  }
+
+  for (size_t c = 0; c < NUM_CONSUMERS; ++c) {
+    threads.emplace_back([&, c]() {
+      Test_item* out[DRAIN_SIZE];
+
+      for (;;) {
+        const auto n = m_list->pop_front_n(out, DRAIN_SIZE);
+
+        for (size_t i = 0; i < n; ++i) {
+          consumed[c].push_back(out[i]->m_value);
+        }
+
+        if (n == 0 && producers_done.load(std::memory_order_acquire) == NUM_PRODUCERS && m_list->size() == 0) {
+          break;
+        }
+      }
+    });
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  /* No duplicates, and every consumer sees each producer's items in order */
+  std::vector<bool> seen(NUM_PRODUCERS * ITEMS_PER_PRODUCER, false);
+  size_t total{};
+
+  for (const auto& values : consumed) {
+    std::vector<int> last(NUM_PRODUCERS, -1);
+
+    for (auto value : values) {
+      ASSERT_FALSE(seen[value]) << "Duplicate value: " << value;
+      seen[value] = true;
+
+      const auto producer = value / ITEMS_PER_PRODUCER;
+      ASSERT_GT(value, last[producer]);
+      last[producer] = value;
+    }
+    total += values.size();
+  }
+
+  EXPECT_EQ(total, pushed.load());
+}
+
+TEST_F(Multi_threaded_list_test, concurrent_pop_front_n_and_remove) {
+  constexpr size_t NUM_ITEMS = 256;
+  constexpr size_t NUM_INSERTS = 2000;
+  constexpr size_t NUM_REMOVERS = 2;
+  constexpr size_t REMOVES_PER_THREAD = 20000;
+  constexpr size_t DRAIN_SIZE = 16;
+  constexpr size_t CAPACITY = NUM_ITEMS + NUM_INSERTS;
+  std::vector<std::atomic<bool>> listed(CAPACITY);
+  std::atomic<bool> done{false};
+
+  for (size_t i = 0; i < NUM_ITEMS; ++i) {
+    m_buffer[i] = Test_item(static_cast<int>(i));
+    listed[i].store(true);
+    ASSERT_TRUE(m_list->push_back(m_buffer[i]));
+  }
+
+  /* Every element that leaves the list was in it, and goes back in at the
+   * back, so the run pop_front_n() detaches keeps being removed from and
+   * inserted into in the middle */
+  auto relist = [&](Test_item* item) {
+    EXPECT_TRUE(listed[item->m_value].exchange(false)) << "Removed twice: " << item->m_value;
+    listed[item->m_value].store(true);
+    EXPECT_TRUE(m_list->push_back(*item));
+  };
+
+  std::vector<std::thread> threads;
+
+  threads.emplace_back([&]() {
+    Test_item* out[DRAIN_SIZE];
+
+    while (!done.load(std::memory_order_relaxed)) {
+      const auto n = m_list->pop_front_n(out, DRAIN_SIZE);
+
+      for (size_t i = 0; i < n; ++i) {
+        relist(out[i]);
+      }
+    }
+  });
+
+  for (size_t t = 0; t < NUM_REMOVERS; ++t) {
+    threads.emplace_back([&, t]() {
+      std::mt19937 rng(static_cast<unsigned>(t));
+
+      for (size_t i = 0; i < REMOVES_PER_THREAD; ++i) {
+        if (auto item = m_list->remove(m_buffer[rng() % NUM_ITEMS]); item != nullptr) {
+          relist(item);
+        }
+      }
+    });
+  }
+
+  threads.emplace_back([&]() {
+    std::mt19937 rng(~0U);
+
+    for (size_t i = NUM_ITEMS; i < CAPACITY; ++i) {
+      m_buffer[i] = Test_item(static_cast<int>(i));
+      listed[i].store(true);
+
+      if (!m_list->insert_after(m_buffer[rng() % NUM_ITEMS], m_buffer[i])) {
+        listed[i].store(false);
+      }
+    }
+  });
+
+  for (size_t t = 1; t < threads.size(); ++t) {
+    threads[t].join();
+  }
+  done.store(true, std::memory_order_relaxed);
+  threads[0].join();
+
+  /* Linked both ways, no cycle, and exactly the listed elements */
+  size_t expected{};
+  for (const auto& flag : listed) {
+    expected += flag.load();
+  }
+
+  size_t forward{};
+  for (auto it = m_list->begin(); it != m_list->end() && forward <= CAPACITY; ++it) {
+    ASSERT_TRUE(listed[it->m_value].load()) << "Unexpected value: " << it->m_value;
+    ++forward;
+  }
+
+  size_t backward{};
+  for (auto it = m_list->rbegin(); it != m_list->rend() && backward <= CAPACITY; ++it) {
+    ++backward;
+  }
+
+  EXPECT_EQ(forward, expected);
+  EXPECT_EQ(backward, forward);
+  EXPECT_EQ(m_list->size(), forward);
+}
+
+TEST_F(Multi_threaded_list_test, concurrent_remove_if) {
+  constexpr int NUM_ITEMS = 20000;
+  constexpr int NUM_SWEEPERS = 2;
+  constexpr int NUM_INSERTERS = 2;
+  constexpr int INSERTS_PER_THREAD = 2000;
+
+  /* Even values expire in runs of 8, the inserters add odd values in the
+   * middle of the list */
+  const auto expired = [](const Test_item& item) {
+    return item.m_value % 2 == 0 && (item.m_value / 2) % 16 < 8;
+  };
+
+  for (int i = 0; i < NUM_ITEMS; ++i) {
+    m_buffer[i] = Test_item(i * 2);
+    ASSERT_TRUE(m_list->push_back(m_buffer[i]));
+  }
+
+  std::atomic<size_t> removed{0};
+  std::atomic<size_t> inserted{0};
+  std::vector<std::thread> threads;
+
+  for (int t = 0; t < NUM_SWEEPERS; ++t) {
+    threads.emplace_back([&]() {
+      removed.fetch_add(m_list->remove_if(expired), std::memory_order_relaxed);
+    });
+  }
+
+  for (int t = 0; t < NUM_INSERTERS; ++t) {
+    threads.emplace_back([&, t]() {
+      std::mt19937 gen(t);
+      std::uniform_int_distribution<> dis(NUM_ITEMS / 4, NUM_ITEMS - NUM_ITEMS / 4);
+
+      for (int i = 0; i < INSERTS_PER_THREAD; ++i) {
+        const auto index = NUM_ITEMS + t * INSERTS_PER_THREAD + i;
+        auto& target = m_buffer[dis(gen)];
+
+        m_buffer[index] = Test_item(index * 2 + 1);
+        if (!expired(target) && m_list->insert_after(target, m_buffer[index])) {
+          inserted.fetch_add(1, std::memory_order_relaxed);
+        }
+      }
+    });
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  /* A sweep that stopped early leaves matches behind, finish quiescent */
+  removed.fetch_add(m_list->remove_if(expired));
+
+  std::vector<bool> seen(BUFFER_SIZE, false);
+  size_t count{};
+
+  for (const auto& item : *m_list) {
+    ASSERT_FALSE(expired(item)) << "Expired value left: " << item.m_value;
+    ASSERT_FALSE(seen[item.m_value / 2]) << "Duplicate value: " << item.m_value;
+    seen[item.m_value / 2] = true;
+    ++count;
+  }
+
+  EXPECT_EQ(removed.load(), NUM_ITEMS / 2);
+  EXPECT_EQ(count, NUM_ITEMS - NUM_ITEMS / 2 + inserted.load());
+  EXPECT_EQ(m_list->size(), count);
+}
+
+TEST_F(Multi_threaded_list_test, concurrent_snapshot) {
+  constexpr int NUM_EVEN = 256;
+  constexpr int NUM_WRITERS = 3;
+  constexpr int OPS_PER_WRITER = 20000;
+  constexpr size_t CAPACITY = NUM_EVEN * 2;
+
+  /* Evens stay, writers insert the odd value v after v - 1 and remove it
+   * again, so every state of the list is ascending and has all evens */
+  for (int i = 0; i < NUM_EVEN; ++i) {
+    m_buffer[i * 2] = Test_item(i * 2);
+    ASSERT_TRUE(m_list->push_back(m_buffer[i * 2]));
+  }
+
+  std::atomic<int> writers_done{0};
+  std::vector<std::thread> threads;
+
+  for (int t = 0; t < NUM_WRITERS; ++t) {
+    threads.emplace_back([&, t]() {
+      std::mt19937 gen(t);
+      std::uniform_int_distribution<> dis(0, NUM_EVEN / NUM_WRITERS - 1);
+
+      for (int i = 0; i < OPS_PER_WRITER; ++i) {
+        /* Each writer owns the odd slots it uses */
+        const auto odd = (dis(gen) * NUM_WRITERS + t) * 2 + 1;
+
+        if (m_buffer[odd].m_node.is_null()) {
+          m_buffer[odd].m_value = odd;
+          (void) m_list->insert_after(m_buffer[odd - 1], m_buffer[odd]);
+        } else {
+          (void) m_list->remove(m_buffer[odd]);
+        }
+      }
+      writers_done.fetch_add(1, std::memory_order_release);
+    });
+  }
+
+  size_t snapshots{};
+  std::vector<Test_item*> out(CAPACITY);
+
+  while (writers_done.load(std::memory_order_acquire) < NUM_WRITERS || snapshots == 0) {
+    const auto count = m_list->snapshot(out.data(), CAPACITY);
+
+    if (!count.has_value()) {
+      std::this_thread::yield();
+      continue;
+    }
+
+    ++snapshots;
+
+    int evens{};
+    int last{-1};
+
+    for (size_t i = 0; i < *count; ++i) {
+      ASSERT_GT(out[i]->m_value, last);
+      last = out[i]->m_value;
+      evens += last % 2 == 0;
+    }
+    ASSERT_EQ(evens, NUM_EVEN);
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_GT(snapshots, 0);
+}
+
+TEST_F(Multi_threaded_list_test, concurrent_async_find) {
+  constexpr int NUM_EVEN = 256;
+  constexpr int NUM_WRITERS = 3;
+  constexpr int OPS_PER_WRITER = 20000;
+  constexpr size_t LOOKUPS = 64;
+
+  /* Evens stay, writers insert and remove odds after them, interleaved
+   * lookups of evens always find them */
+  for (int i = 0; i < NUM_EVEN; ++i) {
+    m_buffer[i * 2] = Test_item(i * 2);
+    ASSERT_TRUE(m_list->push_back(m_buffer[i * 2]));
+  }
+
+  std::atomic<int> writers_done{0};
+  std::vector<std::thread> threads;
+
+  for (int t = 0; t < NUM_WRITERS; ++t) {
+    threads.emplace_back([&, t]() {
+      std::mt19937 gen(t);
+      std::uniform_int_distribution<> dis(0, NUM_EVEN / NUM_WRITERS - 1);
+
+      for (int i = 0; i < OPS_PER_WRITER; ++i) {
+        const auto odd = (dis(gen) * NUM_WRITERS + t) * 2 + 1;
+
+        if (m_buffer[odd].m_node.is_null()) {
+          m_buffer[odd].m_value = odd;
+          (void) m_list->insert_after(m_buffer[odd - 1], m_buffer[odd]);
+        } else {
+          (void) m_list->remove(m_buffer[odd]);
+        }
+      }
+      writers_done.fetch_add(1, std::memory_order_release);
+    });
+  }
+
+  std::mt19937 gen(NUM_WRITERS);
+  std::uniform_int_distribution<> dis(0, NUM_EVEN - 1);
+  size_t batches{};
+  std::array<int, LOOKUPS> keys{};
+  std::array<Test_item*, LOOKUPS> out{};
+
+  while (writers_done.load(std::memory_order_acquire) < NUM_WRITERS || batches == 0) {
+    for (auto& key : keys) {
+      key = dis(gen) * 2;
+    }
+
+    const auto found = ut::find_interleaved<8>(LOOKUPS, [&](size_t i) {
+      return m_list->async_find([key = keys[i]](const Test_item* item) { return item->m_value == key; });
+    }, out.data());
+
+    /* A lookup can only miss if it ran out of restarts */
+    for (size_t i = 0; i < LOOKUPS; ++i) {
+      ASSERT_TRUE(out[i] == nullptr || out[i] == &m_buffer[keys[i]]);
+    }
+    ASSERT_GT(found, 0);
+    ++batches;
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(ut::find_interleaved(LOOKUPS, [&](size_t i) {
+    return m_list->async_find([key = keys[i]](const Test_item* item) { return item->m_value == key; });
+  }, out.data()), LOOKUPS);
+}
+
+TEST(Side_links_mt_test, concurrent_for_each_unordered) {
+  constexpr int NUM_EVEN = 513;
+  constexpr int NUM_WRITERS = 3;
+  constexpr int OPS_PER_WRITER = 20000;
+  constexpr size_t CAPACITY = NUM_EVEN * 2;
+
+  auto items = std::make_unique<Test_item[]>(CAPACITY);
+  auto nodes = std::make_unique<ut::Node[]>(CAPACITY);
+  ut::List<Test_item, ut::SIDE_LINKS<>> list(items.get(), items.get() + CAPACITY, nodes.get());
+
+  /* Evens stay, writers churn the odd slots, every scan sees all evens in
+   * array order */
+  for (int i = 0; i < static_cast<int>(CAPACITY); ++i) {
+    items[i].m_value = i;
+
+    if (i % 2 == 0) {
+      ASSERT_TRUE(list.push_front(items[i]));
+    }
+  }
+
+  std::atomic<int> writers_done{0};
+  std::vector<std::thread> threads;
+
+  for (int t = 0; t < NUM_WRITERS; ++t) {
+    threads.emplace_back([&, t]() {
+      std::mt19937 gen(t);
+      std::uniform_int_distribution<> dis(0, NUM_EVEN / NUM_WRITERS - 1);
+
+      for (int i = 0; i < OPS_PER_WRITER; ++i) {
+        const auto odd = (dis(gen) * NUM_WRITERS + t) * 2 + 1;
+
+        if (nodes[odd].is_null()) {
+          (void) list.push_back(items[odd]);
+        } else {
+          (void) list.remove(items[odd]);
+        }
+      }
+      writers_done.fetch_add(1, std::memory_order_release);
+    });
+  }
+
+  size_t scans{};
+
+  while (writers_done.load(std::memory_order_acquire) < NUM_WRITERS || scans == 0) {
+    int evens{};
+    int last{-1};
+    bool ascending{true};
+
+    list.for_each_unordered([&](Test_item& item) {
+      ascending = ascending && item.m_value > last;
+      last = item.m_value;
+      evens += last % 2 == 0;
+    });
+
+    ASSERT_TRUE(ascending);
+    ASSERT_EQ(evens, NUM_EVEN);
+    ++scans;
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  size_t live{};
+  list.for_each_unordered([&live](Test_item&) { ++live; });
+  EXPECT_EQ(live, list.size());
+}
+
+TEST(List_group_mt_test, concurrent_transfers) {
+  constexpr size_t NUM_ITEMS = 2000;
+  constexpr size_t NUM_LISTS = 3;
+  constexpr size_t NUM_THREADS = 4;
+  constexpr size_t OPS_PER_THREAD = 20000;
+
+  auto buffer = std::make_unique<Test_item[]>(NUM_ITEMS);
+  ut::List_group<Test_item, &Test_item::node, NUM_LISTS, ut::Exponential_backoff<1000>> group(buffer.get(), buffer.get() + NUM_ITEMS);
+  using Group = decltype(group);
+
+  for (size_t i = 0; i < NUM_ITEMS; ++i) {
+    auto item = group.allocate();
+    ASSERT_NE(item, nullptr);
+    item->m_value = static_cast<int>(item - buffer.get());
+    ASSERT_TRUE(group.push_back(i % NUM_LISTS, *item));
+  }
+
+  /* Transfers between random lists, and pops that push the item back. A
+   * pop races with transfers of the end node into another list. */
+  std::vector<std::thread> threads;
+
+  for (size_t t = 0; t < NUM_THREADS; ++t) {
+    threads.emplace_back([&, t]() {
+      std::mt19937 rng(static_cast<unsigned>(t));
+
+      for (size_t i = 0; i < OPS_PER_THREAD; ++i) {
+        if (i % 64 == 0) {
+          const auto id = rng() % NUM_LISTS;
+
+          if (auto item = group.pop_front(id); item != nullptr) {
+            while (!group.push_back(rng() % NUM_LISTS, *item)) {
+              std::this_thread::yield();
+            }
+          }
+          continue;
+        }
+
+        auto& item = buffer[rng() % NUM_ITEMS];
+        const auto from = group.membership(item);
+
+        /* A transfer that became a removal leaves the item to us */
+        if (from < NUM_LISTS && group.transfer(item, from, rng() % NUM_LISTS, rng() % 2 == 0) == ut::Move_result::REMOVED) {
+          while (!group.push_back(rng() % NUM_LISTS, item)) {
+            std::this_thread::yield();
+          }
+        }
+      }
+    });
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  /* No item lost or duplicated, and each is where the group says */
+  std::vector<bool> seen(NUM_ITEMS, false);
+  size_t total{};
+
+  for (size_t id = 0; id < NUM_LISTS; ++id) {
+    size_t count{};
+
+    for (const auto& item : group.list(id)) {
+      ASSERT_FALSE(seen[item.m_value]) << "Duplicate value: " << item.m_value;
+      seen[item.m_value] = true;
+      EXPECT_EQ(group.membership(item), id);
+      ++count;
+    }
+    EXPECT_EQ(count, group.list(id).size());
+    total += count;
+  }
+
+  EXPECT_EQ(total, NUM_ITEMS);
+  for (size_t i = 0; i < NUM_ITEMS; ++i) {
+    EXPECT_NE(group.membership(buffer[i]), Group::MOVING);
+  }
+}
+
+TEST(Fixed_pool_test, concurrent_allocate_release) {
+  using Pool = ut::Fixed_pool<Test_item, &Test_item::node>;
+  constexpr size_t NUM_THREADS = 8;
+  constexpr size_t CAPACITY = 4 * Pool::CACHE_SIZE;
+  constexpr size_t ITERATIONS = 20000;
+
+  Pool pool(CAPACITY);
+  std::vector<std::atomic<bool>> in_use(CAPACITY);
+
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < NUM_THREADS; ++t) {
+    threads.emplace_back([&, t]() {
+      Pool::Cache cache(pool);
+      std::vector<Test_item*> held;
+      std::mt19937 rng(static_cast<unsigned>(t));
+
+      for (size_t i = 0; i < ITERATIONS; ++i) {
+        /* Half the threads use the shared stack directly */
+        const bool use_cache = t % 2 == 0;
+
+        if (held.size() < 16 && rng() % 2 == 0) {
+          auto item = use_cache ? cache.allocate() : pool.allocate();
+
+          if (item != nullptr) {
+            bool expected{false};
+            ASSERT_TRUE(in_use[item - pool.base()].compare_exchange_strong(expected, true))
+              << "Slot handed out twice: " << item - pool.base();
+            held.push_back(item);
+          }
+        } else if (!held.empty()) {
+          auto item = held.back();
+
+          held.pop_back();
+          in_use[item - pool.base()].store(false);
+          if (use_cache) {
+            cache.release(item);
+          } else {
+            pool.release(item);
+          }
+        }
+      }
+
+      for (auto item : held) {
+        in_use[item - pool.base()].store(false);
+        pool.release(item);
+      }
+    });
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  /* All slots are back in the pool */
+  size_t count{};
+  while (pool.allocate() != nullptr) {
+    ++count;
+  }
+  EXPECT_EQ(count, CAPACITY);
+}
+
+TEST(Epoch_domain_test, recycled_slots_stay_in_their_list) {
+  using Pool = ut::Fixed_pool<Test_item, &Test_item::node>;
+  using Domain = ut::Epoch_domain<Pool>;
+  using List_type = ut::List<Test_item, &Test_item::node>;
+  constexpr size_t NUM_WRITERS = 4;
+  constexpr size_t NUM_READERS = 4;
+  constexpr size_t ITEMS_PER_LIST = 256;
+  constexpr size_t ITERATIONS = 20000;
+
+  Pool pool(8192);
+  Domain domain(pool);
+  List_type lists[2] = {{pool.base(), pool.end()}, {pool.base(), pool.end()}};
+
+  {
+    Domain::Participant participant(domain);
+
+    for (int l = 0; l < 2; ++l) {
+      for (size_t i = 0; i < ITEMS_PER_LIST; ++i) {
+        auto item = participant.allocate();
+        item->m_value = l;
+        ASSERT_TRUE(lists[l].push_back(*item));
+      }
+    }
+  }
+
+  /* Slots move between the two lists, tagged with the list they're in.
+   * A reader that stays pinned must never see a slot from the other list. */
+  std::atomic<size_t> writers_done{0};
+  std::atomic<size_t> mismatches{0};
+  std::vector<std::thread> threads;
+
+  for (size_t t = 0; t < NUM_WRITERS; ++t) {
+    threads.emplace_back([&, t]() {
+      Domain::Participant participant(domain);
+      std::mt19937 rng(static_cast<unsigned>(t));
+
+      for (size_t i = 0; i < ITERATIONS; ++i) {
+        participant.retire(lists[rng() % 2].pop_front());
+
+        if (auto item = participant.allocate(); item != nullptr) {
+          const auto l = static_cast<int>(rng() % 2);
+
+          item->m_value = l;
+          if (!lists[l].push_back(*item)) {
+            participant.retire(item);
+          }
+        }
+      }
+      writers_done.fetch_add(1, std::memory_order_release);
+    });
+  }
+
+  for (size_t t = 0; t < NUM_READERS; ++t) {
+    threads.emplace_back([&, t]() {
+      Domain::Participant participant(domain);
+      int l = static_cast<int>(t % 2);
+
+      while (writers_done.load(std::memory_order_acquire) < NUM_WRITERS) {
+        auto guard = participant.pin();
+
+        try {
+          for (const auto& item : lists[l]) {
+            if (item.m_value != l) {
+              mismatches.fetch_add(1, std::memory_order_relaxed);
+            }
+          }
+        } catch (const ut::Iterator_invalidated&) {
+          /* Expected under heavy modification */
+        }
+        l ^= 1;
+      }
+    });
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(mismatches.load(), 0);
+}
+
+TEST(Epoch_domain_test, reclaim_policy_keeps_recycled_slots_in_their_list) {
+  using Pool = ut::Fixed_pool<Test_item, &Test_item::node>;
+  using Domain = ut::Epoch_domain<Pool>;
+  using Reclaim = ut::Epoch_reclaim<Domain>;
+  using List_type = ut::List<Test_item, &Test_item::node, ut::No_backoff<>, ut::No_stats, Reclaim>;
+  constexpr size_t NUM_WRITERS = 4;
+  constexpr size_t NUM_READERS = 4;
+  constexpr size_t ITEMS_PER_LIST = 256;
+  constexpr size_t ITERATIONS = 20000;
+
+  Pool pool(8192);
+  Domain domain(pool);
+  List_type lists[2] = {{pool.base(), pool.end(), Reclaim(domain)}, {pool.base(), pool.end(), Reclaim(domain)}};
+
+  {
+    Domain::Participant participant(domain);
+
+    for (int l = 0; l < 2; ++l) {
+      for (size_t i = 0; i < ITEMS_PER_LIST; ++i) {
+        auto item = participant.allocate();
+        item->m_value = l;
+        ASSERT_TRUE(lists[l].push_back(*item));
+      }
+    }
+  }
+
+  /* As above, but the lists pin the domain themselves: no guards */
+  std::atomic<size_t> writers_done{0};
+  std::atomic<size_t> mismatches{0};
+  std::vector<std::thread> threads;
+
+  for (size_t t = 0; t < NUM_WRITERS; ++t) {
+    threads.emplace_back([&, t]() {
+      Domain::Participant participant(domain);
+      std::mt19937 rng(static_cast<unsigned>(t));
+
+      for (size_t i = 0; i < ITERATIONS; ++i) {
+        auto& list = lists[rng() % 2];
+
+        list.retire(list.pop_front());
+
+        if (auto item = participant.allocate(); item != nullptr) {
+          const auto l = static_cast<int>(rng() % 2);
+
+          item->m_value = l;
+          if (!lists[l].push_back(*item)) {
+            lists[l].retire(item);
+          }
+        }
+      }
+      writers_done.fetch_add(1, std::memory_order_release);
+    });
+  }
+
+  for (size_t t = 0; t < NUM_READERS; ++t) {
+    threads.emplace_back([&, t]() {
+      Domain::Participant participant(domain);
+      int l = static_cast<int>(t % 2);
+
+      while (writers_done.load(std::memory_order_acquire) < NUM_WRITERS) {
+        try {
+          for (const auto& item : lists[l]) {
+            if (item.m_value != l) {
+              mismatches.fetch_add(1, std::memory_order_relaxed);
+            }
+          }
+        } catch (const ut::Iterator_invalidated&) {
+          /* Expected under heavy modification */
+        }
+
+        (void) lists[l].visit_until([&](const Test_item& item) {
+          if (item.m_value != l) {
+            mismatches.fetch_add(1, std::memory_order_relaxed);
+          }
+          return false;
+        });
+        l ^= 1;
+      }
+    });
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(mismatches.load(), 0);
+}
+
+TEST_F(Multi_threaded_list_test, concurrent_find_prefetched) {
+  constexpr size_t NUM_STABLE = 1000;
+  constexpr size_t NUM_WRITERS = 4;
+  constexpr size_t NUM_READERS = 4;
+  constexpr size_t ITEMS_PER_WRITER = 2000;
+  std::atomic<size_t> writers_done{0};
+  std::atomic<size_t> found{0};
+
+  for (size_t i = 0; i < NUM_STABLE; ++i) {
+    m_buffer[i] = Test_item(static_cast<int>(i));
+    ASSERT_TRUE(m_list->push_back(m_buffer[i]));
+  }
+
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < NUM_WRITERS; ++t) {
+    threads.emplace_back([&, t]() {
+      for (size_t i = 0; i < ITEMS_PER_WRITER; ++i) {
+        auto& item = m_buffer[NUM_STABLE + t * ITEMS_PER_WRITER + i];
+
+        item.m_value = -1;
+        if (m_list->push_back(item)) {
+          (void) m_list->remove(item);
+        }
+      }
+      writers_done.fetch_add(1, std::memory_order_release);
+    });
+  }
+
+  for (size_t t = 0; t < NUM_READERS; ++t) {
+    threads.emplace_back([&, t]() {
+      std::mt19937 rng(static_cast<unsigned>(t));
+
+      while (writers_done.load(std::memory_order_acquire) < NUM_WRITERS) {
+        const auto target = static_cast<int>(rng() % NUM_STABLE);
+        auto item = m_list->find_prefetched<8>([target](const Test_item* item) {
+          return item->m_value == target;
+        });
+
+        /* nullptr is allowed once the retry budget runs out */
+        if (item != nullptr) {
+          EXPECT_EQ(item, &m_buffer[target]);
+          found.fetch_add(1, std::memory_order_relaxed);
+        }
+      }
+    });
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (size_t i = 0; i < NUM_STABLE; ++i) {
+    const auto target = static_cast<int>(i);
+    EXPECT_EQ(m_list->find_prefetched([target](const Test_item* item) { return item->m_value == target; }), &m_buffer[i]);
+  }
+}
+
+TEST_F(Multi_threaded_list_test, concurrent_for_each) {
+  constexpr size_t NUM_ITEMS = 20000;
+  constexpr size_t NUM_WRITERS = 4;
+  constexpr size_t NUM_READERS = 4;
+  std::atomic<size_t> next_odd{0};
+  std::atomic<size_t> writers_done{0};
+
+  for (size_t i = 0; i < NUM_ITEMS; ++i) {
+    m_buffer[i] = Test_item(static_cast<int>(i));
+    ASSERT_TRUE(m_list->push_back(m_buffer[i]));
+  }
+
+  /* Writers remove the odd elements, the even ones stay */
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < NUM_WRITERS; ++t) {
+    threads.emplace_back([&]() {
+      for (;;) {
+        const auto i = 2 * next_odd.fetch_add(1, std::memory_order_relaxed) + 1;
+
+        if (i >= NUM_ITEMS) {
+          break;
+        }
+        (void) m_list->remove(m_buffer[i]);
+      }
+      writers_done.fetch_add(1, std::memory_order_release);
+    });
+  }
+
+  for (size_t t = 0; t < NUM_READERS; ++t) {
+    threads.emplace_back([&]() {
+      do {
+        int last{-1};
+        size_t evens{};
+        bool ordered{true};
+
+        const auto complete = m_list->for_each([&](const Test_item& item) {
+          ordered = ordered && item.m_value > last;
+          last = item.m_value;
+          evens += item.m_value % 2 == 0;
+        });
+
+        /* Never a duplicate or out of order, and a complete walk sees every even element */
+        EXPECT_TRUE(ordered);
+        if (complete) {
+          EXPECT_EQ(evens, NUM_ITEMS / 2);
+        }
+      } while (writers_done.load(std::memory_order_acquire) < NUM_WRITERS);
+    });
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+TEST_F(Multi_threaded_list_test, concurrent_walks_and_inserts) {
+  constexpr int NUM_ANCHORS = 8;
+  constexpr size_t NUM_WRITERS = 4;
+  constexpr size_t INSERTS_PER_WRITER = 20000;
+  std::atomic<size_t> inserted{0};
+  std::atomic<size_t> writers_done{0};
+
+  for (int i = 0; i < NUM_ANCHORS; ++i) {
+    m_buffer[i] = Test_item(i);
+    ASSERT_TRUE(m_list->push_back(m_buffer[i]));
+  }
+
+  /* Writers insert next to the anchors, which are pinned meanwhile. Every
+   * reader must go through a pinned anchor as through any other. */
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < NUM_WRITERS; ++t) {
+    threads.emplace_back([&, t]() {
+      std::mt19937 rng(static_cast<unsigned>(t));
+
+      for (size_t i = 0; i < INSERTS_PER_WRITER; ++i) {
+        const auto index = NUM_ANCHORS + t * INSERTS_PER_WRITER + i;
+        auto& anchor = m_buffer[rng() % NUM_ANCHORS];
+
+        m_buffer[index] = Test_item(static_cast<int>(index));
+
+        if (i % 2 == 0 ? m_list->insert_before(anchor, m_buffer[index]) : m_list->insert_after(anchor, m_buffer[index])) {
+          inserted.fetch_add(1, std::memory_order_relaxed);
+        }
+      }
+      writers_done.fetch_add(1, std::memory_order_release);
+    });
+  }
+
+  /* Number of anchors seen, -1 if one was missed or out of order */
+  const auto anchors_in_order = [&](auto first, auto last, int from, int step) {
+    int seen{};
+
+    for (; first != last; ++first) {
+      if (first->m_value < NUM_ANCHORS) {
+        if (first->m_value != from + seen * step) {
+          return -1;
+        }
+        ++seen;
+      }
+    }
+    return seen;
+  };
+
+  threads.emplace_back([&]() {
+    do {
+      EXPECT_EQ(anchors_in_order(m_list->begin(), m_list->end(), 0, 1), NUM_ANCHORS);
+      EXPECT_EQ(anchors_in_order(m_list->rbegin(), m_list->rend(), NUM_ANCHORS - 1, -1), NUM_ANCHORS);
+    } while (writers_done.load(std::memory_order_acquire) < NUM_WRITERS);
+  });
+
+  threads.emplace_back([&]() {
+    do {
+      int anchors{};
+      int last{-1};
+      bool ordered{true};
+
+      const auto complete = m_list->for_each([&](const Test_item& item) {
+        if (item.m_value < NUM_ANCHORS) {
+          ordered = ordered && item.m_value > last;
+          last = item.m_value;
+          ++anchors;
+        }
+      });
+
+      EXPECT_TRUE(ordered);
+      if (complete) {
+        EXPECT_EQ(anchors, NUM_ANCHORS);
+      }
+
+      anchors = 0;
+      m_list->for_each_unordered([&](const Test_item& item) { anchors += item.m_value < NUM_ANCHORS; });
+      EXPECT_EQ(anchors, NUM_ANCHORS);
+
+      EXPECT_NE(m_list->find([&](const Test_item* item) { return item->m_value == NUM_ANCHORS - 1; }), nullptr);
+    } while (writers_done.load(std::memory_order_acquire) < NUM_WRITERS);
+  });
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(m_list->size(), NUM_ANCHORS + inserted.load());
+  EXPECT_EQ(anchors_in_order(m_list->begin(), m_list->end(), 0, 1), NUM_ANCHORS);
+  EXPECT_EQ(static_cast<size_t>(std::distance(m_list->begin(), m_list->end())), NUM_ANCHORS + inserted.load());
+
+  /* Most inserts must get through, this is not a zero failure test */
+  EXPECT_GT(inserted.load(), NUM_WRITERS * INSERTS_PER_WRITER * 9 / 10);
+}
+
+struct Value_order {
+  bool operator()(const Test_item& lhs, const Test_item& rhs) const noexcept { return lhs.m_value < rhs.m_value; }
+  bool operator()(const Test_item& lhs, int rhs) const noexcept { return lhs.m_value < rhs; }
+  bool operator()(int lhs, const Test_item& rhs) const noexcept { return lhs < rhs.m_value; }
+};
+
+/* Threads insert_sorted() distinct values and erase_key() some of them,
+ * the list must end up strictly ordered with the right elements. */
+template <typename Sorted>
+void sorted_insert_and_erase(Test_item* buffer, size_t buffer_size) {
+  constexpr size_t NUM_THREADS = 4;
+  constexpr size_t ITEMS_PER_THREAD = 500;
+  constexpr size_t NUM_ITEMS = NUM_THREADS * ITEMS_PER_THREAD;
+  Sorted list(buffer, buffer + buffer_size);
+
+  std::vector<int> values(NUM_ITEMS);
+  std::iota(values.begin(), values.end(), 0);
+  std::shuffle(values.begin(), values.end(), std::mt19937(7));
+
+  for (size_t i = 0; i < NUM_ITEMS; ++i) {
+    buffer[i] = Test_item(values[i]);
+  }
+
+  std::atomic<size_t> inserted{0};
+  std::atomic<size_t> erased{0};
+  std::vector<std::thread> threads;
+
+  /* Each thread inserts its share and erases every fourth value it inserted */
+  for (size_t t = 0; t < NUM_THREADS; ++t) {
+    threads.emplace_back([&, t]() {
+      for (size_t i = t * ITEMS_PER_THREAD; i < (t + 1) * ITEMS_PER_THREAD; ++i) {
+        if (list.insert_sorted(buffer[i])) {
+          inserted.fetch_add(1, std::memory_order_relaxed);
+
+          if (values[i] % 4 == 0 && list.erase_key(values[i]) == &buffer[i]) {
+            erased.fetch_add(1, std::memory_order_relaxed);
+          }
+        }
+      }
+    });
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  int last{-1};
+  size_t count{};
+  for (const auto& item : list.list()) {
+    EXPECT_GT(item.m_value, last);
+    last = item.m_value;
+    ++count;
+  }
+
+  EXPECT_EQ(count, inserted.load() - erased.load());
+  EXPECT_EQ(list.size(), count);
+
+  /* Most operations must get through, this is not a zero failure test */
+  EXPECT_GT(inserted.load(), NUM_ITEMS * 9 / 10);
+}
+
+TEST_F(Multi_threaded_list_test, concurrent_sorted_insert_and_erase) {
+  sorted_insert_and_erase<ut::Sorted_list<Test_item, &Test_item::node, Value_order, ut::Exponential_backoff<1000>>>(
+    m_buffer.get(), BUFFER_SIZE);
+}
+
+TEST_F(Multi_threaded_list_test, concurrent_skip_index_insert_and_erase) {
+  sorted_insert_and_erase<ut::Sorted_list<Test_item, &Test_item::node, Value_order, ut::Exponential_backoff<1000>, ut::Skip_index<>>>(
+    m_buffer.get(), BUFFER_SIZE);
+}
+
+TEST_F(Multi_threaded_list_test, concurrent_move_to_front) {
+  constexpr size_t NUM_ITEMS = 1000;
+  constexpr size_t NUM_THREADS = 4;
+  constexpr size_t MOVES_PER_THREAD = 20000;
+
+  for (size_t i = 0; i < NUM_ITEMS; ++i) {
+    m_buffer[i] = Test_item(static_cast<int>(i));
+    ASSERT_TRUE(m_list->push_back(m_buffer[i]));
+  }
+
+  /* All threads move to the front, then to the back, then to either end
+   * so that moves off an end race with moves onto it. A move that became a
+   * removal leaves the item to the mover, which puts it back. */
+  for (const int round : {0, 1, 2}) {
+    std::vector<std::thread> threads;
+
+    for (size_t t = 0; t < NUM_THREADS; ++t) {
+      threads.emplace_back([&, t]() {
+        std::mt19937 rng(static_cast<unsigned>(t));
+
+        for (size_t i = 0; i < MOVES_PER_THREAD; ++i) {
+          auto& item = m_buffer[rng() % NUM_ITEMS];
+          const bool to_front = round == 2 ? rng() % 2 == 0 : round == 0;
+
+          if ((to_front ? m_list->move_to_front(item) : m_list->move_to_back(item)) == ut::Move_result::REMOVED) {
+            while (!m_list->push_back(item)) {
+              std::this_thread::yield();
+            }
+          }
+        }
+      });
+    }
+
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+
+  /* Moves never add or lose elements */
+  EXPECT_EQ(m_list->size(), NUM_ITEMS);
+
+  std::vector<bool> found(NUM_ITEMS);
+  size_t count{};
+  for (const auto& item : *m_list) {
+    EXPECT_FALSE(found[item.m_value]) << "Duplicate value found: " << item.m_value;
+    found[item.m_value] = true;
+    ++count;
+  }
+  EXPECT_EQ(count, NUM_ITEMS);
+}
+
+TEST_F(Multi_threaded_list_test, concurrent_move_and_pop) {
+  constexpr size_t NUM_ITEMS = 64;
+  constexpr size_t NUM_MOVERS = 3;
+  constexpr size_t POPS = 1000;
+  constexpr size_t ROUNDS = 16;
+
+  /* The LRU pattern: hits move elements to either end while the victims
+   * are popped at the back and others are removed directly. */
+  for (size_t round = 0; round < ROUNDS; ++round) {
+    std::vector<std::atomic<int>> removed(NUM_ITEMS);
+    std::atomic<size_t> total{0};
+    std::atomic<bool> done{false};
+
+    for (size_t i = 0; i < NUM_ITEMS; ++i) {
+      m_buffer[i] = Test_item(static_cast<int>(i));
+      ASSERT_TRUE(m_list->push_back(m_buffer[i]));
+    }
+
+    auto account = [&](Test_item* item) {
+      EXPECT_EQ(removed[item->m_value].fetch_add(1), 0) << "Removed twice: " << item->m_value;
+      total.fetch_add(1);
+    };
+
+    std::vector<std::thread> threads;
+
+    for (size_t t = 0; t < NUM_MOVERS; ++t) {
+      threads.emplace_back([&, t]() {
+        std::mt19937 rng(static_cast<unsigned>(round * NUM_MOVERS + t));
+
+        while (!done.load(std::memory_order_relaxed)) {
+          auto& item = m_buffer[rng() % NUM_ITEMS];
+
+          (void) (rng() % 2 == 0 ? m_list->move_to_front(item) : m_list->move_to_back(item));
+        }
+      });
+    }
+
+    /* Most victims go back in at the front, the list stays populated */
+    threads.emplace_back([&]() {
+      std::mt19937 rng(static_cast<unsigned>(round));
+
+      for (size_t i = 0; i < POPS; ++i) {
+        if (auto item = m_list->pop_back(); item != nullptr) {
+          if (rng() % 8 != 0) {
+            EXPECT_TRUE(m_list->push_front(*item));
+          } else {
+            account(item);
+          }
+        }
+      }
+    });
+
+    threads.emplace_back([&]() {
+      std::mt19937 rng(static_cast<unsigned>(~round));
+
+      for (size_t i = 0; i < POPS / 8; ++i) {
+        if (auto item = m_list->remove(m_buffer[rng() % NUM_ITEMS]); item != nullptr) {
+          account(item);
+        }
+        std::this_thread::yield();
+      }
+    });
+
+    threads[NUM_MOVERS].join();
+    threads[NUM_MOVERS + 1].join();
+    done.store(true, std::memory_order_relaxed);
+
+    for (size_t t = 0; t < NUM_MOVERS; ++t) {
+      threads[t].join();
+    }
+
+    /* Linked both ways, no cycle, and every element either in the list or
+     * removed exactly once */
+    size_t forward{};
+    for (auto it = m_list->begin(); it != m_list->end() && forward <= NUM_ITEMS; ++it) {
+      ++forward;
+    }
+
+    size_t backward{};
+    for (auto it = m_list->rbegin(); it != m_list->rend() && backward <= NUM_ITEMS; ++it) {
+      ++backward;
+    }
+
+    ASSERT_EQ(forward, NUM_ITEMS - total.load()) << "Round " << round;
+    ASSERT_EQ(backward, forward) << "Round " << round;
+    ASSERT_EQ(m_list->size(), forward) << "Round " << round;
+
+    while (auto item = m_list->pop_back()) {
+      account(item);
+    }
+
+    EXPECT_EQ(total.load(), NUM_ITEMS);
+    EXPECT_EQ(m_list->begin(), m_list->end());
+  }
+}
+
+struct Value_key {
+  int operator()(const Test_item& item) const noexcept { return item.m_value; }
+};
+
+TEST_F(Multi_threaded_list_test, concurrent_indexed_lru) {
+  constexpr size_t NUM_THREADS = 4;
+  constexpr size_t NUM_KEYS = 1000;
+  constexpr size_t OPS_PER_THREAD = 20000;
+  ut::Indexed_list<Test_item, &Test_item::node, Value_key, std::hash<int>, ut::Exponential_backoff<1000>> lru(
+    m_buffer.get(), m_buffer.get() + BUFFER_SIZE);
+
+  /* Every thread owns a copy of each key in its own slots, so inserts race
+   * on the keys but never on the slots. */
+  for (size_t t = 0; t < NUM_THREADS; ++t) {
+    for (size_t k = 0; k < NUM_KEYS; ++k) {
+      m_buffer[t * NUM_KEYS + k] = Test_item(static_cast<int>(k));
+    }
+  }
+
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < NUM_THREADS; ++t) {
+    threads.emplace_back([&, t]() {
+      std::mt19937 rng(static_cast<unsigned>(t));
+      std::vector<bool> mine(NUM_KEYS);
+
+      for (size_t i = 0; i < OPS_PER_THREAD; ++i) {
+        const auto key = static_cast<int>(rng() % NUM_KEYS);
+        auto& item = m_buffer[t * NUM_KEYS + static_cast<size_t>(key)];
+
+        if (!mine[key]) {
+          mine[key] = lru.push_front(item);
+        } else if (rng() % 2 == 0) {
+          (void) lru.touch(key);
+        } else {
+          /* Only the owner removes its copy, a touch() may have dropped it */
+          mine[key] = lru.remove(item) == nullptr && lru.find(key) == &item;
+        }
+      }
+    });
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  /* The list and the index agree and keys are unique */
+  std::vector<bool> seen(NUM_KEYS);
+  size_t count{};
+
+  for (const auto& item : lru.list()) {
+    EXPECT_FALSE(seen[item.m_value]) << "Duplicate key " << item.m_value;
+    seen[item.m_value] = true;
+    EXPECT_EQ(lru.find(item.m_value), &item);
+    ++count;
+  }
+
+  for (size_t k = 0; k < NUM_KEYS; ++k) {
+    if (!seen[k]) {
+      EXPECT_EQ(lru.find(static_cast<int>(k)), nullptr);
+    }
+  }
+  EXPECT_EQ(count, lru.size());
+}
+
+TEST_F(Multi_threaded_list_test, indexed_find_sees_only_linked_elements) {
+  constexpr size_t NUM_WRITERS = 4;
+  constexpr size_t ROUNDS = 50000;
+  ut::Indexed_list<Test_item, &Test_item::node, Value_key, std::hash<int>, ut::Exponential_backoff<1000>> lru(
+    m_buffer.get(), m_buffer.get() + BUFFER_SIZE);
+
+  /* Each writer pushes and removes its own key, counting the pushes and
+   * removes it started */
+  struct alignas(64) Counters {
+    std::atomic<size_t> m_pushes{};
+    std::atomic<size_t> m_removes{};
+  };
+  std::array<Counters, NUM_WRITERS> counters;
+  std::atomic<bool> done{};
+  std::atomic<size_t> early{};
+
+  for (size_t w = 0; w < NUM_WRITERS; ++w) {
+    m_buffer[w] = Test_item(static_cast<int>(w));
+  }
+
+  std::vector<std::thread> threads;
+  for (size_t w = 0; w < NUM_WRITERS; ++w) {
+    threads.emplace_back([&, w]() {
+      for (size_t round = 0; round < ROUNDS; ++round) {
+        /* An operation that runs out of retries behind the other writers
+         * is retried, the element is ours */
+        counters[w].m_pushes.fetch_add(1);
+        while (!lru.push_front(m_buffer[w])) {
+          std::this_thread::yield();
+        }
+        counters[w].m_removes.fetch_add(1);
+        while (lru.remove(m_buffer[w]) == nullptr) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+
+  /* A find() that returns an element whose node is null must have raced
+   * with its removal. Before any remove of the current round started the
+   * node can only be null if the push hasn't linked it yet. */
+  for (size_t r = 0; r < 2; ++r) {
+    threads.emplace_back([&, r]() {
+      for (size_t i = 0; !done.load(std::memory_order_relaxed); ++i) {
+        const auto w = (i + r) % NUM_WRITERS;
+        const auto pushes = counters[w].m_pushes.load();
+        const auto item = lru.find(static_cast<int>(w));
+
+        if (item != nullptr && item->node().is_null() && counters[w].m_removes.load() < pushes) {
+          early.fetch_add(1);
+        }
+      }
+    });
+  }
+
+  for (size_t w = 0; w < NUM_WRITERS; ++w) {
+    threads[w].join();
+  }
+  done.store(true);
+  for (size_t t = NUM_WRITERS; t < threads.size(); ++t) {
+    threads[t].join();
+  }
+
+  EXPECT_EQ(early.load(), 0);
+  EXPECT_EQ(lru.size(), 0);
+}
+
+TEST_F(Multi_threaded_list_test, sharded_list_work_stealing) {
+  constexpr size_t NUM_THREADS = 4;
+  constexpr size_t ITEMS_PER_THREAD = 5000;
+  ut::Sharded_list<Test_item, &Test_item::node, 4> sharded(m_buffer.get(), m_buffer.get() + BUFFER_SIZE);
+
+  /* Round 0: every thread fills its own shard. Round 1: only thread 0 has
+   * work, the others can only get it by stealing. */
+  for (size_t round = 0; round < 2; ++round) {
+    const size_t producers = round == 0 ? NUM_THREADS : 1;
+    const size_t total = producers * ITEMS_PER_THREAD;
+    std::vector<std::atomic<int>> popped(total);
+    std::atomic<size_t> pushed{0};
+    std::vector<std::thread> threads;
+
+    for (size_t i = 0; i < total; ++i) {
+      m_buffer[i] = Test_item(static_cast<int>(i));
+    }
+
+    for (size_t t = 0; t < NUM_THREADS; ++t) {
+      threads.emplace_back([&, t]() {
+        if (t < producers) {
+          for (size_t i = t * ITEMS_PER_THREAD; i < (t + 1) * ITEMS_PER_THREAD; ++i) {
+            EXPECT_TRUE(sharded.push(m_buffer[i]));
+          }
+        }
+        pushed.fetch_add(1, std::memory_order_acq_rel);
+
+        /* Pops only start once all pushes are done */
+        while (pushed.load(std::memory_order_acquire) < NUM_THREADS) {
+          std::this_thread::yield();
+        }
+
+        while (auto item = sharded.pop()) {
+          popped[item->m_value].fetch_add(1, std::memory_order_relaxed);
+        }
+      });
+    }
+
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    EXPECT_EQ(sharded.size(), 0);
+    for (size_t i = 0; i < total; ++i) {
+      EXPECT_EQ(popped[i].load(), 1) << "Item " << i;
+    }
+  }
+}
+
+TEST(Shared_list_mt_test, producer_processes) {
+  using Shared = ut::Shared_list<Test_item, &Test_item::node>;
+  constexpr size_t NUM_PRODUCERS = 4;
+  constexpr size_t NUM_CONSUMERS = 4;
+  constexpr size_t ITEMS_PER_PRODUCER = 5000;
+  constexpr size_t TOTAL = NUM_PRODUCERS * ITEMS_PER_PRODUCER;
+  const auto name = "/ut_shared_list_mt_test_" + std::to_string(getpid());
+
+  (void) Shared::unlink(name.c_str());
+
+  auto shared = Shared::create(name.c_str(), TOTAL);
+  ASSERT_NE(shared, nullptr);
+
+  std::vector<pid_t> producers;
+
+  /* Each producer maps the segment itself and appends its own slots */
+  for (size_t p = 0; p < NUM_PRODUCERS; ++p) {
+    const auto pid = fork();
+
+    if (pid == 0) {
+      auto view = Shared::attach(name.c_str());
+      size_t failed{};
+
+      for (size_t i = p * ITEMS_PER_PRODUCER; view != nullptr && i < (p + 1) * ITEMS_PER_PRODUCER; ++i) {
+        view->items()[i] = Test_item(static_cast<int>(i));
+        failed += !view->list().push_back(view->items()[i]);
+      }
+      _exit(view == nullptr || failed > 0 ? 1 : 0);
+    }
+    ASSERT_GT(pid, 0);
+    producers.push_back(pid);
+  }
+
+  for (auto pid : producers) {
+    int status{};
+    ASSERT_EQ(waitpid(pid, &status, 0), pid);
+    EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+  }
+
+  EXPECT_EQ(shared->list().size(), TOTAL);
+
+  std::vector<std::atomic<int>> popped(TOTAL);
+  std::vector<std::thread> consumers;
+
+  for (size_t c = 0; c < NUM_CONSUMERS; ++c) {
+    consumers.emplace_back([&]() {
+      while (auto item = shared->list().pop_front()) {
+        popped[item->m_value].fetch_add(1, std::memory_order_relaxed);
+      }
+    });
+  }
+
+  for (auto& thread : consumers) {
+    thread.join();
+  }
+
+  for (size_t i = 0; i < TOTAL; ++i) {
+    EXPECT_EQ(popped[i].load(), 1) << "Item " << i;
+  }
+
+  EXPECT_TRUE(Shared::unlink(name.c_str()));
+}
+
+TEST_F(Multi_threaded_list_test, list_queue_blocking_consumers) {
+  constexpr size_t NUM_PRODUCERS = 2;
+  constexpr size_t NUM_CONSUMERS = 4;
+  constexpr size_t ITEMS_PER_PRODUCER = 5000;
+  constexpr size_t TOTAL = NUM_PRODUCERS * ITEMS_PER_PRODUCER;
+  ut::List_queue<Test_item, &Test_item::node> queue(m_buffer.get(), m_buffer.get() + BUFFER_SIZE, 64);
+  std::vector<std::atomic<int>> popped(TOTAL);
+  std::atomic<size_t> consumed{0};
+  std::vector<std::thread> threads;
+
+  for (size_t i = 0; i < TOTAL; ++i) {
+    m_buffer[i] = Test_item(static_cast<int>(i));
+  }
+
+  /* Consumers park without a timeout whenever the queue runs dry, only
+   * closing the queue ends them */
+  for (size_t c = 0; c < NUM_CONSUMERS; ++c) {
+    threads.emplace_back([&]() {
+      while (auto item = queue.pop_front_wait()) {
+        popped[item->m_value].fetch_add(1, std::memory_order_relaxed);
+        consumed.fetch_add(1, std::memory_order_acq_rel);
+      }
+      EXPECT_TRUE(queue.closed());
+    });
+  }
+
+  /* Producers spin on a full queue */
+  for (size_t p = 0; p < NUM_PRODUCERS; ++p) {
+    threads.emplace_back([&, p]() {
+      for (size_t i = p * ITEMS_PER_PRODUCER; i < (p + 1) * ITEMS_PER_PRODUCER; ++i) {
+        while (!queue.try_push(m_buffer[i])) {
+          std::this_thread::yield();
+        }
+        if (i % 512 == 0) {
+          /* Let the consumers catch up and park */
+          std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+      }
+    });
+  }
+
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(60);
+
+  while (consumed.load(std::memory_order_acquire) < TOTAL && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  /* Let the consumers park again before the shutdown */
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  queue.close();
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(consumed.load(), TOTAL);
+  EXPECT_EQ(queue.size(), 0);
+  for (size_t i = 0; i < TOTAL; ++i) {
+    EXPECT_EQ(popped[i].load(), 1) << "Item " << i;
+  }
+}
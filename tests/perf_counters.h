@@ -0,0 +1,243 @@
+#pragma once
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <string>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+namespace benchmark_utils {
+
+/** Hardware events Perf_counters can count. */
+enum class Perf_event {
+  CYCLES,
+  INSTRUCTIONS,
+  L1D_MISSES,
+  LLC_MISSES,
+  BRANCH_MISSES,
+
+  /** Loads served from another core's modified line, the cost of cache
+   * line bouncing. There is no generic event for it, see hitm_config(). */
+  HITM,
+
+  COUNT
+};
+
+/**
+ * A group of hardware counters for the calling thread and the threads it
+ * creates while they are enabled, read as one and reported as Google
+ * Benchmark counters per operation.
+ *
+ * Counters are best effort: events the PMU or the kernel (e.g.
+ * perf_event_paranoid, a VM without a virtual PMU) don't allow are left
+ * out, and a group without any event reports nothing. Benchmarks run the
+ * same either way.
+ *
+ *   Perf_counters perf;
+ *
+ *   for (auto _ : state) {
+ *     perf.start();
+ *     ...
+ *     perf.stop();
+ *   }
+ *
+ *   perf.report(state, ops);
+ *
+ * Counts accumulate over start()/stop() pairs. Values are scaled by
+ * enabled / running time if the kernel multiplexed the group.
+ */
+class Perf_counters {
+public:
+  Perf_counters() noexcept {
+    m_fds.fill(-1);
+
+    for (size_t i = 0; i < EVENTS; ++i) {
+      uint32_t type{};
+      uint64_t config{};
+
+      if (!event_config(static_cast<Perf_event>(i), type, config)) {
+        continue;
+      }
+
+      perf_event_attr attr{};
+
+      attr.type = type;
+      attr.size = sizeof(perf_event_attr);
+      attr.config = config;
+      attr.disabled = m_leader == -1 ? 1 : 0;
+      attr.inherit = 1;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+      const auto fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, m_leader, 0));
+
+      if (fd == -1) {
+        continue;
+      }
+
+      if (m_leader == -1) {
+        m_leader = fd;
+      }
+      m_fds[i] = fd;
+    }
+
+    if (m_leader != -1) {
+      (void) ioctl(m_leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    }
+  }
+
+  ~Perf_counters() noexcept {
+    for (auto fd : m_fds) {
+      if (fd != -1) {
+        ::close(fd);
+      }
+    }
+  }
+
+  Perf_counters(const Perf_counters&) = delete;
+  Perf_counters& operator=(const Perf_counters&) = delete;
+
+  /** @return true if at least one event is counted. */
+  [[nodiscard]] bool available() const noexcept {
+    return m_leader != -1;
+  }
+
+  [[nodiscard]] bool counts(Perf_event event) const noexcept {
+    return m_fds[static_cast<size_t>(event)] != -1;
+  }
+
+  void start() noexcept {
+    if (m_leader != -1) {
+      (void) ioctl(m_leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+  }
+
+  void stop() noexcept {
+    if (m_leader != -1) {
+      (void) ioctl(m_leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+    }
+  }
+
+  /** Count of event so far, 0 if it isn't counted. */
+  [[nodiscard]] double value(Perf_event event) const noexcept {
+    const auto fd = m_fds[static_cast<size_t>(event)];
+
+    /* The members are read one by one, a group read of inherited events
+     * isn't supported by older kernels */
+    struct {
+      uint64_t m_value;
+      uint64_t m_enabled;
+      uint64_t m_running;
+    } data{};
+
+    if (fd == -1 || ::read(fd, &data, sizeof(data)) != static_cast<ssize_t>(sizeof(data)) || data.m_running == 0) {
+      return 0;
+    }
+
+    return static_cast<double>(data.m_value) * static_cast<double>(data.m_enabled) / static_cast<double>(data.m_running);
+  }
+
+  /** Add "<event>/Op" counters for the counted events, ops is the number
+   * of operations over all iterations. */
+  void report(benchmark::State& state, double ops) const {
+    if (ops <= 0) {
+      return;
+    }
+
+    for (size_t i = 0; i < EVENTS; ++i) {
+      const auto event = static_cast<Perf_event>(i);
+
+      if (counts(event)) {
+        state.counters[std::string(name(event)) + "/Op"] = value(event) / ops;
+      }
+    }
+
+    if (counts(Perf_event::CYCLES) && counts(Perf_event::INSTRUCTIONS) && value(Perf_event::CYCLES) > 0) {
+      state.counters["IPC"] = value(Perf_event::INSTRUCTIONS) / value(Perf_event::CYCLES);
+    }
+  }
+
+  [[nodiscard]] static const char* name(Perf_event event) noexcept {
+    constexpr const char* NAMES[] = {"Cycles", "Instructions", "L1DMisses", "LLCMisses", "BranchMisses", "HITM"};
+
+    static_assert(std::size(NAMES) == EVENTS);
+
+    return NAMES[static_cast<size_t>(event)];
+  }
+
+  /**
+   * Raw config of the HITM event: UT_PERF_HITM (hex, 0 disables) if set,
+   * else MEM_LOAD_L3_HIT_RETIRED.XSNP_HITM on Intel cores since Skylake.
+   *
+   * @return 0 if there is none.
+   */
+  [[nodiscard]] static uint64_t hitm_config() noexcept {
+    if (const auto env = std::getenv("UT_PERF_HITM"); env != nullptr) {
+      return std::strtoull(env, nullptr, 16);
+    }
+
+#if defined(__x86_64__) || defined(__i386__)
+    unsigned eax{};
+    unsigned ebx{};
+    unsigned ecx{};
+    unsigned edx{};
+
+    /* "GenuineIntel" */
+    if (__get_cpuid(0, &eax, &ebx, &ecx, &edx) != 0 && ebx == 0x756e6547 && edx == 0x49656e69 && ecx == 0x6c65746e) {
+      return 0x04d2;
+    }
+#endif
+    return 0;
+  }
+
+private:
+  static constexpr size_t EVENTS = static_cast<size_t>(Perf_event::COUNT);
+
+  [[nodiscard]] static bool event_config(Perf_event event, uint32_t& type, uint64_t& config) noexcept {
+    type = PERF_TYPE_HARDWARE;
+
+    switch (event) {
+      case Perf_event::CYCLES:
+        config = PERF_COUNT_HW_CPU_CYCLES;
+        return true;
+      case Perf_event::INSTRUCTIONS:
+        config = PERF_COUNT_HW_INSTRUCTIONS;
+        return true;
+      case Perf_event::L1D_MISSES:
+        type = PERF_TYPE_HW_CACHE;
+        config = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        return true;
+      case Perf_event::LLC_MISSES:
+        config = PERF_COUNT_HW_CACHE_MISSES;
+        return true;
+      case Perf_event::BRANCH_MISSES:
+        config = PERF_COUNT_HW_BRANCH_MISSES;
+        return true;
+      case Perf_event::HITM:
+        type = PERF_TYPE_RAW;
+        config = hitm_config();
+        return config != 0;
+      case Perf_event::COUNT:
+        break;
+    }
+    return false;
+  }
+
+  int m_leader{-1};
+  std::array<int, EVENTS> m_fds{};
+};
+
+} // namespace benchmark_utils
@@ -1,8 +1,28 @@
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
 #include <thread>
 #include <vector>
 
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "ut/async_find.h"
+#include "ut/epoch.h"
+#include "ut/fixed_pool.h"
+#include "ut/indexed_list.h"
+#include "ut/list_group.h"
+#include "ut/list_queue.h"
 #include "ut/lock_free_list.h"
+#include "ut/mapped.h"
+#include "ut/numa.h"
+#include "ut/persistent_list.h"
+#include "ut/sharded_list.h"
+#include "ut/shared_list.h"
+#include "ut/skip_index.h"
+#include "ut/sorted_list.h"
 
 struct Test_item {
   Test_item() = default;
@@ -267,3 +287,1827 @@ TEST_F(List_test, size_tracking) {
   EXPECT_EQ(m_list->size(), 0);
 }
 
+TEST_F(List_test, push_back_batch) {
+  m_buffer[0] = Test_item(1);
+  ASSERT_TRUE(m_list->push_back(m_buffer[0]));
+
+  for (int i = 1; i <= 4; ++i) {
+    m_buffer[i] = Test_item(i + 1);
+  }
+  ASSERT_TRUE(m_list->push_back_batch(&m_buffer[1], &m_buffer[5]));
+
+  std::vector<int> actual;
+  for (const auto& item : *m_list) {
+    actual.push_back(item.m_value);
+  }
+  EXPECT_EQ(actual, (std::vector<int>{1, 2, 3, 4, 5}));
+
+  std::vector<int> reversed;
+  for (auto it = m_list->rbegin(); it != m_list->rend(); ++it) {
+    reversed.push_back(it->m_value);
+  }
+  EXPECT_EQ(reversed, (std::vector<int>{5, 4, 3, 2, 1}));
+  EXPECT_EQ(m_list->size(), 5);
+}
+
+TEST_F(List_test, push_front_batch) {
+  m_buffer[0] = Test_item(4);
+  ASSERT_TRUE(m_list->push_back(m_buffer[0]));
+
+  std::vector<Test_item*> batch;
+  for (int i = 1; i <= 3; ++i) {
+    m_buffer[i] = Test_item(i);
+    batch.push_back(&m_buffer[i]);
+  }
+  ASSERT_TRUE(m_list->push_front_batch(batch.begin(), batch.end()));
+
+  std::vector<int> actual;
+  for (const auto& item : *m_list) {
+    actual.push_back(item.m_value);
+  }
+  EXPECT_EQ(actual, (std::vector<int>{1, 2, 3, 4}));
+  EXPECT_EQ(m_list->size(), 4);
+
+  /* Empty batches are a no-op */
+  ASSERT_TRUE(m_list->push_front_batch(batch.end(), batch.end()));
+  EXPECT_EQ(m_list->size(), 4);
+}
+
+TEST_F(List_test, splice) {
+  ut::List<Test_item, &Test_item::node> other(m_buffer.get(), m_buffer.get() + BUFFER_SIZE);
+
+  for (int i = 0; i < 3; ++i) {
+    m_buffer[i] = Test_item(i);
+    ASSERT_TRUE(m_list->push_back(m_buffer[i]));
+  }
+  for (int i = 3; i < 6; ++i) {
+    m_buffer[i] = Test_item(i);
+    ASSERT_TRUE(other.push_back(m_buffer[i]));
+  }
+
+  ASSERT_TRUE(m_list->splice(other));
+
+  std::vector<int> actual;
+  for (const auto& item : *m_list) {
+    actual.push_back(item.m_value);
+  }
+  EXPECT_EQ(actual, (std::vector<int>{0, 1, 2, 3, 4, 5}));
+  EXPECT_EQ(m_list->size(), 6);
+  EXPECT_EQ(other.size(), 0);
+  EXPECT_EQ(other.begin(), other.end());
+
+  /* The spliced elements are ordinary elements again, prev links too */
+  std::vector<int> reversed;
+  for (auto it = m_list->rbegin(); it != m_list->rend(); ++it) {
+    reversed.push_back(it->m_value);
+  }
+  EXPECT_EQ(reversed, (std::vector<int>{5, 4, 3, 2, 1, 0}));
+  EXPECT_EQ(m_list->remove(m_buffer[4]), &m_buffer[4]);
+  m_buffer[4] = Test_item(4);
+  ASSERT_TRUE(m_list->insert_before(m_buffer[5], m_buffer[4]));
+  EXPECT_EQ(m_list->size(), 6);
+
+  /* The source list is reusable */
+  m_buffer[6] = Test_item(6);
+  ASSERT_TRUE(other.push_back(m_buffer[6]));
+  EXPECT_EQ(other.begin()->m_value, 6);
+}
+
+TEST_F(List_test, pop_front_n) {
+  for (int i = 0; i < 6; ++i) {
+    m_buffer[i] = Test_item(i);
+    ASSERT_TRUE(m_list->push_back(m_buffer[i]));
+  }
+
+  Test_item* out[4]{};
+
+  ASSERT_EQ(m_list->pop_front_n(out, 4), 4);
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(out[i]->m_value, i);
+    EXPECT_TRUE(out[i]->m_node.is_null());
+  }
+  EXPECT_EQ(m_list->size(), 2);
+
+  /* Asking for more than there is drains the list, tail included */
+  ASSERT_EQ(m_list->pop_front_n(out, 4), 2);
+  EXPECT_EQ(out[0]->m_value, 4);
+  EXPECT_EQ(out[1]->m_value, 5);
+  EXPECT_EQ(m_list->size(), 0);
+  EXPECT_EQ(m_list->begin(), m_list->end());
+  EXPECT_EQ(m_list->pop_front_n(out, 4), 0);
+
+  /* The list and the nodes are reusable */
+  ASSERT_TRUE(m_list->push_back(m_buffer[0]));
+  EXPECT_EQ(m_list->pop_front(), &m_buffer[0]);
+}
+
+TEST_F(List_test, take_all) {
+  EXPECT_TRUE(m_list->take_all().empty());
+
+  for (int i = 0; i < 5; ++i) {
+    m_buffer[i] = Test_item(i);
+    ASSERT_TRUE(m_list->push_back(m_buffer[i]));
+  }
+
+  auto chain = m_list->take_all();
+
+  EXPECT_EQ(chain.size(), 5);
+  EXPECT_EQ(m_list->size(), 0);
+  EXPECT_EQ(m_list->begin(), m_list->end());
+
+  /* Detached items can't be removed, moved or linked next to */
+  m_buffer[5] = Test_item(5);
+  EXPECT_EQ(m_list->remove(m_buffer[2]), nullptr);
+  EXPECT_EQ(m_list->move_to_front(m_buffer[4]), ut::Move_result::UNCHANGED);
+  EXPECT_FALSE(m_list->insert_after(m_buffer[0], m_buffer[5]));
+  EXPECT_FALSE(m_list->insert_before(m_buffer[3], m_buffer[5]));
+  EXPECT_EQ(m_list->size(), 0);
+
+  std::vector<int> detached;
+  for (const auto& item : chain) {
+    detached.push_back(item.m_value);
+  }
+  EXPECT_EQ(detached, (std::vector<int>{0, 1, 2, 3, 4}));
+
+  /* The items can be pushed elsewhere while walking the chain */
+  ut::List<Test_item, &Test_item::node> other(m_buffer.get(), m_buffer.get() + BUFFER_SIZE);
+
+  for (auto& item : chain) {
+    ASSERT_TRUE(other.push_front(item));
+  }
+
+  std::vector<int> actual;
+  for (const auto& item : other) {
+    actual.push_back(item.m_value);
+  }
+  EXPECT_EQ(actual, (std::vector<int>{4, 3, 2, 1, 0}));
+}
+
+TEST_F(List_test, erase_range_and_remove_if) {
+  for (int i = 0; i < 10; ++i) {
+    m_buffer[i] = Test_item(i);
+    ASSERT_TRUE(m_list->push_back(m_buffer[i]));
+  }
+
+  const auto values = [this]() {
+    std::vector<int> actual;
+    for (const auto& item : *m_list) {
+      actual.push_back(item.m_value);
+    }
+    return actual;
+  };
+
+  EXPECT_EQ(m_list->erase_range(m_buffer[2], m_buffer[5]), 4);
+  EXPECT_EQ(m_list->size(), 6);
+  EXPECT_EQ(values(), (std::vector<int>{0, 1, 6, 7, 8, 9}));
+  for (int i = 2; i <= 5; ++i) {
+    EXPECT_TRUE(m_buffer[i].m_node.is_null());
+  }
+
+  /* One element, and a range ending at the tail */
+  EXPECT_EQ(m_list->erase_range(m_buffer[6], m_buffer[6]), 1);
+  EXPECT_EQ(m_list->erase_range(m_buffer[8], m_buffer[9]), 2);
+  EXPECT_EQ(values(), (std::vector<int>{0, 1, 7}));
+  EXPECT_EQ(&*m_list->rbegin(), &m_buffer[7]);
+
+  /* Backward links are fixed up too */
+  std::vector<int> reversed;
+  for (auto it = m_list->rbegin(); it != m_list->rend(); ++it) {
+    reversed.push_back(it->m_value);
+  }
+  EXPECT_EQ(reversed, (std::vector<int>{7, 1, 0}));
+
+  for (int i = 10; i < 20; ++i) {
+    m_buffer[i] = Test_item(i);
+    ASSERT_TRUE(m_list->push_back(m_buffer[i]));
+  }
+
+  /* Runs at the head, in the middle and at the tail */
+  EXPECT_EQ(m_list->remove_if([](const Test_item& item) {
+    return item.m_value < 10 || (item.m_value >= 12 && item.m_value < 15) || item.m_value >= 18;
+  }), 8);
+  EXPECT_EQ(m_list->size(), 5);
+  EXPECT_EQ(values(), (std::vector<int>{10, 11, 15, 16, 17}));
+
+  EXPECT_EQ(m_list->remove_if([](const Test_item&) { return false; }), 0);
+  EXPECT_EQ(m_list->remove_if([](const Test_item&) { return true; }), 5);
+  EXPECT_EQ(m_list->size(), 0);
+  EXPECT_EQ(m_list->begin(), m_list->end());
+
+  /* The nodes are reusable */
+  ASSERT_TRUE(m_list->push_back(m_buffer[3]));
+  ASSERT_TRUE(m_list->push_front(m_buffer[12]));
+  EXPECT_EQ(values(), (std::vector<int>{12, 3}));
+}
+
+TEST_F(List_test, snapshot) {
+  Test_item* out[8]{};
+
+  EXPECT_EQ(m_list->snapshot(out, 8), 0);
+
+  for (int i = 0; i < 5; ++i) {
+    m_buffer[i] = Test_item(i);
+    ASSERT_TRUE(m_list->push_back(m_buffer[i]));
+  }
+
+  ASSERT_EQ(m_list->snapshot(out, 8), 5);
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(out[i], &m_buffer[i]);
+  }
+
+  /* Exactly full, and too small */
+  EXPECT_EQ(m_list->snapshot(out, 5), 5);
+  EXPECT_EQ(m_list->snapshot(out, 4), std::nullopt);
+
+  ASSERT_NE(m_list->remove(m_buffer[2]), nullptr);
+  ASSERT_EQ(m_list->snapshot(out, 8), 4);
+  EXPECT_EQ(out[2], &m_buffer[3]);
+}
+
+TEST(Fixed_pool_test, allocate_and_release) {
+  ut::Fixed_pool<Test_item, &Test_item::node> pool(4);
+  ut::List<Test_item, &Test_item::node> list(pool.base(), pool.end());
+
+  std::vector<Test_item*> items;
+  while (auto item = pool.allocate()) {
+    EXPECT_TRUE(item->m_node.is_null());
+    item->m_value = static_cast<int>(items.size());
+    ASSERT_TRUE(list.push_back(*item));
+    items.push_back(item);
+  }
+  EXPECT_EQ(items.size(), pool.capacity());
+  EXPECT_EQ(list.size(), 4);
+
+  /* Removed items go straight back to the pool */
+  pool.release(list.pop_front());
+  pool.release(list.remove(*items[2]));
+  pool.release(nullptr);
+
+  auto a = pool.allocate();
+  auto b = pool.allocate();
+  EXPECT_EQ(a, items[2]);
+  EXPECT_EQ(b, items[0]);
+  EXPECT_EQ(pool.allocate(), nullptr);
+}
+
+TEST(Fixed_pool_test, free_slots_not_scanned) {
+  constexpr size_t CAPACITY = 16;
+  ut::Fixed_pool<Test_item, &Test_item::node> pool(CAPACITY);
+  ut::List<Test_item, &Test_item::node> list(pool.base(), pool.end());
+
+  std::vector<Test_item*> items;
+  while (auto item = pool.allocate()) {
+    item->m_value = static_cast<int>(items.size());
+    items.push_back(item);
+  }
+
+  /* Every other slot in the list, the rest back in the pool */
+  for (size_t i = 0; i < CAPACITY; ++i) {
+    if (i % 2 == 0) {
+      ASSERT_TRUE(list.push_back(*items[i]));
+    } else {
+      pool.release(items[i]);
+    }
+  }
+
+  std::vector<int> visited;
+  list.for_each_unordered([&visited](Test_item& item) { visited.push_back(item.m_value); });
+  EXPECT_EQ(visited, (std::vector<int>{0, 2, 4, 6, 8, 10, 12, 14}));
+
+  /* A free slot reads as removed: a stale remove() fails at once and
+   * recover() leaves the free stack alone */
+  EXPECT_EQ(list.remove(*items[1]), nullptr);
+  EXPECT_EQ(list.recover(CAPACITY), CAPACITY / 2);
+
+  /* The free slots still come back out of the pool */
+  size_t count{};
+  while (auto item = pool.allocate()) {
+    EXPECT_EQ(item->m_value % 2, 1);
+    EXPECT_TRUE(item->m_node.is_null());
+    ++count;
+  }
+  EXPECT_EQ(count, CAPACITY / 2);
+}
+
+TEST(Fixed_pool_test, cache) {
+  using Pool = ut::Fixed_pool<Test_item, &Test_item::node>;
+  constexpr size_t CAPACITY = 3 * Pool::CACHE_SIZE;
+
+  Pool pool(CAPACITY);
+  std::vector<Test_item*> items;
+
+  {
+    Pool::Cache cache(pool);
+
+    while (auto item = cache.allocate()) {
+      items.push_back(item);
+    }
+    EXPECT_EQ(items.size(), CAPACITY);
+    EXPECT_EQ(pool.allocate(), nullptr);
+
+    /* Every slot exactly once */
+    std::sort(items.begin(), items.end());
+    EXPECT_EQ(std::adjacent_find(items.begin(), items.end()), items.end());
+
+    for (auto item : items) {
+      cache.release(item);
+    }
+
+    /* The cache keeps at most 2 * CACHE_SIZE slots, the rest is shared */
+    EXPECT_LE(cache.size(), 2 * Pool::CACHE_SIZE);
+    EXPECT_NE(pool.allocate(), nullptr);
+  }
+
+  /* Destroying the cache returned its slots */
+  size_t count{1};
+  while (pool.allocate() != nullptr) {
+    ++count;
+  }
+  EXPECT_EQ(count, CAPACITY);
+}
+
+TEST(Epoch_domain_test, retire_waits_for_readers) {
+  using Pool = ut::Fixed_pool<Test_item, &Test_item::node>;
+  using Domain = ut::Epoch_domain<Pool>;
+
+  Pool pool(1);
+  Domain domain(pool);
+  Domain::Participant reader(domain);
+  Domain::Participant writer(domain);
+
+  auto item = writer.allocate();
+  ASSERT_NE(item, nullptr);
+
+  {
+    auto guard = reader.pin();
+
+    writer.retire(item);
+    for (int i = 0; i < 10; ++i) {
+      writer.collect();
+    }
+
+    /* The reader may still hold the slot */
+    EXPECT_EQ(writer.pending(), 1);
+    EXPECT_EQ(writer.allocate(), nullptr);
+  }
+
+  writer.collect();
+  writer.collect();
+  EXPECT_EQ(writer.pending(), 0);
+  EXPECT_EQ(writer.allocate(), item);
+}
+
+TEST(Epoch_domain_test, list_iterators_pin_the_domain) {
+  using Pool = ut::Fixed_pool<Test_item, &Test_item::node>;
+  using Domain = ut::Epoch_domain<Pool>;
+  using Reclaim = ut::Epoch_reclaim<Domain>;
+  using List_type = ut::List<Test_item, &Test_item::node, ut::No_backoff<>, ut::No_stats, Reclaim>;
+
+  Pool pool(1);
+  Domain domain(pool);
+  List_type list(pool.base(), pool.end(), Reclaim(domain));
+  Domain::Participant participant(domain);
+
+  EXPECT_EQ(Domain::Participant::local(domain), &participant);
+
+  auto item = participant.allocate();
+  ASSERT_NE(item, nullptr);
+  ASSERT_TRUE(list.push_back(*item));
+
+  {
+    auto it = list.begin();
+
+    list.retire(list.pop_front());
+    for (int i = 0; i < 10; ++i) {
+      participant.collect();
+    }
+
+    /* The iterator may still hold the slot */
+    EXPECT_EQ(&*it, item);
+    EXPECT_EQ(participant.pending(), 1);
+    EXPECT_EQ(participant.allocate(), nullptr);
+  }
+
+  participant.collect();
+  participant.collect();
+  EXPECT_EQ(participant.pending(), 0);
+  EXPECT_EQ(participant.allocate(), item);
+}
+
+static_assert(sizeof(ut::Node_32) == 4);
+static_assert(sizeof(ut::Node) == 8);
+static_assert(sizeof(ut::Node_128) == 16);
+static_assert(ut::Layout_32::NULL_PTR == (1u << 14) - 1);
+static_assert(ut::Layout_128::VERSION_BITS_PER_LINK == 16);
+static_assert(ut::unpack_links<ut::Layout_32>(ut::pack_links<ut::Layout_32>(5, 7, 1, 2)).prev == 7);
+static_assert(ut::unpack_links<ut::Layout_128>(ut::pack_links<ut::Layout_128>(5, 7, 1, 65535)).prev_version == 65535);
+
+/* Capacity vs. version width */
+static_assert(ut::Layout_64::VERSION_PERIOD == 4);
+static_assert(ut::link_bits_for((1u << 24) - 2) == 24);
+static_assert(ut::link_bits_for(1u << 24) == 25);
+static_assert(ut::Layout_for_capacity<(1u << 24) - 2>::VERSION_BITS_PER_LINK == 8);
+static_assert(ut::Layout_for_capacity<(1u << 24) - 2>::MAX_CAPACITY == (1u << 24) - 2);
+static_assert(ut::Layout_for_capacity<1000>::VERSION_PERIOD == (uint64_t{1} << 22));
+static_assert(ut::Layout_for_capacity<1000, uint32_t>::VERSION_BITS_PER_LINK == 6);
+
+template <typename Node_type>
+struct Layout_item {
+  Node_type& node() noexcept { return m_node; }
+
+  int m_value{};
+  Node_type m_node{};
+};
+
+template <typename Node_type>
+class Layout_test : public ::testing::Test {};
+
+using Node_types = ::testing::Types<
+  ut::Node_32,
+  ut::Node,
+  ut::Node_128,
+  ut::Node_for_capacity<1000>,
+  ut::Node_for_capacity<(1u << 24) - 2>>;
+TYPED_TEST_SUITE(Layout_test, Node_types);
+
+TYPED_TEST(Layout_test, list_operations) {
+  using Item = Layout_item<TypeParam>;
+  constexpr size_t SIZE = 1000;
+
+  auto buffer = std::make_unique<Item[]>(SIZE);
+  ut::List<Item, &Item::node> list(buffer.get(), buffer.get() + SIZE);
+
+  for (size_t i = 0; i < SIZE; ++i) {
+    buffer[i].m_value = static_cast<int>(i);
+    ASSERT_TRUE(list.push_back(buffer[i]));
+  }
+
+  /* Remove every other element */
+  for (size_t i = 0; i < SIZE; i += 2) {
+    ASSERT_EQ(list.remove(buffer[i]), &buffer[i]);
+  }
+  ASSERT_TRUE(list.insert_after(buffer[1], buffer[2]));
+
+  std::vector<int> actual;
+  for (const auto& item : list) {
+    actual.push_back(item.m_value);
+  }
+  ASSERT_EQ(actual.size(), SIZE / 2 + 1);
+  EXPECT_EQ(actual[0], 1);
+  EXPECT_EQ(actual[1], 2);
+  EXPECT_EQ(actual[2], 3);
+
+  EXPECT_EQ(list.pop_back(), &buffer[SIZE - 1]);
+  EXPECT_EQ(list.pop_front(), &buffer[1]);
+  EXPECT_EQ(list.size(), SIZE / 2 - 1);
+}
+
+static_assert(ut::exact_divide<16>(48) == 3);
+static_assert(ut::exact_divide<40>(40 * 12345) == 12345);
+static_assert(ut::exact_divide<24>(24 * ((uint64_t{1} << 40) + 7)) == (uint64_t{1} << 40) + 7);
+static_assert(ut::modular_inverse(3) * 3 == 1);
+
+/* Not a power of two in size, and the node isn't at offset 0 */
+struct Odd_item {
+  ut::Node& node() noexcept { return m_node; }
+
+  char m_tag[20]{};
+  ut::Node m_node{};
+  int m_value{};
+};
+
+static_assert(sizeof(Odd_item) == 40);
+
+TEST(Slot_index_test, odd_sized_items) {
+  constexpr size_t SIZE = 100;
+
+  auto buffer = std::make_unique<Odd_item[]>(SIZE);
+  ut::List<Odd_item, &Odd_item::node> list(buffer.get(), buffer.get() + SIZE);
+
+  for (size_t i = 0; i < SIZE; ++i) {
+    buffer[i].m_value = static_cast<int>(i);
+    ASSERT_TRUE(list.push_back(buffer[i]));
+  }
+
+  int expected{};
+  for (const auto& item : list) {
+    EXPECT_EQ(item.m_value, expected++);
+  }
+  EXPECT_EQ(expected, static_cast<int>(SIZE));
+
+  EXPECT_EQ(list.remove(buffer[57]), &buffer[57]);
+  EXPECT_EQ(list.pop_back(), &buffer[SIZE - 1]);
+  EXPECT_EQ(list.find([](const Odd_item* item) { return item->m_value == 58; }), &buffer[58]);
+}
+
+/* Payload without an embedded node, for side links lists */
+struct Payload {
+  int m_value{};
+};
+
+TEST(Side_links_test, list_operations) {
+  using List_type = ut::List<Payload, ut::SIDE_LINKS<>>;
+  constexpr size_t SIZE = 100;
+
+  auto items = std::make_unique<Payload[]>(SIZE);
+  auto nodes = std::make_unique<ut::Node[]>(SIZE);
+  List_type list(items.get(), items.get() + SIZE, nodes.get());
+
+  for (size_t i = 0; i < SIZE; ++i) {
+    items[i].m_value = static_cast<int>(i);
+    ASSERT_TRUE(list.push_back(items[i]));
+  }
+  EXPECT_FALSE(nodes[0].is_null());
+
+  ASSERT_EQ(list.remove(items[10]), &items[10]);
+  EXPECT_TRUE(nodes[10].is_null());
+  ASSERT_TRUE(list.insert_after(items[20], items[10]));
+
+  EXPECT_EQ(list.find([](const Payload* item) { return item->m_value == 10; }), &items[10]);
+
+  Payload* out[21]{};
+  ASSERT_EQ(list.pop_front_n(out, 21), 21);
+  EXPECT_EQ(out[19]->m_value, 20);
+  EXPECT_EQ(out[20]->m_value, 10);
+
+  std::vector<int> reversed;
+  for (auto it = list.rbegin(); it != list.rend(); ++it) {
+    reversed.push_back(it->m_value);
+  }
+  ASSERT_EQ(reversed.size(), SIZE - 21);
+  EXPECT_EQ(reversed.front(), static_cast<int>(SIZE - 1));
+  EXPECT_EQ(reversed.back(), 21);
+
+  auto chain = list.take_all();
+  EXPECT_EQ(chain.size(), SIZE - 21);
+  EXPECT_EQ(chain.begin()->m_value, 21);
+}
+
+TEST(Side_links_test, fixed_pool) {
+  using Pool = ut::Fixed_pool<Payload, ut::SIDE_LINKS<>>;
+
+  Pool pool(8);
+  ut::List<Payload, ut::SIDE_LINKS<>> list(pool.base(), pool.end(), pool.nodes());
+
+  while (auto item = pool.allocate()) {
+    ASSERT_TRUE(list.push_front(*item));
+  }
+  EXPECT_EQ(list.size(), 8);
+
+  pool.release(list.pop_back());
+  EXPECT_EQ(pool.allocate(), pool.base());
+}
+
+TEST(Side_links_test, for_each_unordered) {
+  /* Not a multiple of the scan block, the tail is scanned too */
+  constexpr size_t SIZE = 150;
+
+  auto items = std::make_unique<Payload[]>(SIZE);
+  auto nodes = std::make_unique<ut::Node[]>(SIZE);
+  ut::List<Payload, ut::SIDE_LINKS<>> list(items.get(), items.get() + SIZE, nodes.get());
+
+  auto embedded = std::make_unique<Test_item[]>(SIZE);
+  ut::List<Test_item, &Test_item::node> embedded_list(embedded.get(), embedded.get() + SIZE);
+
+  std::vector<int> expected;
+
+  /* Pushed in reverse, visited in array order */
+  for (size_t i = SIZE; i-- > 0;) {
+    items[i].m_value = static_cast<int>(i);
+    embedded[i].m_value = static_cast<int>(i);
+
+    if (i % 3 != 0) {
+      ASSERT_TRUE(list.push_front(items[i]));
+      ASSERT_TRUE(embedded_list.push_front(embedded[i]));
+    }
+  }
+
+  ASSERT_EQ(list.remove(items[100]), &items[100]);
+  ASSERT_EQ(embedded_list.remove(embedded[100]), &embedded[100]);
+
+  /* A removal that claimed its node but didn't unlink it yet */
+  const auto claimed = ut::pack_links(ut::Node::DELETING_MARK, 0, 0, 0);
+  nodes[1].m_links.store(claimed);
+  embedded[1].m_node.m_links.store(claimed);
+
+  for (int i = 2; i < static_cast<int>(SIZE); ++i) {
+    if (i % 3 != 0 && i != 100) {
+      expected.push_back(i);
+    }
+  }
+
+  std::vector<int> visited;
+  list.for_each_unordered([&visited](Payload& item) { visited.push_back(item.m_value); });
+  EXPECT_EQ(visited, expected);
+
+  visited.clear();
+  embedded_list.for_each_unordered([&visited](Test_item& item) { visited.push_back(item.m_value); });
+  EXPECT_EQ(visited, expected);
+}
+
+TEST_F(List_test, find_long_list) {
+  for (size_t i = 0; i < BUFFER_SIZE; ++i) {
+    m_buffer[i] = Test_item(static_cast<int>(i));
+    ASSERT_TRUE(m_list->push_back(m_buffer[i]));
+  }
+
+  /* Hops don't count against the retry budget */
+  auto last = [](const Test_item* item) { return item->m_value == BUFFER_SIZE - 1; };
+  auto missing = [](const Test_item* item) { return item->m_value < 0; };
+
+  EXPECT_EQ(m_list->find(last), &m_buffer[BUFFER_SIZE - 1]);
+  EXPECT_EQ(m_list->find_prefetched(last), &m_buffer[BUFFER_SIZE - 1]);
+  EXPECT_EQ(m_list->find_prefetched<1>(last), &m_buffer[BUFFER_SIZE - 1]);
+  EXPECT_EQ(m_list->find_prefetched<16>(missing), nullptr);
+  EXPECT_EQ(m_list->find_prefetched([](const Test_item* item) { return item->m_value == 3; }), &m_buffer[3]);
+}
+
+TEST_F(List_test, for_each_and_visit_until) {
+  for (int i = 0; i < 10; ++i) {
+    m_buffer[i] = Test_item(i);
+    ASSERT_TRUE(m_list->push_back(m_buffer[i]));
+  }
+  ASSERT_NE(m_list->remove(m_buffer[4]), nullptr);
+
+  std::vector<int> visited;
+  EXPECT_TRUE(m_list->for_each([&visited](Test_item& item) { visited.push_back(item.m_value); }));
+  EXPECT_EQ(visited, (std::vector<int>{0, 1, 2, 3, 5, 6, 7, 8, 9}));
+
+  size_t calls{};
+  auto item = m_list->visit_until([&calls](const Test_item& item) {
+    ++calls;
+    return item.m_value == 6;
+  });
+  EXPECT_EQ(item, &m_buffer[6]);
+  EXPECT_EQ(calls, 6);
+
+  EXPECT_EQ(m_list->visit_until([](const Test_item& item) { return item.m_value == 4; }), nullptr);
+
+  ut::List<Test_item, &Test_item::node> empty(m_buffer.get(), m_buffer.get() + BUFFER_SIZE);
+  EXPECT_TRUE(empty.for_each([](Test_item&) { FAIL(); }));
+}
+
+TEST_F(List_test, async_find) {
+  for (int i = 0; i < 100; ++i) {
+    m_buffer[i] = Test_item(i);
+    ASSERT_TRUE(m_list->push_back(m_buffer[i]));
+  }
+
+  /* Steps for the list and its head, then one per node read */
+  auto task = m_list->async_find([](const Test_item* item) { return item->m_value == 42; });
+  size_t steps{};
+
+  while (!task.done()) {
+    EXPECT_EQ(task.result(), nullptr);
+    task.resume();
+    ++steps;
+  }
+  EXPECT_EQ(task.result(), &m_buffer[42]);
+  EXPECT_EQ(steps, 2 + 43);
+
+  EXPECT_EQ(m_list->async_find([](const Test_item* item) { return item->m_value < 0; }).get(), nullptr);
+
+  ut::List<Test_item, &Test_item::node> second(m_buffer.get(), m_buffer.get() + BUFFER_SIZE);
+
+  for (int i = 100; i < 200; ++i) {
+    m_buffer[i] = Test_item(i);
+    ASSERT_TRUE(second.push_back(m_buffer[i]));
+  }
+
+  /* More lookups than slots, over both lists, keys from 200 up are in neither */
+  constexpr size_t LOOKUPS = 50;
+  Test_item* out[LOOKUPS]{};
+
+  auto found = ut::find_interleaved<4>(LOOKUPS, [&](size_t i) {
+    const auto key = static_cast<int>(i) * 6;
+    return (key < 100 ? *m_list : second).async_find([key](const Test_item* item) { return item->m_value == key; });
+  }, out);
+
+  size_t expected{};
+
+  for (size_t i = 0; i < LOOKUPS; ++i) {
+    const auto key = i * 6;
+
+    EXPECT_EQ(out[i], key < 200 ? &m_buffer[key] : nullptr);
+    expected += key < 200;
+  }
+  EXPECT_EQ(found, expected);
+}
+
+/* Orders Test_items by value, keys are plain ints */
+struct Value_order {
+  bool operator()(const Test_item& lhs, const Test_item& rhs) const noexcept { return lhs.m_value < rhs.m_value; }
+  bool operator()(const Test_item& lhs, int rhs) const noexcept { return lhs.m_value < rhs; }
+  bool operator()(int lhs, const Test_item& rhs) const noexcept { return lhs < rhs.m_value; }
+};
+
+TEST(Sorted_list_test, insert_lower_bound_erase) {
+  constexpr size_t NUM_ITEMS = 200;
+  auto buffer = std::make_unique<Test_item[]>(NUM_ITEMS);
+  ut::Sorted_list<Test_item, &Test_item::node, Value_order> list(buffer.get(), buffer.get() + NUM_ITEMS);
+
+  EXPECT_EQ(list.lower_bound(0), nullptr);
+  EXPECT_EQ(list.erase_key(0), nullptr);
+
+  /* Even values 0..198 in a scrambled order */
+  for (size_t i = 0; i < NUM_ITEMS; ++i) {
+    buffer[i] = Test_item(static_cast<int>((i * 37) % NUM_ITEMS) & ~1);
+  }
+  for (size_t i = 0; i < NUM_ITEMS; ++i) {
+    ASSERT_TRUE(list.insert_sorted(buffer[i]));
+  }
+  EXPECT_EQ(list.size(), NUM_ITEMS);
+
+  std::vector<Test_item*> order;
+  for (auto& item : list.list()) {
+    order.push_back(&item);
+  }
+  ASSERT_EQ(order.size(), NUM_ITEMS);
+  EXPECT_TRUE(std::is_sorted(order.begin(), order.end(), [](auto lhs, auto rhs) { return lhs->m_value < rhs->m_value; }));
+
+  /* Equal values keep their insertion order */
+  for (size_t i = 1; i < order.size(); ++i) {
+    if (order[i - 1]->m_value == order[i]->m_value) {
+      EXPECT_LT(order[i - 1], order[i]);
+    }
+  }
+
+  EXPECT_EQ(list.lower_bound(-1)->m_value, 0);
+  EXPECT_EQ(list.lower_bound(51)->m_value, 52);
+  EXPECT_EQ(list.lower_bound(52)->m_value, 52);
+  EXPECT_EQ(list.lower_bound(199), nullptr);
+
+  /* Each even value was inserted twice */
+  auto first = list.lower_bound(52);
+  EXPECT_EQ(list.erase_key(52), first);
+  EXPECT_NE(list.erase_key(52), nullptr);
+  EXPECT_EQ(list.erase_key(52), nullptr);
+  EXPECT_EQ(list.erase_key(53), nullptr);
+  EXPECT_EQ(list.lower_bound(51)->m_value, 54);
+  EXPECT_EQ(list.size(), NUM_ITEMS - 2);
+
+  /* A smaller value goes to the front */
+  ASSERT_NE(list.erase_key(0), nullptr);
+  buffer[0] = Test_item(-5);
+  ASSERT_TRUE(list.insert_sorted(buffer[0]));
+  EXPECT_EQ(list.list().begin()->m_value, -5);
+}
+
+TEST(Sorted_list_test, stats_and_reclaim_policies) {
+  using Pool = ut::Fixed_pool<Test_item, &Test_item::node>;
+  using Domain = ut::Epoch_domain<Pool>;
+  using Reclaim = ut::Epoch_reclaim<Domain>;
+  using Sorted = ut::Sorted_list<Test_item, &Test_item::node, Value_order, ut::No_backoff<>, ut::No_index,
+                                 ut::Sharded_stats<>, Reclaim>;
+
+  Pool pool(3);
+  Domain domain(pool);
+  Sorted list(pool.base(), pool.end(), Value_order{}, Reclaim(domain));
+  Domain::Participant participant(domain);
+
+  for (int value : {2, 0, 1}) {
+    auto item = participant.allocate();
+    ASSERT_NE(item, nullptr);
+    *item = Test_item(value);
+    ASSERT_TRUE(list.insert_sorted(*item));
+  }
+  EXPECT_GT(list.list().stats()[ut::List_stat::ATTEMPTS], 0);
+
+  auto removed = list.erase_key(1);
+  ASSERT_NE(removed, nullptr);
+  EXPECT_EQ(list.lower_bound(1)->m_value, 2);
+
+  /* Retired through the domain, reused once no walk can hold it */
+  list.list().retire(removed);
+  EXPECT_EQ(participant.pending(), 1);
+  participant.collect();
+  participant.collect();
+  EXPECT_EQ(participant.pending(), 0);
+  EXPECT_EQ(participant.allocate(), removed);
+}
+
+/** No_index that counts what it is told */
+struct Counting_index : ut::No_index {
+  explicit Counting_index(size_t capacity) noexcept : ut::No_index(capacity) {
+    s_links = s_unlinks = 0;
+  }
+
+  template <typename Sorted>
+  void link(Sorted&, typename Sorted::node_pointer) noexcept {
+    ++s_links;
+  }
+
+  template <typename Sorted>
+  void unlink(Sorted&, typename Sorted::node_pointer) noexcept {
+    ++s_unlinks;
+  }
+
+  static inline size_t s_links{};
+  static inline size_t s_unlinks{};
+};
+
+TEST(Sorted_list_test, removals_unlink_from_the_index) {
+  constexpr size_t NUM_ITEMS = 8;
+  auto buffer = std::make_unique<Test_item[]>(NUM_ITEMS);
+  ut::Sorted_list<Test_item, &Test_item::node, Value_order, ut::No_backoff<>, Counting_index> list(
+    buffer.get(), buffer.get() + NUM_ITEMS);
+
+  for (size_t i = 0; i < NUM_ITEMS; ++i) {
+    buffer[i] = Test_item(static_cast<int>(i));
+    ASSERT_TRUE(list.insert_sorted(buffer[i]));
+  }
+  EXPECT_EQ(Counting_index::s_links, NUM_ITEMS);
+
+  EXPECT_EQ(list.pop_front(), &buffer[0]);
+  EXPECT_EQ(list.pop_back(), &buffer[7]);
+  EXPECT_EQ(list.remove(buffer[4]), &buffer[4]);
+  EXPECT_EQ(list.erase_key(5), &buffer[5]);
+  EXPECT_EQ(Counting_index::s_unlinks, 4);
+
+  Test_item* out[4]{};
+
+  ASSERT_EQ(list.pop_front_n(out, 4), 4);
+  EXPECT_EQ(out[0], &buffer[1]);
+  EXPECT_EQ(out[3], &buffer[6]);
+  EXPECT_EQ(Counting_index::s_unlinks, NUM_ITEMS);
+
+  /* Nothing removed, nothing to tell */
+  EXPECT_EQ(list.remove(buffer[4]), nullptr);
+  EXPECT_EQ(list.pop_front(), nullptr);
+  EXPECT_EQ(list.pop_back(), nullptr);
+  EXPECT_EQ(Counting_index::s_unlinks, NUM_ITEMS);
+}
+
+TEST(Sorted_list_test, skip_index) {
+  constexpr int NUM_ITEMS = 5000;
+  auto buffer = std::make_unique<Test_item[]>(NUM_ITEMS);
+  ut::Sorted_list<Test_item, &Test_item::node, Value_order, ut::No_backoff<>, ut::Skip_index<>> list(
+    buffer.get(), buffer.get() + NUM_ITEMS);
+
+  /* Multiples of 3 in a scrambled order */
+  for (int i = 0; i < NUM_ITEMS; ++i) {
+    buffer[i] = Test_item(((i * 7919) % NUM_ITEMS) * 3);
+    ASSERT_TRUE(list.insert_sorted(buffer[i]));
+  }
+
+  int last{-1};
+  for (const auto& item : list.list()) {
+    ASSERT_GT(item.m_value, last);
+    last = item.m_value;
+  }
+
+  for (int key = -1; key < NUM_ITEMS * 3; key += 7) {
+    auto item = list.lower_bound(key);
+    ASSERT_NE(item, nullptr);
+    EXPECT_EQ(item->m_value, key < 0 ? 0 : (key + 2) / 3 * 3);
+    EXPECT_EQ(list.find_key(key) != nullptr, key % 3 == 0);
+  }
+  EXPECT_EQ(list.lower_bound(NUM_ITEMS * 3), nullptr);
+
+  /* Erase every other element, through erase_key() and behind the index's back */
+  for (int i = 0; i < NUM_ITEMS; i += 2) {
+    if (i % 4 == 0) {
+      ASSERT_NE(list.erase_key(i * 3), nullptr);
+    } else {
+      ASSERT_NE(list.list().remove(*list.find_key(i * 3)), nullptr);
+    }
+  }
+  EXPECT_EQ(list.size(), NUM_ITEMS / 2);
+
+  for (int i = 0; i < NUM_ITEMS; ++i) {
+    auto item = list.find_key(i * 3);
+    EXPECT_EQ(item != nullptr, i % 2 == 1);
+    if (item != nullptr) {
+      EXPECT_EQ(item->m_value, i * 3);
+    }
+  }
+}
+
+TEST(Sorted_list_test, skip_index_keeps_pinned_nodes) {
+  using Layout = ut::Node::layout_type;
+  using Sorted = ut::Sorted_list<Test_item, &Test_item::node, Value_order>;
+
+  constexpr int NUM_ITEMS = 256;
+  auto buffer = std::make_unique<Test_item[]>(NUM_ITEMS);
+  Sorted list(buffer.get(), buffer.get() + NUM_ITEMS);
+  ut::Skip_index<4> index(NUM_ITEMS);
+
+  for (int i = 0; i < NUM_ITEMS; ++i) {
+    buffer[i] = Test_item(i);
+    ASSERT_TRUE(list.insert_sorted(buffer[i]));
+    index.link(list, &buffer[i].node());
+  }
+
+  const auto hint = [&](int value) {
+    return index.seek_hint(list, [value](const Test_item& item) { return item.m_value <= value; });
+  };
+
+  /* An element the lanes lead to */
+  int value = NUM_ITEMS - 1;
+  while (value > 0 && hint(value) != &buffer[value].node()) {
+    --value;
+  }
+  ASSERT_GT(value, 0);
+
+  auto& links = buffer[value].node().m_links;
+  const auto linked = links.load();
+  const auto link_data = ut::unpack_links<Layout>(linked);
+
+  /* An insert anchor or a node being moved is pinned, it's still there */
+  links.store(ut::pack_links<Layout>(link_data.next, ut::Node::DELETING_MARK, 0, 0));
+  EXPECT_EQ(hint(value), &buffer[value].node());
+
+  links.store(linked);
+  EXPECT_EQ(hint(value), &buffer[value].node());
+
+  /* A removal claim drops it from the lanes it's found in */
+  links.store(ut::pack_links<Layout>(ut::Node::DELETING_MARK, link_data.prev, 0, 0));
+  EXPECT_NE(hint(value), &buffer[value].node());
+  links.store(linked);
+}
+
+TEST_F(List_test, move_to_front_and_back) {
+  for (int i = 0; i < 5; ++i) {
+    m_buffer[i] = Test_item(i);
+    ASSERT_TRUE(m_list->push_back(m_buffer[i]));
+  }
+
+  const auto values = [this]() {
+    std::vector<int> values;
+    for (const auto& item : *m_list) {
+      values.push_back(item.m_value);
+    }
+    return values;
+  };
+
+  EXPECT_EQ(m_list->move_to_front(m_buffer[2]), ut::Move_result::MOVED);
+  EXPECT_EQ(values(), (std::vector<int>{2, 0, 1, 3, 4}));
+  EXPECT_EQ(m_list->move_to_front(m_buffer[4]), ut::Move_result::MOVED);
+  EXPECT_EQ(values(), (std::vector<int>{4, 2, 0, 1, 3}));
+  EXPECT_EQ(m_list->move_to_front(m_buffer[4]), ut::Move_result::MOVED);
+  EXPECT_EQ(values(), (std::vector<int>{4, 2, 0, 1, 3}));
+
+  EXPECT_EQ(m_list->move_to_back(m_buffer[4]), ut::Move_result::MOVED);
+  EXPECT_EQ(values(), (std::vector<int>{2, 0, 1, 3, 4}));
+  EXPECT_EQ(m_list->move_to_back(m_buffer[0]), ut::Move_result::MOVED);
+  EXPECT_EQ(values(), (std::vector<int>{2, 1, 3, 4, 0}));
+  EXPECT_EQ(m_list->size(), 5);
+
+  /* The reverse links follow */
+  std::vector<int> reversed;
+  for (auto it = m_list->rbegin(); it != m_list->rend(); ++it) {
+    reversed.push_back(it->m_value);
+  }
+  EXPECT_EQ(reversed, (std::vector<int>{0, 4, 3, 1, 2}));
+
+  ASSERT_NE(m_list->remove(m_buffer[3]), nullptr);
+  EXPECT_EQ(m_list->move_to_front(m_buffer[3]), ut::Move_result::UNCHANGED);
+  EXPECT_EQ(m_list->move_to_back(m_buffer[3]), ut::Move_result::UNCHANGED);
+  EXPECT_EQ(m_list->size(), 4);
+}
+
+struct Value_key {
+  int operator()(const Test_item& item) const noexcept { return item.m_value; }
+};
+
+TEST(Indexed_list_test, lru_operations) {
+  constexpr int NUM_ITEMS = 100;
+  auto buffer = std::make_unique<Test_item[]>(NUM_ITEMS + 1);
+  ut::Indexed_list<Test_item, &Test_item::node, Value_key> lru(buffer.get(), buffer.get() + NUM_ITEMS + 1);
+
+  EXPECT_EQ(lru.find(0), nullptr);
+  EXPECT_EQ(lru.pop_back(), nullptr);
+
+  for (int i = 0; i < NUM_ITEMS; ++i) {
+    buffer[i] = Test_item(i);
+    ASSERT_TRUE(lru.push_front(buffer[i]));
+  }
+  EXPECT_EQ(lru.size(), NUM_ITEMS);
+
+  for (int i = 0; i < NUM_ITEMS; ++i) {
+    EXPECT_EQ(lru.find(i), &buffer[i]);
+  }
+  EXPECT_EQ(lru.find(NUM_ITEMS), nullptr);
+
+  /* Keys are unique */
+  buffer[NUM_ITEMS] = Test_item(7);
+  EXPECT_FALSE(lru.push_back(buffer[NUM_ITEMS]));
+  EXPECT_EQ(lru.find(7), &buffer[7]);
+
+  /* A hit moves to the front, the victim is the least recently used */
+  EXPECT_EQ(lru.touch(0), &buffer[0]);
+  EXPECT_EQ(lru.list().begin()->m_value, 0);
+  EXPECT_EQ(lru.pop_back(), &buffer[1]);
+  EXPECT_EQ(lru.find(1), nullptr);
+  EXPECT_EQ(lru.touch(1), nullptr);
+
+  EXPECT_EQ(lru.erase(50), &buffer[50]);
+  EXPECT_EQ(lru.erase(50), nullptr);
+  EXPECT_EQ(lru.size(), NUM_ITEMS - 2);
+
+  /* Removed keys can come back, into reused entries */
+  ASSERT_TRUE(lru.insert_after(buffer[10], buffer[50]));
+  EXPECT_EQ(lru.find(50), &buffer[50]);
+  ASSERT_NE(lru.remove(buffer[50]), nullptr);
+  buffer[NUM_ITEMS] = Test_item(50);
+  ASSERT_TRUE(lru.insert_before(buffer[10], buffer[NUM_ITEMS]));
+  EXPECT_EQ(lru.find(50), &buffer[NUM_ITEMS]);
+
+  size_t count{};
+  for (const auto& item : lru.list()) {
+    EXPECT_EQ(lru.find(item.m_value), &item);
+    ++count;
+  }
+  EXPECT_EQ(count, lru.size());
+}
+
+TEST(Indexed_list_test, touch_that_becomes_a_removal) {
+  using Layout = ut::Node::layout_type;
+
+  constexpr int NUM_ITEMS = 5;
+  auto buffer = std::make_unique<Test_item[]>(NUM_ITEMS);
+  ut::Indexed_list<Test_item, &Test_item::node, Value_key, std::hash<int>, ut::No_backoff<2>> lru(buffer.get(),
+                                                                                                 buffer.get() + NUM_ITEMS);
+
+  for (int i = 0; i < NUM_ITEMS; ++i) {
+    buffer[i] = Test_item(i);
+    ASSERT_TRUE(lru.push_front(buffer[i]));
+  }
+
+  /* The head looks claimed by a remover that never finishes, publishing
+   * at the front runs out of retries */
+  auto& head = buffer[NUM_ITEMS - 1].node().m_links;
+  const auto head_links = head.load();
+  head.store(ut::pack_links<Layout>(ut::Node::DELETING_MARK, ut::Node::NULL_PTR, 0, 0));
+
+  EXPECT_EQ(lru.touch(1), nullptr);
+  EXPECT_TRUE(buffer[1].node().is_null());
+  EXPECT_EQ(lru.find(1), nullptr);
+  EXPECT_EQ(lru.size(), NUM_ITEMS - 1);
+
+  head.store(head_links);
+
+  /* The entry was cleared once, the key can come back */
+  ASSERT_TRUE(lru.push_back(buffer[1]));
+  EXPECT_EQ(lru.touch(1), &buffer[1]);
+  EXPECT_EQ(lru.list().begin()->m_value, 1);
+  EXPECT_EQ(lru.size(), NUM_ITEMS);
+}
+
+TEST(Indexed_list_test, compact_index) {
+  /* All keys share one probe sequence */
+  struct Same_hash {
+    size_t operator()(int) const noexcept { return 0; }
+  };
+
+  constexpr int NUM_ITEMS = 32;
+  auto buffer = std::make_unique<Test_item[]>(NUM_ITEMS);
+  ut::Indexed_list<Test_item, &Test_item::node, Value_key, Same_hash> lru(buffer.get(), buffer.get() + NUM_ITEMS);
+
+  for (int i = 0; i < NUM_ITEMS; ++i) {
+    buffer[i] = Test_item(i);
+    ASSERT_TRUE(lru.push_back(buffer[i]));
+  }
+
+  /* Tombstones in front of the live entries and between them */
+  for (int i = 0; i < NUM_ITEMS; ++i) {
+    if (i < NUM_ITEMS / 2 || i % 4 == 0) {
+      ASSERT_EQ(lru.erase(i), &buffer[i]);
+    }
+  }
+
+  EXPECT_EQ(lru.compact_index(), NUM_ITEMS / 2 + NUM_ITEMS / 8);
+  EXPECT_EQ(lru.compact_index(), 0);
+
+  for (int i = 0; i < NUM_ITEMS; ++i) {
+    const bool present = i >= NUM_ITEMS / 2 && i % 4 != 0;
+
+    EXPECT_EQ(lru.find(i), present ? &buffer[i] : nullptr) << "Key " << i;
+  }
+
+  /* Keys are still unique and erased keys can come back */
+  buffer[0] = Test_item(17);
+  EXPECT_FALSE(lru.push_front(buffer[0]));
+  buffer[0] = Test_item(0);
+  ASSERT_TRUE(lru.push_front(buffer[0]));
+  EXPECT_EQ(lru.find(0), &buffer[0]);
+  EXPECT_EQ(lru.find(17), &buffer[17]);
+}
+
+TEST(Indexed_list_test, stats_and_reclaim_policies) {
+  using Pool = ut::Fixed_pool<Test_item, &Test_item::node>;
+  using Domain = ut::Epoch_domain<Pool>;
+  using Reclaim = ut::Epoch_reclaim<Domain>;
+  using Lru = ut::Indexed_list<Test_item, &Test_item::node, Value_key, std::hash<int>, ut::No_backoff<>,
+                               ut::Sharded_stats<>, Reclaim>;
+
+  Pool pool(2);
+  Domain domain(pool);
+  Lru lru(pool.base(), pool.end(), Value_key{}, std::hash<int>{}, Reclaim(domain));
+  Domain::Participant participant(domain);
+
+  for (int key : {1, 2}) {
+    auto item = participant.allocate();
+    ASSERT_NE(item, nullptr);
+    *item = Test_item(key);
+    ASSERT_TRUE(lru.push_front(*item));
+  }
+  EXPECT_GT(lru.list().stats()[ut::List_stat::ATTEMPTS], 0);
+
+  auto victim = lru.pop_back();
+  ASSERT_NE(victim, nullptr);
+  EXPECT_EQ(victim->m_value, 1);
+  EXPECT_EQ(lru.find(1), nullptr);
+
+  lru.list().retire(victim);
+  EXPECT_EQ(participant.pending(), 1);
+  participant.collect();
+  participant.collect();
+  EXPECT_EQ(participant.allocate(), victim);
+}
+
+TEST(Indexed_list_test, churn_with_distinct_keys) {
+  /* Inserts reuse tombstones first, churn leaves no empty entry. A table
+   * of 8 entries is shorter than MAX_PROBES, 128 entries is not. */
+  for (const size_t capacity : {size_t{4}, size_t{64}}) {
+    constexpr int ROUNDS = 2000;
+    auto buffer = std::make_unique<Test_item[]>(capacity);
+    ut::Indexed_list<Test_item, &Test_item::node, Value_key> lru(buffer.get(), buffer.get() + capacity);
+    int key{};
+
+    for (size_t i = 0; i < capacity / 2; ++i) {
+      buffer[i] = Test_item(key++);
+      ASSERT_TRUE(lru.push_back(buffer[i]));
+    }
+
+    for (int round = 0; round < ROUNDS; ++round) {
+      auto item = lru.pop_front();
+
+      ASSERT_NE(item, nullptr);
+      *item = Test_item(key++);
+      ASSERT_TRUE(lru.push_back(*item)) << "Capacity " << capacity << " round " << round;
+    }
+
+    EXPECT_GT(lru.compact_index(), 0);
+    EXPECT_EQ(lru.compact_index(), 0);
+
+    for (int k = key - static_cast<int>(capacity / 2); k < key; ++k) {
+      ASSERT_NE(lru.find(k), nullptr) << "Key " << k;
+    }
+    EXPECT_EQ(lru.find(0), nullptr);
+
+    /* The compacted table takes new keys */
+    for (size_t i = capacity / 2; i < capacity; ++i) {
+      buffer[i] = Test_item(key++);
+      ASSERT_TRUE(lru.push_back(buffer[i]));
+    }
+    EXPECT_EQ(lru.size(), capacity);
+  }
+}
+
+TEST(Sharded_list_test, local_and_stolen) {
+  constexpr size_t NUM_ITEMS = 10;
+  auto buffer = std::make_unique<Test_item[]>(NUM_ITEMS);
+  ut::Sharded_list<Test_item, &Test_item::node, 4> sharded(buffer.get(), buffer.get() + NUM_ITEMS);
+  const auto local = sharded.local_shard();
+  auto& other = sharded.shard((local + 1) % 4);
+
+  EXPECT_EQ(sharded.pop(), nullptr);
+
+  for (size_t i = 0; i < NUM_ITEMS; ++i) {
+    buffer[i] = Test_item(static_cast<int>(i));
+  }
+
+  /* The local shard is LIFO */
+  ASSERT_TRUE(sharded.push(buffer[0]));
+  ASSERT_TRUE(sharded.push(buffer[1]));
+  EXPECT_EQ(sharded.shard(local).size(), 2);
+  EXPECT_EQ(sharded.pop(), &buffer[1]);
+
+  /* Steals take the oldest element of another shard */
+  for (size_t i = 2; i < 5; ++i) {
+    ASSERT_TRUE(other.push_front(buffer[i]));
+  }
+  EXPECT_EQ(sharded.size(), 4);
+  EXPECT_EQ(sharded.steal(), &buffer[2]);
+  EXPECT_EQ(sharded.pop(), &buffer[0]);
+  EXPECT_EQ(sharded.pop(), &buffer[3]);
+  EXPECT_EQ(sharded.pop(), &buffer[4]);
+  EXPECT_EQ(sharded.pop(), nullptr);
+  EXPECT_EQ(sharded.size(), 0);
+}
+
+TEST(Sharded_list_test, stats_and_reclaim_policies) {
+  using Pool = ut::Fixed_pool<Test_item, &Test_item::node>;
+  using Domain = ut::Epoch_domain<Pool>;
+  using Reclaim = ut::Epoch_reclaim<Domain>;
+  using Sharded = ut::Sharded_list<Test_item, &Test_item::node, 4, ut::No_backoff<>, ut::Sharded_stats<>, Reclaim>;
+
+  Pool pool(1);
+  Domain domain(pool);
+  Sharded sharded(pool.base(), pool.end(), Reclaim(domain));
+  Domain::Participant participant(domain);
+
+  auto item = participant.allocate();
+  ASSERT_NE(item, nullptr);
+  ASSERT_TRUE(sharded.push(*item));
+  EXPECT_GT(sharded.shard(sharded.local_shard()).stats()[ut::List_stat::ATTEMPTS], 0);
+
+  ASSERT_EQ(sharded.pop(), item);
+  sharded.retire(item);
+  EXPECT_EQ(participant.pending(), 1);
+  participant.collect();
+  participant.collect();
+  EXPECT_EQ(participant.allocate(), item);
+}
+
+TEST(Numa_test, storage_and_pool) {
+  constexpr size_t NUM_ITEMS = 1000;
+
+  ut::Numa_storage<Test_item> interleaved(NUM_ITEMS, ut::Numa_placement::INTERLEAVE);
+  EXPECT_EQ(interleaved.parts(), 1);
+  EXPECT_EQ(interleaved.end() - interleaved.base(), NUM_ITEMS);
+
+  ut::Numa_storage<Test_item> partitioned(NUM_ITEMS, ut::Numa_placement::PARTITION);
+  EXPECT_EQ(partitioned.parts(), ut::numa_nodes());
+  EXPECT_EQ(partitioned.part_begin(0), partitioned.base());
+  EXPECT_EQ(partitioned.part_end(partitioned.parts() - 1), partitioned.end());
+
+  /* A borrowed range pool over part of a list's array */
+  ut::Fixed_pool<Test_item, &Test_item::node> borrowed(interleaved.base() + 10, interleaved.base() + 20);
+  ut::List<Test_item, &Test_item::node> list(interleaved.base(), interleaved.end());
+
+  EXPECT_EQ(borrowed.capacity(), 10);
+  for (size_t i = 0; i < 10; ++i) {
+    auto item = borrowed.allocate();
+    ASSERT_NE(item, nullptr);
+    ASSERT_TRUE(list.push_back(*item));
+  }
+  EXPECT_EQ(borrowed.allocate(), nullptr);
+  EXPECT_EQ(list.size(), 10);
+  while (auto item = list.pop_front()) {
+    borrowed.release(item);
+  }
+
+  ut::Numa_pool<Test_item, &Test_item::node> pool(NUM_ITEMS);
+  ut::List<Test_item, &Test_item::node> pool_list(pool.base(), pool.end());
+  std::vector<Test_item*> items;
+
+  {
+    decltype(pool)::Cache cache(pool);
+
+    while (auto item = cache.allocate()) {
+      ASSERT_TRUE(item >= pool.base() && item < pool.end());
+      ASSERT_TRUE(pool_list.push_back(*item));
+      items.push_back(item);
+    }
+    EXPECT_EQ(items.size(), NUM_ITEMS);
+
+    while (auto item = pool_list.pop_front()) {
+      cache.release(item);
+    }
+  }
+
+  EXPECT_NE(pool.allocate(), nullptr);
+  pool.release(nullptr);
+}
+
+TEST(Mapped_list_test, create_mapped) {
+  constexpr size_t NUM_ITEMS = 10000;
+
+  for (auto flags : {ut::Map_flags::NONE, ut::Map_flags::TRANSPARENT_HUGE_PAGES | ut::Map_flags::POPULATE,
+                     ut::Map_flags::HUGE_PAGES | ut::Map_flags::POPULATE}) {
+    auto list = ut::List<Test_item, &Test_item::node>::create_mapped(NUM_ITEMS, flags);
+    auto& items = list->items();
+
+    ASSERT_EQ(items.capacity(), NUM_ITEMS);
+    for (size_t i = 0; i < NUM_ITEMS; ++i) {
+      items.base()[i] = Test_item(static_cast<int>(i));
+      ASSERT_TRUE(list->push_back(items.base()[i]));
+    }
+    EXPECT_EQ(list->size(), NUM_ITEMS);
+
+    int expected{};
+    for (const auto& item : *list) {
+      EXPECT_EQ(item.m_value, expected++);
+    }
+    EXPECT_EQ(list->pop_front(), items.base());
+  }
+
+  /* The node array of a side links list is mapped too */
+  auto side = ut::List<Payload, ut::SIDE_LINKS<>>::create_mapped(NUM_ITEMS, ut::Map_flags::TRANSPARENT_HUGE_PAGES);
+
+  ASSERT_TRUE(side->push_back(side->items().base()[1]));
+  ASSERT_TRUE(side->push_front(side->items().base()[0]));
+  EXPECT_EQ(side->pop_back(), &side->items().base()[1]);
+  EXPECT_EQ(side->size(), 1);
+}
+
+TEST(Persistent_list_test, reopen_and_recover) {
+  using Persistent = ut::Persistent_list<Test_item, &Test_item::node>;
+  using Layout = ut::Node::layout_type;
+  constexpr size_t NUM_ITEMS = 100;
+  const auto path = testing::TempDir() + "ut_persistent_list_test";
+
+  std::remove(path.c_str());
+
+  {
+    auto list = Persistent::open(path.c_str(), NUM_ITEMS);
+    ASSERT_NE(list, nullptr);
+    EXPECT_FALSE(list->recovered());
+
+    /* The file is locked while it's open */
+    EXPECT_EQ(Persistent::open(path.c_str(), NUM_ITEMS), nullptr);
+
+    for (size_t i = 0; i < 50; ++i) {
+      list->items()[i] = Test_item(static_cast<int>(i));
+      ASSERT_TRUE(list->list().push_back(list->items()[i]));
+    }
+  }
+
+  EXPECT_EQ(Persistent::open(path.c_str(), 2 * NUM_ITEMS), nullptr);
+
+  {
+    auto list = Persistent::open(path.c_str(), NUM_ITEMS);
+    ASSERT_NE(list, nullptr);
+    EXPECT_FALSE(list->recovered());
+    EXPECT_EQ(list->list().size(), 50);
+
+    int expected{};
+    for (const auto& item : list->list()) {
+      EXPECT_EQ(item.m_value, expected++);
+    }
+    EXPECT_EQ(expected, 50);
+  }
+
+  /* A process that dies in the middle of a remove and of a push_front */
+  const auto pid = fork();
+
+  if (pid == 0) {
+    auto list = Persistent::open(path.c_str(), NUM_ITEMS);
+    auto items = list->items();
+    const auto links = ut::unpack_links<Layout>(items[10].node().m_links.load());
+
+    items[10].node().m_links.store(ut::pack_links<Layout>(ut::Node::DELETING_MARK, links.prev, 0, 0));
+    items[60].node().m_links.store(ut::pack_links<Layout>(0, ut::Node::NULL_PTR, 0, 0));
+    _exit(0);
+  }
+
+  ASSERT_GT(pid, 0);
+  int status{};
+  ASSERT_EQ(waitpid(pid, &status, 0), pid);
+
+  {
+    auto list = Persistent::open(path.c_str(), NUM_ITEMS);
+    ASSERT_NE(list, nullptr);
+    EXPECT_TRUE(list->recovered());
+    EXPECT_EQ(list->list().size(), 49);
+    EXPECT_TRUE(list->items()[10].node().is_null());
+    EXPECT_TRUE(list->items()[60].node().is_null());
+
+    std::vector<int> values;
+    for (const auto& item : list->list()) {
+      values.push_back(item.m_value);
+    }
+    ASSERT_EQ(values.size(), 49);
+    EXPECT_EQ(values[9], 9);
+    EXPECT_EQ(values[10], 11);
+
+    std::vector<int> reversed;
+    for (auto it = list->list().rbegin(); it != list->list().rend(); ++it) {
+      reversed.push_back(it->m_value);
+    }
+    EXPECT_TRUE(std::equal(values.rbegin(), values.rend(), reversed.begin(), reversed.end()));
+
+    ASSERT_TRUE(list->list().push_front(list->items()[10]));
+    EXPECT_EQ(list->list().pop_front(), &list->items()[10]);
+    EXPECT_EQ(list->list().pop_back(), &list->items()[49]);
+  }
+
+  std::remove(path.c_str());
+}
+
+TEST_F(List_test, recover_pinned_nodes) {
+  using Layout = ut::Node::layout_type;
+  constexpr int NUM_ITEMS = 10;
+
+  for (int i = 0; i < NUM_ITEMS; ++i) {
+    m_buffer[i] = Test_item(i);
+    ASSERT_TRUE(m_list->push_back(m_buffer[i]));
+  }
+
+  for (int i = 20; i < 23; ++i) {
+    m_buffer[i] = Test_item(i);
+  }
+
+  const auto links = [&](int i) { return ut::unpack_links<Layout>(m_buffer[i].node().m_links.load()); };
+  const auto store = [&](int i, uint32_t next, uint32_t prev, uint8_t prev_version = 0) {
+    m_buffer[i].node().m_links.store(ut::pack_links<Layout>(next, prev, 0, prev_version));
+  };
+  constexpr auto PINNED = ut::Node::DELETING_MARK;
+
+  /* Threads that died in the middle of:
+   *  - insert_before(3, 20), 2 links to 20, which is still pinned
+   *  - insert_after(6, 21), 7 doesn't link back to 21 yet
+   *  - insert_after(8, 22), 9 links back to 22, 8 is still pinned
+   *  - move_to_back(5), unlinked and not published yet */
+  store(3, 4, PINNED);
+  store(20, 3, PINNED, 1);
+  store(2, 20, links(2).prev);
+
+  store(6, 7, PINNED);
+  store(21, 7, 6);
+
+  store(8, 9, PINNED);
+  store(22, 9, 8);
+  store(9, ut::Node::NULL_PTR, 22);
+
+  store(5, 6, PINNED);
+  store(4, 6, links(4).prev);
+
+  /* The anchors and the moved node survive, the inserts that weren't
+   * done are rolled back */
+  EXPECT_EQ(m_list->recover(BUFFER_SIZE), NUM_ITEMS + 1);
+  EXPECT_TRUE(m_buffer[20].node().is_null());
+  EXPECT_TRUE(m_buffer[21].node().is_null());
+
+  std::vector<int> values;
+  for (const auto& item : *m_list) {
+    values.push_back(item.m_value);
+  }
+  EXPECT_EQ(values, (std::vector<int>{0, 1, 2, 3, 4, 5, 6, 7, 8, 22, 9}));
+
+  std::vector<int> reversed;
+  for (auto it = m_list->rbegin(); it != m_list->rend(); ++it) {
+    reversed.push_back(it->m_value);
+  }
+  EXPECT_TRUE(std::equal(values.rbegin(), values.rend(), reversed.begin(), reversed.end()));
+
+  EXPECT_EQ(m_list->remove(m_buffer[5]), &m_buffer[5]);
+  EXPECT_TRUE(m_list->insert_before(m_buffer[3], m_buffer[20]));
+  EXPECT_EQ(m_list->size(), NUM_ITEMS + 1);
+}
+
+TEST(Shared_list_test, views_and_recovery) {
+  using Shared = ut::Shared_list<Test_item, &Test_item::node>;
+  using Layout = ut::Node::layout_type;
+  constexpr size_t NUM_ITEMS = 100;
+  const auto name = "/ut_shared_list_test_" + std::to_string(getpid());
+
+  (void) Shared::unlink(name.c_str());
+
+  auto producer = Shared::create(name.c_str(), NUM_ITEMS);
+  ASSERT_NE(producer, nullptr);
+  EXPECT_EQ(Shared::create(name.c_str(), NUM_ITEMS), nullptr);
+
+  /* A second mapping in the same process is at another address */
+  auto consumer = Shared::attach(name.c_str());
+  ASSERT_NE(consumer, nullptr);
+  EXPECT_EQ(consumer->capacity(), NUM_ITEMS);
+  EXPECT_NE(consumer->items(), producer->items());
+
+  for (size_t i = 0; i < 10; ++i) {
+    producer->items()[i] = Test_item(static_cast<int>(i));
+    ASSERT_TRUE(producer->list().push_back(producer->items()[i]));
+  }
+  EXPECT_EQ(consumer->list().size(), 10);
+  EXPECT_EQ(consumer->list().pop_front(), &consumer->items()[0]);
+
+  /* Another process appends */
+  if (const auto pid = fork(); pid == 0) {
+    auto child = Shared::attach(name.c_str());
+
+    for (size_t i = 10; child != nullptr && i < 20; ++i) {
+      child->items()[i] = Test_item(static_cast<int>(i));
+      (void) child->list().push_back(child->items()[i]);
+    }
+    _exit(child == nullptr ? 1 : 0);
+  } else {
+    int status{};
+    ASSERT_EQ(waitpid(pid, &status, 0), pid);
+    ASSERT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+  }
+
+  EXPECT_EQ(producer->list().size(), 19);
+
+  int expected{1};
+  for (const auto& item : consumer->list()) {
+    EXPECT_EQ(item.m_value, expected++);
+  }
+  EXPECT_EQ(expected, 20);
+
+  /* A process that dies in the middle of removing element 5 */
+  if (const auto pid = fork(); pid == 0) {
+    auto child = Shared::attach(name.c_str());
+    auto& node = child->items()[5].node();
+    const auto links = ut::unpack_links<Layout>(node.m_links.load());
+
+    node.m_links.store(ut::pack_links<Layout>(ut::Node::DELETING_MARK, links.prev, 0, 0));
+    _exit(0);
+  } else {
+    int status{};
+    ASSERT_EQ(waitpid(pid, &status, 0), pid);
+  }
+
+  EXPECT_EQ(consumer->recover(), 18);
+  EXPECT_TRUE(producer->items()[5].node().is_null());
+  EXPECT_EQ(producer->list().pop_front(), &producer->items()[1]);
+  EXPECT_EQ(consumer->list().size(), 17);
+
+  std::vector<int> values;
+  for (const auto& item : producer->list()) {
+    values.push_back(item.m_value);
+  }
+  EXPECT_EQ(values, (std::vector<int>{2, 3, 4, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19}));
+
+  EXPECT_TRUE(Shared::unlink(name.c_str()));
+  EXPECT_EQ(Shared::attach(name.c_str()), nullptr);
+}
+
+TEST(List_queue_test, bound_and_timed_wait) {
+  constexpr size_t NUM_ITEMS = 10;
+  std::vector<Test_item> items(NUM_ITEMS);
+  ut::List_queue<Test_item, &Test_item::node> queue(items.data(), items.data() + NUM_ITEMS, 4);
+
+  EXPECT_EQ(queue.bound(), 4);
+
+  for (size_t i = 0; i < 4; ++i) {
+    items[i] = Test_item(static_cast<int>(i));
+    EXPECT_TRUE(queue.try_push(items[i]));
+  }
+
+  /* Full, the item isn't touched */
+  EXPECT_FALSE(queue.try_push(items[4]));
+  EXPECT_TRUE(items[4].node().is_null());
+  EXPECT_EQ(queue.size(), 4);
+
+  EXPECT_EQ(queue.try_pop(), &items[0]);
+  EXPECT_TRUE(queue.try_push(items[4]));
+
+  for (size_t i = 1; i < 5; ++i) {
+    EXPECT_EQ(queue.pop_front_wait(), &items[i]);
+  }
+  EXPECT_EQ(queue.size(), 0);
+  EXPECT_EQ(queue.try_pop(), nullptr);
+
+  const auto start = std::chrono::steady_clock::now();
+  EXPECT_EQ(queue.pop_front_wait(std::chrono::milliseconds(20)), nullptr);
+  EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(20));
+
+  /* A producer wakes the waiter before the timeout */
+  std::thread producer([&]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    EXPECT_TRUE(queue.try_push(items[5]));
+  });
+
+  EXPECT_EQ(queue.pop_front_wait(std::chrono::seconds(10)), &items[5]);
+  producer.join();
+
+  /* Default bound is the capacity */
+  ut::List_queue<Test_item, &Test_item::node> unbounded(items.data(), items.data() + NUM_ITEMS);
+  EXPECT_EQ(unbounded.bound(), NUM_ITEMS);
+}
+
+TEST(List_queue_test, stats_and_reclaim_policies) {
+  using Pool = ut::Fixed_pool<Test_item, &Test_item::node>;
+  using Domain = ut::Epoch_domain<Pool>;
+  using Reclaim = ut::Epoch_reclaim<Domain>;
+  using Queue = ut::List_queue<Test_item, &Test_item::node, ut::No_backoff<>, ut::Sharded_stats<>, Reclaim>;
+
+  Pool pool(1);
+  Domain domain(pool);
+  Queue queue(pool.base(), pool.end(), 0, Reclaim(domain));
+  Domain::Participant participant(domain);
+
+  auto item = participant.allocate();
+  ASSERT_NE(item, nullptr);
+  ASSERT_TRUE(queue.try_push(*item));
+  EXPECT_GT(queue.list().stats()[ut::List_stat::ATTEMPTS], 0);
+
+  ASSERT_EQ(queue.try_pop(), item);
+  queue.list().retire(item);
+  EXPECT_EQ(participant.pending(), 1);
+  participant.collect();
+  participant.collect();
+  EXPECT_EQ(participant.allocate(), item);
+}
+
+TEST(List_queue_test, close_returns_parked_consumers) {
+  constexpr size_t NUM_ITEMS = 4;
+  std::vector<Test_item> items(NUM_ITEMS);
+  ut::List_queue<Test_item, &Test_item::node> queue(items.data(), items.data() + NUM_ITEMS);
+  std::atomic<size_t> returned{0};
+
+  EXPECT_FALSE(queue.closed());
+
+  /* notify_all() only wakes, the consumer parks again until its deadline */
+  std::thread woken([&]() {
+    EXPECT_EQ(queue.pop_front_wait(std::chrono::milliseconds(100)), nullptr);
+    returned.fetch_add(1);
+  });
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  const auto woken_at = std::chrono::steady_clock::now();
+
+  queue.notify_all();
+  woken.join();
+
+  EXPECT_FALSE(queue.closed());
+  EXPECT_GE(std::chrono::steady_clock::now() - woken_at, std::chrono::milliseconds(50));
+  returned.store(0);
+
+  /* Parked with and without a timeout, both return on shutdown */
+  std::thread untimed([&]() {
+    EXPECT_EQ(queue.pop_front_wait(), nullptr);
+    returned.fetch_add(1);
+  });
+
+  std::thread timed([&]() {
+    EXPECT_EQ(queue.pop_front_wait(std::chrono::seconds(60)), nullptr);
+    returned.fetch_add(1);
+  });
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  EXPECT_EQ(returned.load(), 0);
+
+  const auto start = std::chrono::steady_clock::now();
+
+  queue.close();
+  untimed.join();
+  timed.join();
+
+  EXPECT_TRUE(queue.closed());
+  EXPECT_EQ(returned.load(), 2);
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(30));
+
+  /* Elements pushed before or after are still popped, only an empty queue
+   * doesn't park any more */
+  items[0] = Test_item(0);
+  EXPECT_TRUE(queue.try_push(items[0]));
+  EXPECT_EQ(queue.pop_front_wait(), &items[0]);
+  EXPECT_EQ(queue.pop_front_wait(), nullptr);
+  EXPECT_EQ(queue.pop_front_wait(std::chrono::seconds(60)), nullptr);
+}
+
+TEST(List_stats_test, counters) {
+  using Stats_list = ut::List<Test_item, &Test_item::node, ut::No_backoff<>, ut::Sharded_stats<>>;
+  using Layout = ut::Node::layout_type;
+  constexpr size_t NUM_ITEMS = 10;
+  std::vector<Test_item> items(NUM_ITEMS);
+  Stats_list list(items.data(), items.data() + NUM_ITEMS);
+
+  /* Disabled stats take no space and read as zero */
+  using Plain_list = ut::List<Test_item, &Test_item::node>;
+  static_assert(sizeof(Plain_list::iterator) < sizeof(Stats_list::iterator));
+
+  Plain_list plain(items.data(), items.data() + NUM_ITEMS);
+  ASSERT_TRUE(plain.push_back(items[9]));
+  EXPECT_EQ(plain.stats()[ut::List_stat::ATTEMPTS], 0);
+  EXPECT_EQ(plain.pop_front(), &items[9]);
+
+  for (size_t i = 0; i < 3; ++i) {
+    ASSERT_TRUE(list.push_back(items[i]));
+  }
+  EXPECT_EQ(list.remove(items[1]), &items[1]);
+  EXPECT_EQ(list.pop_front(), &items[0]);
+
+  /* pop_front() counts itself and its remove() */
+  auto stats = list.stats();
+  EXPECT_EQ(stats[ut::List_stat::ATTEMPTS], 6);
+  EXPECT_EQ(stats[ut::List_stat::RETRIES], 0);
+  EXPECT_EQ(stats[ut::List_stat::RETRY_EXHAUSTED], 0);
+
+  /* A node left in DELETING_MARK state by a stalled remover, find() restarts
+   * on it until it runs out of budget */
+  auto& node = items[2].node();
+  const auto links = node.m_links.load();
+  node.m_links.store(ut::pack_links<Layout>(ut::Node::DELETING_MARK, ut::unpack_links<Layout>(links).prev, 0, 0));
+
+  EXPECT_EQ(list.find([](const Test_item*) { return false; }), nullptr);
+
+  stats = list.stats();
+  EXPECT_EQ(stats[ut::List_stat::FIND_RESTARTS], Stats_list::backoff_type::MAX_RETRIES);
+  EXPECT_EQ(stats[ut::List_stat::RETRY_EXHAUSTED], 1);
+
+  node.m_links.store(links);
+
+  size_t counters{};
+  stats.for_each([&](ut::List_stat stat, uint64_t) {
+    EXPECT_NE(std::string(ut::to_string(stat)), "");
+    ++counters;
+  });
+  EXPECT_EQ(counters, static_cast<size_t>(ut::List_stat::COUNT));
+  EXPECT_STREQ(ut::to_string(ut::List_stat::FIXUP_GIVE_UPS), "fixup_give_ups");
+
+  list.reset_stats();
+  EXPECT_EQ(list.stats()[ut::List_stat::FIND_RESTARTS], 0);
+}
+
+/* On a list of each group at once */
+struct Page {
+  ut::Node& state_node() noexcept { return m_state_node; }
+  ut::Node& lru_node() noexcept { return m_lru_node; }
+
+  int m_value{};
+  ut::Node m_state_node{};
+  ut::Node m_lru_node{};
+};
+
+TEST(List_group_test, transfer_and_membership) {
+  enum { CLEAN, DIRTY, PINNED };
+  enum { HOT, COLD };
+  constexpr size_t NUM_PAGES = 8;
+
+  auto pages = std::make_unique<Page[]>(NUM_PAGES);
+  ut::List_group<Page, &Page::state_node, 3> states(pages.get(), pages.get() + NUM_PAGES);
+  ut::List_group<Page, &Page::lru_node, 2> lru(pages.get(), pages.get() + NUM_PAGES, ut::Group_slots::SHARED);
+  using States = decltype(states);
+
+  EXPECT_EQ(lru.allocate(), nullptr);
+
+  std::vector<Page*> allocated;
+  while (auto page = states.allocate()) {
+    EXPECT_EQ(states.membership(*page), States::NO_LIST);
+    allocated.push_back(page);
+  }
+  ASSERT_EQ(allocated.size(), NUM_PAGES);
+
+  for (auto page : allocated) {
+    ASSERT_TRUE(states.push_back(CLEAN, *page));
+    ASSERT_TRUE(lru.push_front(HOT, *page));
+  }
+  EXPECT_EQ(states.list(CLEAN).size(), NUM_PAGES);
+
+  /* Only from the list the page is in */
+  auto& page = *allocated[3];
+
+  EXPECT_EQ(states.transfer(page, DIRTY, PINNED), ut::Move_result::UNCHANGED);
+  ASSERT_EQ(states.transfer(page, CLEAN, DIRTY), ut::Move_result::MOVED);
+  EXPECT_EQ(states.membership(page), DIRTY);
+  EXPECT_EQ(states.list(CLEAN).size(), NUM_PAGES - 1);
+  EXPECT_EQ(states.list(DIRTY).size(), 1);
+  EXPECT_EQ(&*states.list(DIRTY).begin(), &page);
+  EXPECT_FALSE(states.push_back(PINNED, page));
+
+  /* The other group's list is untouched */
+  ASSERT_EQ(lru.transfer(page, HOT, COLD), ut::Move_result::MOVED);
+  EXPECT_EQ(lru.membership(page), COLD);
+  EXPECT_EQ(states.membership(page), DIRTY);
+  EXPECT_EQ(lru.list(HOT).size(), NUM_PAGES - 1);
+
+  /* Front and back of the destination, and within a list */
+  ASSERT_EQ(states.transfer(*allocated[5], CLEAN, DIRTY, true), ut::Move_result::MOVED);
+  EXPECT_EQ(&*states.list(DIRTY).begin(), allocated[5]);
+  ASSERT_EQ(states.transfer(*allocated[5], DIRTY, DIRTY), ut::Move_result::MOVED);
+  EXPECT_EQ(&*states.list(DIRTY).begin(), &page);
+
+  auto popped = states.pop_front(DIRTY);
+  ASSERT_EQ(popped, &page);
+  EXPECT_EQ(states.membership(page), States::NO_LIST);
+  EXPECT_EQ(states.transfer(page, DIRTY, CLEAN), ut::Move_result::UNCHANGED);
+  EXPECT_FALSE(states.remove(page));
+
+  ASSERT_TRUE(states.remove(*allocated[0]));
+  EXPECT_EQ(states.membership(*allocated[0]), States::NO_LIST);
+
+  /* Freed slots can be allocated again once they're out of every list */
+  ASSERT_TRUE(lru.remove(page));
+  states.release(page);
+  EXPECT_EQ(states.allocate(), &page);
+  EXPECT_EQ(states.allocate(), nullptr);
+
+  size_t listed{};
+  for (size_t id = CLEAN; id <= PINNED; ++id) {
+    for (const auto& item : states.list(id)) {
+      EXPECT_EQ(states.membership(item), id);
+      ++listed;
+    }
+  }
+  EXPECT_EQ(listed, NUM_PAGES - 2);
+}
+
+TEST(List_group_test, stats_and_reclaim_policies) {
+  using Pool = ut::Fixed_pool<Page, &Page::state_node>;
+  using Domain = ut::Epoch_domain<Pool>;
+  using Reclaim = ut::Epoch_reclaim<Domain>;
+  using Group = ut::List_group<Page, &Page::state_node, 2, ut::No_backoff<>, ut::Sharded_stats<>, Reclaim>;
+
+  /* The domain's pool owns the slots */
+  Pool pool(1);
+  Domain domain(pool);
+  Group group(pool.base(), pool.end(), ut::Group_slots::SHARED, Reclaim(domain));
+  Domain::Participant participant(domain);
+
+  auto page = participant.allocate();
+  ASSERT_NE(page, nullptr);
+  ASSERT_TRUE(group.push_back(0, *page));
+  EXPECT_GT(group.list(0).stats()[ut::List_stat::ATTEMPTS], 0);
+  EXPECT_EQ(group.list(1).stats()[ut::List_stat::ATTEMPTS], 0);
+
+  ASSERT_EQ(group.pop_front(0), page);
+  group.retire(*page);
+  EXPECT_EQ(participant.pending(), 1);
+  participant.collect();
+  participant.collect();
+  EXPECT_EQ(participant.allocate(), page);
+}